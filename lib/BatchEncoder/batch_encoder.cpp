@@ -0,0 +1,137 @@
+#include "batch_encoder.h"
+#include <stdio.h>
+#include <string.h>
+#include "credentials.h"
+
+bool encoder_parse_key(const char *arg, EncoderKey &out)
+{
+    EncoderKey parsed;
+    parsed.id = ENVELOPE_NO_KEY_ID;
+    const char *hex = arg;
+    const char *colon = strchr(arg, ':');
+    if (colon)
+    {
+        unsigned id;
+        if (sscanf(arg, "%u:", &id) != 1 || id >= ENVELOPE_KEY_SLOTS)
+        {
+            return false;
+        }
+        parsed.id = (int)id;
+        hex = colon + 1;
+    }
+    if (strlen(hex) != 2 * ENVELOPE_KEY_SIZE)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ENVELOPE_KEY_SIZE; i++)
+    {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1)
+        {
+            return false;
+        }
+        parsed.key[i] = (uint8_t)v;
+    }
+    out = parsed;
+    return true;
+}
+
+bool encoder_split_row(const char *line, size_t line_no, DeviceRow &row)
+{
+    const char *first = strchr(line, ',');
+    const char *second = first ? strchr(first + 1, ',') : nullptr;
+    if (!second)
+    {
+        return false;
+    }
+    row.line = line_no;
+    row.device.assign(line, first);
+    row.ssid.assign(first + 1, second);
+    row.password.assign(second + 1);
+    row.plaintext = row.ssid + "|" + row.password;
+    return true;
+}
+
+const char *encoder_validate(const DeviceRow &row)
+{
+    if (row.device.empty())
+    {
+        return "empty device id";
+    }
+    if (row.ssid.empty() || row.password.empty())
+    {
+        return "empty ssid or password";
+    }
+    if (row.ssid.size() >= CREDENTIAL_FIELD_SIZE || row.password.size() >= CREDENTIAL_FIELD_SIZE)
+    {
+        return "field longer than 63 characters";
+    }
+    if (row.ssid.find('|') != std::string::npos)
+    {
+        return "ssid contains '|'";
+    }
+    for (char c : row.ssid + row.password)
+    {
+        if (c <= 0x1F || c >= 0x7F)
+        {
+            return "non-printable character";
+        }
+    }
+    for (char c : row.password)
+    {
+        if (c == ' ')
+        {
+            return "password contains a space";
+        }
+    }
+    if (row.plaintext.size() > ENVELOPE_MAX_PLAINTEXT)
+    {
+        return "ssid|password longer than 48 bytes";
+    }
+    return nullptr;
+}
+
+EnvelopeError encoder_encrypt_row(mbedtls_aes_context &enc, const EncoderKey &key,
+                                  const uint8_t iv[ENVELOPE_IV_SIZE], const DeviceRow &row, std::string &payload)
+{
+    char b64[128];
+    EnvelopeError error = envelope_encrypt(enc, key.id, iv, row.plaintext.c_str(), b64, sizeof(b64));
+    if (error == EnvelopeError::None)
+    {
+        payload = b64;
+    }
+    return error;
+}
+
+bool encoder_verify_row(EnvelopeKeyRing &ring, const DeviceRow &row, const std::string &payload)
+{
+    char plaintext[128];
+    WifiCredentials creds;
+    bool ok = envelope_decrypt_keyring(ring, payload.c_str(), plaintext, sizeof(plaintext)) == EnvelopeError::None &&
+              parse_credentials(plaintext, creds) && row.ssid == creds.ssid && row.password == creds.password;
+    wipe_credentials(creds);
+    memset(plaintext, 0, sizeof(plaintext));
+    return ok;
+}
+
+static std::string json_escape(const std::string &s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+        }
+        if ((unsigned char)c >= 0x20)
+        {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string encoder_json_line(const DeviceRow &row, const std::string &payload)
+{
+    return "{\"device\":\"" + json_escape(row.device) + "\",\"data\":\"" + payload + "\"}";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "envelope.h"
+
+// ===========================================================
+// Batch Encoder Core (tools/encoder)
+// ===========================================================
+// Row parsing, validation and per-row encryption for the host batch
+// encoder, kept out of its main() so native tests run the same code
+// against the firmware decoder. Host only: uses std::string.
+
+// Demo key the firmware ships with in slot 0
+static const uint8_t ENCODER_DEMO_KEY[ENVELOPE_KEY_SIZE] = {'t', 'h', 'i', 's', 'i', 's', 'm', 'y',
+                                                            'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+
+struct EncoderKey
+{
+    uint8_t key[ENVELOPE_KEY_SIZE];
+    int id; // Slot written into the envelope, or ENVELOPE_NO_KEY_ID
+};
+
+struct DeviceRow
+{
+    size_t line;
+    std::string device;
+    std::string plaintext; // "ssid|password"
+    std::string ssid;
+    std::string password;
+};
+
+// "[ID:]<32 hex chars>"; out is untouched on failure
+bool encoder_parse_key(const char *arg, EncoderKey &out);
+
+// Split "device_id,ssid,password"; the password is the rest of the line,
+// so it may contain commas. False if there are fewer than three fields.
+bool encoder_split_row(const char *line, size_t line_no, DeviceRow &row);
+
+// Why parse_credentials would not hand the row back unchanged, or
+// nullptr if it would
+const char *encoder_validate(const DeviceRow &row);
+
+// enc must hold the encryption schedule for key
+EnvelopeError encoder_encrypt_row(mbedtls_aes_context &enc, const EncoderKey &key,
+                                  const uint8_t iv[ENVELOPE_IV_SIZE], const DeviceRow &row, std::string &payload);
+
+// Decode payload with the firmware path and compare against row
+bool encoder_verify_row(EnvelopeKeyRing &ring, const DeviceRow &row, const std::string &payload);
+
+// {"device":"<id>","data":"<payload>"}, no newline
+std::string encoder_json_line(const DeviceRow &row, const std::string &payload);
@@ -0,0 +1,158 @@
+#include "boot_button.h"
+#include "static_alloc.h"
+#include "logger.h"
+#include "event_bus.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include <driver/gpio.h>
+
+static int buttonPin = -1;
+static GestureDetector detector;
+static bool stablePressed = false;
+static TimerHandle_t debounceTimer = NULL;
+static TimerHandle_t deadlineTimer = NULL;
+static GestureAction actions[(size_t)ButtonGesture::Count] = {};
+
+const char *gesture_name(ButtonGesture gesture)
+{
+    switch (gesture)
+    {
+    case ButtonGesture::ShortPress:
+        return "short";
+    case ButtonGesture::DoublePress:
+        return "double";
+    case ButtonGesture::LongPress:
+        return "long";
+    case ButtonGesture::VeryLongPress:
+        return "very-long";
+    default:
+        return "none";
+    }
+}
+
+static void publish(ButtonGesture gesture)
+{
+    if (gesture != ButtonGesture::None)
+    {
+        // Never blocks the timer task; a full ring drops the gesture
+        BusEvent event;
+        event.type = BusEventType::ButtonGesture;
+        event.gesture = gesture;
+        event_bus_publish(event);
+    }
+}
+
+// Re-arm (or stop) the deadline timer to match the detector state
+static void arm_deadline()
+{
+    uint32_t deadline;
+    if (!detector.next_deadline(deadline))
+    {
+        xTimerStop(deadlineTimer, 0);
+        return;
+    }
+    int32_t remaining = (int32_t)(deadline - millis());
+    TickType_t ticks = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+    xTimerChangePeriod(deadlineTimer, ticks, 0);
+}
+
+// Both timer callbacks run in the FreeRTOS timer task, so the detector
+// is only ever touched from one context.
+static void on_debounce_timer(TimerHandle_t)
+{
+    bool pressed = digitalRead(buttonPin) == LOW;
+    if (pressed == stablePressed)
+    {
+        return; // Bounce settled back to the previous level
+    }
+    stablePressed = pressed;
+    publish(detector.on_edge(pressed, millis()));
+    arm_deadline();
+}
+
+static void on_deadline_timer(TimerHandle_t)
+{
+    publish(detector.on_timeout(millis()));
+    arm_deadline();
+}
+
+// Interrupt (and light-sleep wake) on the opposite of the current level.
+// gpio_wakeup_enable() runs from flash; the core's GPIO ISR service is
+// not installed with ESP_INTR_FLAG_IRAM, so the ISR never runs with the
+// cache disabled.
+static void arm_level()
+{
+    gpio_num_t pin = (gpio_num_t)buttonPin;
+    gpio_wakeup_enable(pin, gpio_get_level(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+}
+
+static void IRAM_ATTR on_button_edge()
+{
+    // A level interrupt keeps firing until it is re-armed
+    arm_level();
+    BaseType_t woken = pdFALSE;
+    xTimerResetFromISR(debounceTimer, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool boot_button_begin(int pin, const GestureTiming &timing)
+{
+    buttonPin = pin;
+    detector = GestureDetector(timing);
+    pinMode(buttonPin, INPUT_PULLUP);
+    stablePressed = digitalRead(buttonPin) == LOW;
+
+#if STATIC_ALLOCATION
+    static StaticTimer_t debounceStorage;
+    static StaticTimer_t deadlineStorage;
+    debounceTimer = xTimerCreateStatic("btnDebounce", pdMS_TO_TICKS(timing.debounce_ms), pdFALSE, NULL,
+                                       on_debounce_timer, &debounceStorage);
+    deadlineTimer = xTimerCreateStatic("btnDeadline", 1, pdFALSE, NULL, on_deadline_timer, &deadlineStorage);
+#else
+    debounceTimer = xTimerCreate("btnDebounce", pdMS_TO_TICKS(timing.debounce_ms), pdFALSE, NULL, on_debounce_timer);
+    deadlineTimer = xTimerCreate("btnDeadline", 1, pdFALSE, NULL, on_deadline_timer);
+#endif
+    if (!debounceTimer || !deadlineTimer)
+    {
+        LOG_ERROR("Boot button init failed");
+        return false;
+    }
+    if (stablePressed)
+    {
+        // Held through boot: start timing the press right away
+        detector.on_edge(true, millis());
+        arm_deadline();
+    }
+    attachInterrupt(digitalPinToInterrupt(buttonPin), on_button_edge, stablePressed ? ONHIGH : ONLOW);
+    arm_level();
+    return true;
+}
+
+void boot_button_set_action(ButtonGesture gesture, GestureAction action)
+{
+    if (gesture < ButtonGesture::Count)
+    {
+        actions[(size_t)gesture] = action;
+    }
+}
+
+void boot_button_dispatch(ButtonGesture gesture)
+{
+    if (gesture == ButtonGesture::None || gesture >= ButtonGesture::Count)
+    {
+        return;
+    }
+    LOG_INFO("Button gesture: %s", gesture_name(gesture));
+    GestureAction action = actions[(size_t)gesture];
+    if (action)
+    {
+        action();
+    }
+}
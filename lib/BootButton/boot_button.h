@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+#include "gesture_detector.h"
+
+// ===========================================================
+// Boot Button Driver (interrupt + timer debounced)
+// ===========================================================
+// A GPIO interrupt restarts a one-shot debounce timer; when the level
+// has been stable for debounce_ms the timer task feeds the gesture
+// detector. A second one-shot timer covers gesture deadlines, so
+// nothing polls the pin. Completed gestures are published on the event
+// bus; the consumer hands them to boot_button_dispatch().
+//
+// The interrupt is level-triggered on the level the pin is not at, and
+// the ISR flips it on every change, which makes it behave as CHANGE.
+// Light sleep can only wake on a GPIO level, and the pin's wake level
+// is its interrupt type, so the same arming also lets the button wake
+// the chip (see power_manager_enable_gpio_wakeup) without losing edges.
+
+typedef void (*GestureAction)();
+
+bool boot_button_begin(int pin, const GestureTiming &timing = GestureTiming());
+
+// Bind an action to a gesture; nullptr unbinds it.
+void boot_button_set_action(ButtonGesture gesture, GestureAction action);
+
+// Log a gesture received from the bus and run its action
+void boot_button_dispatch(ButtonGesture gesture);
+
+const char *gesture_name(ButtonGesture gesture);
@@ -0,0 +1,134 @@
+#include "boot_profiler.h"
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+static const uint32_t PROFILE_MAGIC = 0xB0071E55;
+
+// [0] is this boot, [1] the previous one. RTC_NOINIT keeps both across
+// software resets; a power-on clears the magic.
+RTC_NOINIT_ATTR static BootProfile rtcProfiles[2];
+static uint32_t phaseStartCycles[(size_t)BootPhase::Count];
+
+static const char *phase_names[(size_t)BootPhase::Count] = {
+    "serial_init", "display_init", "prefs_read", "wifi_connect", "ap_start", "server_begin"};
+
+const char *boot_phase_name(BootPhase phase)
+{
+    return phase < BootPhase::Count ? phase_names[(size_t)phase] : "unknown";
+}
+
+void boot_profile_start()
+{
+    uint32_t boot_count = 0;
+    if (rtcProfiles[0].magic == PROFILE_MAGIC)
+    {
+        rtcProfiles[1] = rtcProfiles[0];
+        boot_count = rtcProfiles[0].boot_count;
+    }
+    else
+    {
+        rtcProfiles[1].magic = 0;
+    }
+    memset(&rtcProfiles[0], 0, sizeof(BootProfile));
+    rtcProfiles[0].magic = PROFILE_MAGIC;
+    rtcProfiles[0].boot_count = boot_count + 1;
+    rtcProfiles[0].reset_reason = (uint32_t)esp_reset_reason();
+}
+
+void boot_profile_begin(BootPhase phase)
+{
+    size_t i = (size_t)phase;
+    rtcProfiles[0].phases[i].start_us = (uint32_t)esp_timer_get_time();
+    phaseStartCycles[i] = ESP.getCycleCount();
+}
+
+void boot_profile_end(BootPhase phase)
+{
+    size_t i = (size_t)phase;
+    // The cycle counter wraps every ~17 s at 240 MHz, so it is only
+    // meaningful for short phases; the microsecond stamps cover the rest.
+    rtcProfiles[0].phases[i].cycles = ESP.getCycleCount() - phaseStartCycles[i];
+    rtcProfiles[0].phases[i].end_us = (uint32_t)esp_timer_get_time();
+}
+
+void boot_profile_reachable()
+{
+    rtcProfiles[0].reachable_us = (uint32_t)esp_timer_get_time();
+}
+
+const BootProfile &boot_profile_current()
+{
+    return rtcProfiles[0];
+}
+
+bool boot_profile_previous(BootProfile &out)
+{
+    if (rtcProfiles[1].magic != PROFILE_MAGIC)
+    {
+        return false;
+    }
+    out = rtcProfiles[1];
+    return true;
+}
+
+void boot_profile_print()
+{
+    const BootProfile &p = rtcProfiles[0];
+    Serial.printf("Boot #%lu (reset reason %lu), reachable at %lu us\n", (unsigned long)p.boot_count,
+                  (unsigned long)p.reset_reason, (unsigned long)p.reachable_us);
+    for (size_t i = 0; i < (size_t)BootPhase::Count; i++)
+    {
+        const BootPhaseRecord &r = p.phases[i];
+        if (r.start_us == 0)
+        {
+            continue;
+        }
+        Serial.printf("  %-13s start %8lu us  took %8lu us  %10lu cycles\n", phase_names[i],
+                      (unsigned long)r.start_us, (unsigned long)(r.end_us - r.start_us), (unsigned long)r.cycles);
+    }
+}
+
+static size_t profile_json(const BootProfile &p, char *out, size_t size)
+{
+    size_t n = snprintf(out, size, "{\"boot_count\":%lu,\"reset_reason\":%lu,\"reachable_us\":%lu,\"phases\":{",
+                        (unsigned long)p.boot_count, (unsigned long)p.reset_reason, (unsigned long)p.reachable_us);
+    bool first = true;
+    for (size_t i = 0; i < (size_t)BootPhase::Count && n < size; i++)
+    {
+        const BootPhaseRecord &r = p.phases[i];
+        if (r.start_us == 0)
+        {
+            continue;
+        }
+        n += snprintf(out + n, size - n, "%s\"%s\":{\"start_us\":%lu,\"duration_us\":%lu,\"cycles\":%lu}",
+                      first ? "" : ",", phase_names[i], (unsigned long)r.start_us,
+                      (unsigned long)(r.end_us - r.start_us), (unsigned long)r.cycles);
+        first = false;
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "}}");
+    }
+    return n < size ? n : size - 1;
+}
+
+size_t boot_profile_to_json(char *out, size_t size)
+{
+    size_t n = snprintf(out, size, "{\"current\":");
+    n += profile_json(rtcProfiles[0], out + n, size - n);
+    BootProfile previous;
+    if (n < size && boot_profile_previous(previous))
+    {
+        n += snprintf(out + n, size - n, ",\"previous\":");
+        if (n < size)
+        {
+            n += profile_json(previous, out + n, size - n);
+        }
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "}");
+    }
+    return n < size ? n : size - 1;
+}
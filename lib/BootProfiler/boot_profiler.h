@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===========================================================
+// Boot-Time Profiler
+// ===========================================================
+// Timestamps each setup() phase in microseconds since reset plus the CPU
+// cycle count spent inside it. The record lives in RTC memory, so the
+// previous boot's profile survives a software reset and can be compared
+// with the current one.
+
+enum class BootPhase : uint8_t
+{
+    SerialInit,
+    DisplayInit,
+    PrefsRead,
+    WifiConnect,
+    ApStart,
+    ServerBegin,
+    Count
+};
+
+struct BootPhaseRecord
+{
+    uint32_t start_us; // 0 if the phase did not run this boot
+    uint32_t end_us;
+    uint32_t cycles;
+};
+
+struct BootProfile
+{
+    uint32_t magic;
+    uint32_t boot_count;
+    uint32_t reset_reason;
+    uint32_t reachable_us; // server.begin() returned
+    BootPhaseRecord phases[(size_t)BootPhase::Count];
+};
+
+// Call first thing in setup(); rotates the RTC record
+void boot_profile_start();
+
+void boot_profile_begin(BootPhase phase);
+void boot_profile_end(BootPhase phase);
+
+// Boot-to-reachable mark, taken once the HTTP server is listening
+void boot_profile_reachable();
+
+const BootProfile &boot_profile_current();
+// False if there is no profile from a previous boot
+bool boot_profile_previous(BootProfile &out);
+
+const char *boot_phase_name(BootPhase phase);
+void boot_profile_print();
+size_t boot_profile_to_json(char *out, size_t size);
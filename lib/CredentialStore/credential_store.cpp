@@ -0,0 +1,93 @@
+#include "credential_store.h"
+#include <Preferences.h>
+#include <string.h>
+
+static const char *kNamespace = "wifi";
+static const char *kKeyNamespace = "keys";
+
+bool credential_store_load(WifiCredentials &out)
+{
+    Preferences preferences;
+    preferences.begin(kNamespace, true);
+    // Read straight into the fixed buffers; no String copies
+    size_t ssid_len = preferences.getString("ssid", out.ssid, sizeof(out.ssid));
+    size_t password_len = preferences.getString("password", out.password, sizeof(out.password));
+    preferences.end();
+    if (ssid_len == 0 || password_len == 0 || out.ssid[0] == '\0' || out.password[0] == '\0')
+    {
+        wipe_credentials(out);
+        return false;
+    }
+    return true;
+}
+
+void credential_store_save(const WifiCredentials &creds)
+{
+    Preferences preferences;
+    preferences.begin(kNamespace, false);
+    preferences.putString("ssid", creds.ssid);
+    preferences.putString("password", creds.password);
+    preferences.end();
+}
+
+void credential_store_clear()
+{
+    Preferences preferences;
+    preferences.begin(kNamespace, false);
+    preferences.clear();
+    preferences.end();
+}
+
+static void key_name(uint8_t id, char (&name)[4])
+{
+    snprintf(name, sizeof(name), "k%u", (unsigned)id);
+}
+
+size_t credential_store_load_keys(EnvelopeKeyRing &ring)
+{
+    Preferences preferences;
+    if (!preferences.begin(kKeyNamespace, true))
+    {
+        return 0; // Namespace not created yet
+    }
+    size_t loaded = 0;
+    uint8_t key[ENVELOPE_KEY_SIZE];
+    for (uint8_t id = 0; id < ENVELOPE_KEY_SLOTS; id++)
+    {
+        char name[4];
+        key_name(id, name);
+        if (preferences.getBytesLength(name) == sizeof(key) && preferences.getBytes(name, key, sizeof(key)) == sizeof(key) &&
+            envelope_keyring_set(ring, id, key))
+        {
+            loaded++;
+        }
+    }
+    memset(key, 0, sizeof(key));
+    preferences.end();
+    return loaded;
+}
+
+bool credential_store_save_key(uint8_t id, const uint8_t key[ENVELOPE_KEY_SIZE])
+{
+    if (id >= ENVELOPE_KEY_SLOTS)
+    {
+        return false;
+    }
+    char name[4];
+    key_name(id, name);
+    Preferences preferences;
+    preferences.begin(kKeyNamespace, false);
+    bool ok = preferences.putBytes(name, key, ENVELOPE_KEY_SIZE) == ENVELOPE_KEY_SIZE;
+    preferences.end();
+    return ok;
+}
+
+void credential_store_remove_key(uint8_t id)
+{
+    char name[4];
+    key_name(id, name);
+    Preferences preferences;
+    preferences.begin(kKeyNamespace, false);
+    preferences.remove(name);
+    preferences.end();
+}
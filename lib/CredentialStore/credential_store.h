@@ -0,0 +1,24 @@
+#pragma once
+
+#include "credentials.h"
+#include "envelope.h"
+
+// ===========================================================
+// Credential Store (NVS "wifi" namespace)
+// ===========================================================
+
+// Load stored credentials; false if none are stored
+bool credential_store_load(WifiCredentials &out);
+void credential_store_save(const WifiCredentials &creds);
+void credential_store_clear();
+
+// ===========================================================
+// Envelope Keys (NVS "keys" namespace, blobs "k0".."k7")
+// ===========================================================
+// Kept apart from the Wi-Fi credentials so a factory reset does not
+// drop the fleet keys. Written by POST /keys (see http_api.h).
+
+// Expand every stored key into its ring slot; returns how many loaded
+size_t credential_store_load_keys(EnvelopeKeyRing &ring);
+bool credential_store_save_key(uint8_t id, const uint8_t key[ENVELOPE_KEY_SIZE]);
+void credential_store_remove_key(uint8_t id);
@@ -0,0 +1,40 @@
+#include "credentials.h"
+#include <stdio.h>
+#include <string.h>
+
+void clean_string(char *str)
+{
+    int len = strlen(str);
+    int i = 0, j = 0;
+    while (i < len)
+    {
+        if (str[i] > 0x1F && str[i] < 0x7F)
+        {
+            str[j++] = str[i];
+        }
+        i++;
+    }
+    str[j] = '\0';
+}
+
+bool parse_credentials(const char *raw, WifiCredentials &out)
+{
+    if (sscanf(raw, "%63[^|]|%63s", out.ssid, out.password) != 2)
+    {
+        return false;
+    }
+    out.ssid[CREDENTIAL_FIELD_SIZE - 1] = '\0';
+    out.password[CREDENTIAL_FIELD_SIZE - 1] = '\0';
+    clean_string(out.ssid);
+    clean_string(out.password);
+    return true;
+}
+
+void wipe_credentials(WifiCredentials &creds)
+{
+    volatile char *p = (volatile char *)&creds;
+    for (size_t i = 0; i < sizeof(creds); i++)
+    {
+        p[i] = 0;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+// ===========================================================
+// WiFi Credential Parsing
+// ===========================================================
+// Decrypted credentials arrive as "ssid|password". Parsing is pure C so
+// it builds on the host.
+
+static const size_t CREDENTIAL_FIELD_SIZE = 64;
+
+struct WifiCredentials
+{
+    char ssid[CREDENTIAL_FIELD_SIZE];
+    char password[CREDENTIAL_FIELD_SIZE];
+};
+
+// Parse "ssid|password" into out and strip non-printable characters.
+// Returns false if either field is missing.
+bool parse_credentials(const char *raw, WifiCredentials &out);
+
+// Remove every byte outside printable ASCII (0x20-0x7E) in place
+void clean_string(char *str);
+
+// Overwrite both fields so secrets do not linger on the stack
+void wipe_credentials(WifiCredentials &creds);
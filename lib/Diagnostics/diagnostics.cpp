@@ -0,0 +1,261 @@
+#include "diagnostics.h"
+#include "static_alloc.h"
+#include "logger.h"
+#include <esp_heap_caps.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+static TaskStackSample tasks[DIAG_MAX_TASKS];
+static size_t taskCount = 0;
+static TimingSample timings[DIAG_MAX_TIMINGS];
+static size_t timingCount = 0;
+static const char *sectionNames[DIAG_MAX_SECTIONS];
+static DiagSectionWriter sectionWriters[DIAG_MAX_SECTIONS];
+static size_t sectionCount = 0;
+static HeapSample heap = {};
+static uint32_t sampleCount = 0;
+static bool serialReport = false;
+static TimerHandle_t sampleTimer = NULL;
+static TaskHandle_t reportTask = NULL;
+static portMUX_TYPE diagMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool diagnostics_track_task(const char *name)
+{
+    if (taskCount >= DIAG_MAX_TASKS)
+    {
+        return false;
+    }
+    tasks[taskCount].name = name;
+    tasks[taskCount].seen = false;
+    tasks[taskCount].stack_free_min = UINT32_MAX;
+    taskCount++;
+    return true;
+}
+
+bool diagnostics_register_section(const char *name, DiagSectionWriter writer)
+{
+    if (sectionCount >= DIAG_MAX_SECTIONS || !writer)
+    {
+        return false;
+    }
+    sectionNames[sectionCount] = name;
+    sectionWriters[sectionCount] = writer;
+    sectionCount++;
+    return true;
+}
+
+void diagnostics_sample()
+{
+    uint32_t stack_free[DIAG_MAX_TASKS];
+    for (size_t i = 0; i < taskCount; i++)
+    {
+        TaskHandle_t handle = xTaskGetHandle(tasks[i].name);
+        // On ESP-IDF the high-water mark is reported in bytes
+        stack_free[i] = handle ? uxTaskGetStackHighWaterMark(handle) : UINT32_MAX;
+    }
+    uint32_t free_now = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint32_t free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    uint32_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    portENTER_CRITICAL(&diagMux);
+    for (size_t i = 0; i < taskCount; i++)
+    {
+        if (stack_free[i] != UINT32_MAX)
+        {
+            tasks[i].seen = true;
+            if (stack_free[i] < tasks[i].stack_free_min)
+            {
+                tasks[i].stack_free_min = stack_free[i];
+            }
+        }
+    }
+    heap.free_now = free_now;
+    heap.free_min = free_min;
+    heap.largest_block = largest;
+    heap.internal_free = internal_free;
+    heap.psram_free = psram_free;
+    if (sampleCount == 0 || largest < heap.largest_block_min)
+    {
+        heap.largest_block_min = largest;
+    }
+    sampleCount++;
+    portEXIT_CRITICAL(&diagMux);
+}
+
+void diagnostics_record_timing(const char *name, uint32_t us)
+{
+    portENTER_CRITICAL(&diagMux);
+    TimingSample *t = nullptr;
+    for (size_t i = 0; i < timingCount; i++)
+    {
+        if (strcmp(timings[i].name, name) == 0)
+        {
+            t = &timings[i];
+            break;
+        }
+    }
+    if (!t && timingCount < DIAG_MAX_TIMINGS)
+    {
+        t = &timings[timingCount++];
+        t->name = name;
+    }
+    if (t)
+    {
+        t->count++;
+        t->total_us += us;
+        if (us > t->max_us)
+        {
+            t->max_us = us;
+        }
+    }
+    portEXIT_CRITICAL(&diagMux);
+}
+
+// Runs on the timer service task, which also debounces the boot button:
+// sample and hand the report to reportTask, never format or print here
+static void on_sample_timer(TimerHandle_t)
+{
+    diagnostics_sample();
+    if (reportTask)
+    {
+        xTaskNotifyGive(reportTask);
+    }
+}
+
+static void report_task(void *)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        diagnostics_print();
+    }
+}
+
+bool diagnostics_begin(uint32_t period_ms, bool serial_report)
+{
+    serialReport = serial_report;
+    if (taskCount == 0)
+    {
+        diagnostics_track_task("loopTask");
+        diagnostics_track_task("async_tcp");
+        diagnostics_track_task("ConnectToWiFi");
+        diagnostics_track_task("Tmr Svc");
+        diagnostics_track_task("diagReport");
+    }
+    if (serialReport)
+    {
+#if STATIC_ALLOCATION
+        static StaticTask_t reportTcb;
+        static StackType_t reportStack[2560];
+        reportTask = xTaskCreateStatic(report_task, "diagReport", sizeof(reportStack), NULL, tskIDLE_PRIORITY + 1,
+                                       reportStack, &reportTcb);
+#else
+        xTaskCreate(report_task, "diagReport", 2560, NULL, tskIDLE_PRIORITY + 1, &reportTask);
+#endif
+        if (!reportTask)
+        {
+            LOG_ERROR("Diagnostics report task creation failed");
+            return false;
+        }
+    }
+#if STATIC_ALLOCATION
+    static StaticTimer_t timerStorage;
+    sampleTimer = xTimerCreateStatic("diag", pdMS_TO_TICKS(period_ms), pdTRUE, NULL, on_sample_timer, &timerStorage);
+#else
+    sampleTimer = xTimerCreate("diag", pdMS_TO_TICKS(period_ms), pdTRUE, NULL, on_sample_timer);
+#endif
+    if (!sampleTimer)
+    {
+        LOG_ERROR("Diagnostics timer creation failed");
+        return false;
+    }
+    diagnostics_sample();
+    return xTimerStart(sampleTimer, 0) == pdPASS;
+}
+
+// Through the logger in slot-sized chunks, waiting (bounded) for ring
+// room so a report neither drops lines nor crowds out other messages
+void diagnostics_print()
+{
+    static const size_t CHUNK = LOG_SLOT_TEXT - 24; // Room for the "Diagnostics [nn/nn] " prefix
+    static const size_t RESERVE = 4;                // Slots left for everyone else
+    static const int WAIT_ROUNDS = 20;
+    // Static: one report at a time, and too large for a small stack
+    static char buffer[DIAG_JSON_SIZE];
+    size_t len = diagnostics_to_json(buffer, sizeof(buffer));
+    unsigned parts = (unsigned)((len + CHUNK - 1) / CHUNK);
+    for (unsigned part = 0; part < parts; part++)
+    {
+        for (int i = 0; i < WAIT_ROUNDS && logger_free_slots() <= RESERVE; i++)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        size_t offset = part * CHUNK;
+        size_t n = len - offset < CHUNK ? len - offset : CHUNK;
+        LOG_INFO("Diagnostics [%u/%u] %.*s", part + 1, parts, (int)n, buffer + offset);
+    }
+}
+
+size_t diagnostics_to_json(char *out, size_t size)
+{
+    portENTER_CRITICAL(&diagMux);
+    HeapSample h = heap;
+    TaskStackSample t[DIAG_MAX_TASKS];
+    size_t count = taskCount;
+    memcpy(t, tasks, sizeof(TaskStackSample) * count);
+    uint32_t samples = sampleCount;
+    TimingSample tm[DIAG_MAX_TIMINGS];
+    size_t tm_count = timingCount;
+    memcpy(tm, timings, sizeof(TimingSample) * tm_count);
+    portEXIT_CRITICAL(&diagMux);
+
+    size_t n = snprintf(out, size,
+                        "{\"uptime_ms\":%lu,\"samples\":%lu,\"heap\":{\"free\":%lu,\"min_free\":%lu,"
+                        "\"largest_block\":%lu,\"largest_block_min\":%lu,\"internal_free\":%lu,"
+                        "\"psram_free\":%lu},\"tasks\":[",
+                        (unsigned long)millis(), (unsigned long)samples, (unsigned long)h.free_now,
+                        (unsigned long)h.free_min, (unsigned long)h.largest_block,
+                        (unsigned long)h.largest_block_min, (unsigned long)h.internal_free,
+                        (unsigned long)h.psram_free);
+    bool first = true;
+    for (size_t i = 0; i < count && n < size; i++)
+    {
+        if (!t[i].seen)
+        {
+            continue;
+        }
+        n += snprintf(out + n, size - n, "%s{\"name\":\"%s\",\"stack_free_min\":%lu}", first ? "" : ",",
+                      t[i].name, (unsigned long)t[i].stack_free_min);
+        first = false;
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "],\"timings\":[");
+    }
+    for (size_t i = 0; i < tm_count && n < size; i++)
+    {
+        n += snprintf(out + n, size - n, "%s{\"name\":\"%s\",\"count\":%lu,\"avg_us\":%lu,\"max_us\":%lu}",
+                      i ? "," : "", tm[i].name, (unsigned long)tm[i].count,
+                      (unsigned long)(tm[i].count ? tm[i].total_us / tm[i].count : 0), (unsigned long)tm[i].max_us);
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "]");
+    }
+    for (size_t i = 0; i < sectionCount && n < size; i++)
+    {
+        n += snprintf(out + n, size - n, ",\"%s\":", sectionNames[i]);
+        if (n < size)
+        {
+            n += sectionWriters[i](out + n, size - n);
+        }
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "}");
+    }
+    return n < size ? n : size - 1;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// ===========================================================
+// Runtime Diagnostics (stack and heap high-water marks)
+// ===========================================================
+// A periodic timer samples each tracked task's stack high-water mark and
+// the heap counters, keeping the worst value seen. The snapshot is served
+// at GET /diag and optionally printed to serial, so stack sizes can be
+// trimmed to measured usage instead of guesses.
+//
+// Other modules add their own counters to the snapshot by registering a
+// section: a writer that serializes one JSON object, which appears under
+// its name at the top level of /diag.
+
+struct TaskStackSample
+{
+    const char *name;
+    bool seen;                // Task existed at least once when sampled
+    uint32_t stack_free_min;  // Smallest unused stack seen, in bytes
+};
+
+struct HeapSample
+{
+    uint32_t free_now;
+    uint32_t free_min;        // Minimum ever free heap since boot
+    uint32_t largest_block;   // Largest allocatable block right now
+    uint32_t largest_block_min;
+    uint32_t internal_free;   // Internal DRAM only (excludes PSRAM)
+    uint32_t psram_free;
+};
+
+struct TimingSample
+{
+    const char *name;
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+// Writes one JSON object ({...}); returns what snprintf would have. May
+// run on the report task or async_tcp: never block on a lock that is
+// held across I/O.
+typedef size_t (*DiagSectionWriter)(char *out, size_t size);
+
+static const size_t DIAG_MAX_TASKS = 8;
+static const size_t DIAG_MAX_TIMINGS = 8;
+static const size_t DIAG_MAX_SECTIONS = 8;
+static const size_t DIAG_JSON_SIZE = 2048; // Worst case for diagnostics_to_json
+
+// Track a task by FreeRTOS name; short-lived tasks are picked up whenever
+// they happen to be running at sample time.
+bool diagnostics_track_task(const char *name);
+
+// Add a named section to the snapshot; call during setup. name must be
+// static.
+bool diagnostics_register_section(const char *name, DiagSectionWriter writer);
+
+// serial_report starts a low-priority task that logs each snapshot; the
+// timer itself only samples
+bool diagnostics_begin(uint32_t period_ms = 10000, bool serial_report = false);
+void diagnostics_sample();
+
+// Log the snapshot in chunks through the logger; blocks while the ring
+// is nearly full, so not for the timer task
+void diagnostics_print();
+
+// Accumulate one duration under a static name (e.g. a handler)
+void diagnostics_record_timing(const char *name, uint32_t us);
+
+// Serialize the current snapshot as JSON; returns bytes written
+size_t diagnostics_to_json(char *out, size_t size);
+
+// Records the time from construction to stop() or destruction
+class ScopedTiming
+{
+public:
+    explicit ScopedTiming(const char *name) : name_(name), start_us_(esp_timer_get_time()) {}
+    ~ScopedTiming() { stop(); }
+
+    void stop()
+    {
+        if (name_)
+        {
+            diagnostics_record_timing(name_, (uint32_t)(esp_timer_get_time() - start_us_));
+            name_ = nullptr;
+        }
+    }
+
+private:
+    const char *name_;
+    int64_t start_us_;
+};
@@ -0,0 +1,434 @@
+#include "display_renderer.h"
+#include "font5x7.h"
+#include "font_prop8.h"
+#include "unicode_font.h"
+#include "power_manager.h"
+#include "logger.h"
+#include "diagnostics.h"
+#include "static_alloc.h"
+#include "block_pool.h"
+#include "utf8.h"
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include "esp_idf_version.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#if DISPLAY_RENDER_BENCHMARK
+#include <Adafruit_GFX.h>
+#endif
+
+#if DISPLAY_HEADLESS
+static DisplayPanel panel;
+#elif DISPLAY_I2C_NATIVE
+static DisplayPanel panel(IdfI2cTransport(DISPLAY_I2C_PORT, DISPLAY_ADDRESS));
+#else
+static DisplayPanel panel(WireTransport(Wire, DISPLAY_ADDRESS));
+#endif
+
+static PageCanvas<DisplayGeometry> canvas(panel.buffer());
+
+// Guards the canvas, the glyph cache LRU and the layout cache. Drawing
+// normally happens on the bus consumer only (display_request), but the
+// /diag sections read the cache statistics from other tasks.
+static SemaphoreHandle_t displayMutex = NULL;
+
+class DisplayLock
+{
+public:
+    explicit DisplayLock(TickType_t wait = portMAX_DELAY) : held_(xSemaphoreTake(displayMutex, wait) == pdTRUE) {}
+    ~DisplayLock()
+    {
+        if (held_)
+        {
+            xSemaphoreGive(displayMutex);
+        }
+    }
+    DisplayLock(const DisplayLock &) = delete;
+    DisplayLock &operator=(const DisplayLock &) = delete;
+
+    bool held() const { return held_; }
+
+private:
+    bool held_;
+};
+
+// /diag section writers run on the report task or async_tcp, and a
+// drawer holds the lock across an I2C flush: they never wait for it
+static const char DISPLAY_BUSY_JSON[] = "{\"busy\":true}";
+
+// ===========================================================
+// Font Partition
+// ===========================================================
+// Written by `pio run -t uploadfont` (scripts/font_atlas.py); stays
+// mapped for the lifetime of the firmware
+static const esp_partition_subtype_t FONT_PARTITION_SUBTYPE = (esp_partition_subtype_t)0x40;
+static const char *FONT_PARTITION_LABEL = "font";
+
+static GlyphStore glyphStore;
+static UnicodeFont<GLYPH_CACHE_SLOTS, GLYPH_CACHE_GLYPH_BYTES> textFont(FONT_PROP8, glyphStore);
+static LayoutCache<DISPLAY_LAYOUT_SLOTS> layoutCache;
+
+static void font_partition_begin()
+{
+    const esp_partition_t *part =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, FONT_PARTITION_SUBTYPE, FONT_PARTITION_LABEL);
+    if (!part)
+    {
+        LOG_WARN("Display: no font partition, non-ASCII text shows as '?'");
+        return;
+    }
+    const void *mapped = nullptr;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &mapped, &handle);
+#else
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &mapped, &handle);
+#endif
+    if (err != ESP_OK)
+    {
+        LOG_WARN("Display: font partition mmap failed (%d)", (int)err);
+        return;
+    }
+    if (!glyphStore.attach((const uint8_t *)mapped, part->size))
+    {
+        LOG_WARN("Display: font partition holds no glyph image; run `pio run -t uploadfont`");
+        esp_partition_munmap(handle);
+        return;
+    }
+    LOG_INFO("Display: %u glyphs in the font partition", (unsigned)glyphStore.count());
+}
+
+#if DISPLAY_BUS_BENCHMARK && !DISPLAY_HEADLESS
+// ===========================================================
+// Bus Benchmark (Wire vs native driver)
+// ===========================================================
+static const int BENCH_FRAMES = 20;
+
+// Average microseconds per full frame; the panel must already be set up
+template <class Transport>
+static uint32_t time_frames(Transport &transport, const uint8_t *frame)
+{
+    int64_t started = esp_timer_get_time();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        if (!DisplayController::write_pages<DisplayGeometry>(transport, frame, 0, DisplayGeometry::pages - 1))
+        {
+            return 0;
+        }
+    }
+    return (uint32_t)((esp_timer_get_time() - started) / BENCH_FRAMES);
+}
+
+static void run_bus_benchmark(int sda_pin, int scl_pin)
+{
+    static const uint32_t clocks[] = {100000, 400000, 1000000};
+    PowerLockGuard lock(PowerLock::I2C);
+    LOG_INFO("Display bus benchmark: %s %ux%u, %d frames per run", DisplayController::name,
+             (unsigned)DisplayGeometry::width, (unsigned)DisplayGeometry::height, BENCH_FRAMES);
+    for (uint32_t hz : clocks)
+    {
+        Wire.begin(sda_pin, scl_pin);
+        WireTransport wire(Wire, DISPLAY_ADDRESS, hz);
+        wire.begin();
+        uint32_t wire_us = time_frames(wire, panel.buffer());
+        uint32_t wire_tx = wire.transactions() / BENCH_FRAMES;
+        wire.end();
+
+        IdfI2cTransport native(DISPLAY_I2C_PORT, DISPLAY_ADDRESS, hz);
+        native.set_pins(sda_pin, scl_pin);
+        uint32_t native_us = native.begin() ? time_frames(native, panel.buffer()) : 0;
+        uint32_t native_tx = native.transactions() / BENCH_FRAMES;
+        native.end();
+
+        LOG_INFO("  %4lu kHz: wire %6lu us/frame (%lu tx), native %6lu us/frame (%lu tx)%s",
+                 (unsigned long)(hz / 1000), (unsigned long)wire_us, (unsigned long)wire_tx,
+                 (unsigned long)native_us, (unsigned long)native_tx, wire_us && native_us ? "" : "  [bus error]");
+    }
+}
+#endif
+
+#if DISPLAY_RENDER_BENCHMARK
+// ===========================================================
+// Render Benchmark (page blits vs Adafruit_GFX per-pixel)
+// ===========================================================
+// The previous text path: Adafruit_GFX drawing one pixel at a time into
+// the same page-ordered buffer
+class PixelCanvas : public Adafruit_GFX
+{
+public:
+    PixelCanvas() : Adafruit_GFX(DisplayGeometry::width, DisplayGeometry::height) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override { panel.set_pixel(x, y, color != 0); }
+};
+
+static const int RENDER_ROUNDS = 200;
+
+// Leading characters of text that fit on one unwrapped line
+template <class Font>
+static int chars_per_line(const Font &font, const char *text)
+{
+    char line[96];
+    int fitted = 0;
+    for (int n = 1; text[n - 1] && n < (int)sizeof(line); n++)
+    {
+        memcpy(line, text, n);
+        line[n] = '\0';
+        int w, h;
+        PageCanvas<DisplayGeometry>::measure_text(font, line, w, h, false);
+        if (w > DisplayGeometry::width)
+        {
+            break;
+        }
+        fitted = n;
+    }
+    return fitted;
+}
+
+static void run_render_benchmark()
+{
+    // One full screen of mixed text, at a y that is not page aligned
+    static const char *text = "The quick brown fox jumps over the lazy dog 0123456789 !?#%&*";
+    const int glyphs = (int)strlen(text) * RENDER_ROUNDS;
+    PixelCanvas pixels;
+    pixels.setTextSize(1);
+    pixels.setTextColor(1);
+
+    int64_t started = esp_timer_get_time();
+    for (int i = 0; i < RENDER_ROUNDS; i++)
+    {
+        panel.clear();
+        pixels.setCursor(0, 3);
+        pixels.print(text);
+    }
+    uint32_t gfx_us = (uint32_t)(esp_timer_get_time() - started);
+
+    started = esp_timer_get_time();
+    for (int i = 0; i < RENDER_ROUNDS; i++)
+    {
+        canvas.clear();
+        int x = 0, y = 3;
+        canvas.draw_text(FONT_5X7, x, y, text);
+    }
+    uint32_t blit_us = (uint32_t)(esp_timer_get_time() - started);
+
+    started = esp_timer_get_time();
+    for (int i = 0; i < RENDER_ROUNDS; i++)
+    {
+        canvas.clear();
+        int x = 0, y = 3;
+        canvas.draw_text(FONT_PROP8, x, y, text);
+    }
+    uint32_t atlas_us = (uint32_t)(esp_timer_get_time() - started);
+
+    // Accented text: the first round fills the glyph cache, the rest hit it
+    static const char *accented = "Caf\u00e9 Z\u00fcrich, S\u00e3o Paulo, \u0141\u00f3d\u017a, 12\u00b0C \u20ac5";
+    int accented_glyphs = 0;
+    for (const char *p = accented; *p; accented_glyphs++)
+    {
+        utf8_next(p);
+    }
+    started = esp_timer_get_time();
+    for (int i = 0; i < RENDER_ROUNDS; i++)
+    {
+        canvas.clear();
+        int x = 0, y = 3;
+        canvas.draw_utf8(textFont, x, y, accented);
+    }
+    uint32_t utf8_us = (uint32_t)(esp_timer_get_time() - started);
+    panel.clear();
+
+    LOG_INFO("Render benchmark: Adafruit_GFX %lu glyphs/s, page blit %lu glyphs/s, atlas %lu glyphs/s (%d glyphs)",
+             (unsigned long)(gfx_us ? (uint64_t)glyphs * 1000000 / gfx_us : 0),
+             (unsigned long)(blit_us ? (uint64_t)glyphs * 1000000 / blit_us : 0),
+             (unsigned long)(atlas_us ? (uint64_t)glyphs * 1000000 / atlas_us : 0), glyphs);
+    LOG_INFO("Render benchmark: %d chars per line in 5x7, %d in the atlas font", chars_per_line(FONT_5X7, text),
+             chars_per_line(FONT_PROP8, text));
+    LOG_INFO("Render benchmark: UTF-8 %lu glyphs/s through the glyph cache (%d glyphs)",
+             (unsigned long)(utf8_us ? (uint64_t)accented_glyphs * RENDER_ROUNDS * 1000000 / utf8_us : 0),
+             accented_glyphs * RENDER_ROUNDS);
+}
+#endif
+
+// store_glyphs is 0 when the font partition is missing or holds no image
+static size_t glyph_cache_to_json(char *out, size_t size)
+{
+    GlyphCacheStats glyphs;
+    {
+        DisplayLock locked(0);
+        if (!locked.held())
+        {
+            return snprintf(out, size, "%s", DISPLAY_BUSY_JSON);
+        }
+        glyphs = textFont.stats();
+    }
+    uint32_t lookups = glyphs.hits + glyphs.misses + glyphs.missing;
+    return snprintf(out, size,
+                    "{\"slots\":%u,\"used\":%u,\"hits\":%lu,\"misses\":%lu,\"missing\":%lu,\"evictions\":%lu,"
+                    "\"hit_rate_pct\":%lu,\"store_glyphs\":%u}",
+                    (unsigned)glyphs.slots, (unsigned)glyphs.used, (unsigned long)glyphs.hits,
+                    (unsigned long)glyphs.misses, (unsigned long)glyphs.missing, (unsigned long)glyphs.evictions,
+                    (unsigned long)(lookups ? (uint64_t)glyphs.hits * 100 / lookups : 0), (unsigned)glyphStore.count());
+}
+
+static size_t layout_cache_to_json(char *out, size_t size)
+{
+    LayoutCacheStats layouts;
+    {
+        DisplayLock locked(0);
+        if (!locked.held())
+        {
+            return snprintf(out, size, "%s", DISPLAY_BUSY_JSON);
+        }
+        layouts = layoutCache.stats();
+    }
+    return snprintf(out, size, "{\"hits\":%lu,\"misses\":%lu,\"probes\":%lu}", (unsigned long)layouts.hits,
+                    (unsigned long)layouts.misses, (unsigned long)layouts.probes);
+}
+
+bool display_begin(int sda_pin, int scl_pin)
+{
+#if STATIC_ALLOCATION
+    static StaticSemaphore_t displayMutexStorage;
+    displayMutex = xSemaphoreCreateMutexStatic(&displayMutexStorage);
+#else
+    displayMutex = xSemaphoreCreateMutex();
+#endif
+#if DISPLAY_HEADLESS
+    (void)sda_pin;
+    (void)scl_pin;
+#elif DISPLAY_I2C_NATIVE
+#if DISPLAY_BUS_BENCHMARK
+    run_bus_benchmark(sda_pin, scl_pin);
+#endif
+    panel.transport().set_pins(sda_pin, scl_pin);
+#else
+#if DISPLAY_BUS_BENCHMARK
+    run_bus_benchmark(sda_pin, scl_pin);
+#endif
+    Wire.begin(sda_pin, scl_pin);
+#endif
+    if (!panel.begin())
+    {
+        return false;
+    }
+    panel.clear();
+    font_partition_begin();
+    diagnostics_register_section("glyph_cache", glyph_cache_to_json);
+    diagnostics_register_section("layout_cache", layout_cache_to_json);
+#if DISPLAY_RENDER_BENCHMARK
+    run_render_benchmark();
+#endif
+    return true;
+}
+
+// Caller holds displayMutex
+static void flush_locked()
+{
+    // Keep the chip out of light sleep for the duration of the I2C transfer
+    PowerLockGuard lock(PowerLock::I2C);
+    panel.flush();
+}
+
+void display_flush()
+{
+    DisplayLock locked;
+    flush_locked();
+}
+
+void display_show_lines(const char *line1, const char *line2, const char *line3)
+{
+    DisplayLock locked;
+    canvas.clear();
+    int x = 0, y = 0;
+    const char *lines[] = {line1, line2, line3};
+    for (const char *line : lines)
+    {
+        if (line)
+        {
+            canvas.draw_utf8(textFont, x, y, line);
+            x = 0;
+            y += textFont.line_height();
+        }
+    }
+    flush_locked();
+}
+
+void display_show_centered(const char *msg)
+{
+    DisplayLock locked;
+    canvas.clear();
+
+    // A repeated message reuses its layout; otherwise search for the
+    // largest size that fits and remember the result
+    size_t length;
+    uint64_t hash = text_hash(msg, length);
+    const TextLayout *layout = layoutCache.find(msg, length, hash);
+    if (!layout)
+    {
+        TextLayout &fitted = layoutCache.insert(msg, length, hash);
+        uint32_t probes = 0;
+        TextFitter<DisplayGeometry>::fit(textFont, msg, fitted, probes);
+        layoutCache.count_probes(probes);
+        layout = &fitted;
+    }
+
+    TextFitter<DisplayGeometry>::draw(canvas, textFont, msg, *layout);
+    flush_locked();
+}
+
+// ===========================================================
+// Display Requests (any task -> bus consumer)
+// ===========================================================
+static char requestStorage[DISPLAY_REQUEST_BLOCKS][DISPLAY_TEXT_SIZE];
+static BlockPool<DISPLAY_REQUEST_BLOCKS> requestBlocks(requestStorage, DISPLAY_TEXT_SIZE);
+
+bool display_request(const char *text, DisplayStyle style)
+{
+    char *block = (char *)requestBlocks.acquire();
+    if (!block)
+    {
+        return false;
+    }
+    size_t len = utf8_prefix(text, DISPLAY_TEXT_SIZE - 1);
+    memcpy(block, text, len);
+    block[len] = '\0';
+    BusEvent event;
+    event.type = BusEventType::DisplayRequest;
+    event.display.text = block;
+    event.display.style = style;
+    // The block is the subscriber's only once a ring took the event; with
+    // no subscriber yet, or a full ring, it comes straight back
+    if (event_bus_publish_counted(event) == 0)
+    {
+        requestBlocks.release(block);
+        return false;
+    }
+    return true;
+}
+
+void display_handle_request(const BusEvent &event)
+{
+    char *text = event.display.text;
+    if (event.display.style == DisplayStyle::Lines)
+    {
+        // The block is ours until released, so split it in place
+        char *lines[3] = {text, nullptr, nullptr};
+        for (size_t i = 1; i < 3; i++)
+        {
+            char *end = strchr(lines[i - 1], '\n');
+            if (!end)
+            {
+                break;
+            }
+            *end = '\0';
+            lines[i] = end + 1;
+        }
+        display_show_lines(lines[0], lines[1], lines[2]);
+    }
+    else
+    {
+        display_show_centered(text);
+    }
+    requestBlocks.release(text);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+#include "oled_panel.h"
+#include "wire_transport.h"
+#include "idf_i2c_transport.h"
+#include "page_canvas.h"
+#include "glyph_cache.h"
+#include "text_fit.h"
+#include "event_bus.h"
+
+// ===========================================================
+// OLED Display Renderer
+// ===========================================================
+// The panel is chosen at build time, e.g. -DDISPLAY_HEIGHT=64
+// -DDISPLAY_SH1106=1. DISPLAY_HEADLESS=1 swaps the bus for NullTransport
+// so everything, rendering included, runs without a panel attached.
+// DISPLAY_I2C_NATIVE=0 goes back to Wire; DISPLAY_BUS_BENCHMARK=1 times
+// both transports at each bus clock during display_begin(), and
+// DISPLAY_RENDER_BENCHMARK=1 compares text rendering against Adafruit_GFX.
+// Text is UTF-8: ASCII comes from the FONT_PROP8 atlas, generated from
+// fonts/ at build time; other code points from the "font" partition,
+// through an LRU cache of GLYPH_CACHE_SLOTS rasterized glyphs.
+// The drawing calls below serialize on a display mutex; tasks other than
+// the bus consumer should still use display_request() so the I2C write
+// happens off their own stack and time.
+#ifndef DISPLAY_HEIGHT
+#define DISPLAY_HEIGHT 32
+#endif
+#ifndef DISPLAY_SH1106
+#define DISPLAY_SH1106 0
+#endif
+#ifndef DISPLAY_ADDRESS
+#define DISPLAY_ADDRESS 0x3C
+#endif
+#ifndef DISPLAY_HEADLESS
+#define DISPLAY_HEADLESS 0
+#endif
+#ifndef DISPLAY_I2C_NATIVE
+#define DISPLAY_I2C_NATIVE 1
+#endif
+#ifndef DISPLAY_I2C_PORT
+#define DISPLAY_I2C_PORT 0
+#endif
+#ifndef DISPLAY_BUS_BENCHMARK
+#define DISPLAY_BUS_BENCHMARK 0
+#endif
+#ifndef DISPLAY_RENDER_BENCHMARK
+#define DISPLAY_RENDER_BENCHMARK 0
+#endif
+#ifndef GLYPH_CACHE_SLOTS
+#define GLYPH_CACHE_SLOTS 32
+#endif
+#ifndef GLYPH_CACHE_GLYPH_BYTES
+#define GLYPH_CACHE_GLYPH_BYTES 16 // Up to 16 columns of one page, or 8 of two
+#endif
+#ifndef DISPLAY_LAYOUT_SLOTS
+#define DISPLAY_LAYOUT_SLOTS 8
+#endif
+#ifndef DISPLAY_REQUEST_BLOCKS
+#define DISPLAY_REQUEST_BLOCKS 4 // Display requests in flight at once
+#endif
+
+// A display request carries up to 255 bytes, the most a text layout spans
+static const size_t DISPLAY_TEXT_SIZE = 256;
+
+typedef PanelGeometry<128, DISPLAY_HEIGHT> DisplayGeometry;
+#if DISPLAY_SH1106
+typedef Sh1106 DisplayController;
+#else
+typedef Ssd1306 DisplayController;
+#endif
+#if DISPLAY_HEADLESS
+typedef NullTransport DisplayTransport;
+#elif DISPLAY_I2C_NATIVE
+typedef IdfI2cTransport DisplayTransport;
+#else
+typedef WireTransport DisplayTransport;
+#endif
+typedef OledPanel<DisplayController, DisplayGeometry, DisplayTransport> DisplayPanel;
+
+bool display_begin(int sda_pin, int scl_pin);
+
+// Push the framebuffer to the panel
+void display_flush();
+
+// Clear and print up to three lines from the top-left corner
+void display_show_lines(const char *line1, const char *line2 = nullptr, const char *line3 = nullptr);
+
+// Clear and print msg centered on the panel, word-wrapped at the largest
+// text size that fits; layouts of recent messages are cached
+void display_show_centered(const char *msg);
+
+// Any task: copy text into a pooled block and publish a DisplayRequest,
+// so the drawing happens on the bus consumer. Text past
+// DISPLAY_TEXT_SIZE - 1 bytes is cut before a multi-byte character.
+// False, with the block back in the pool, if every block is in flight,
+// nothing subscribes to DisplayRequest yet, or the consumer's ring is
+// full.
+bool display_request(const char *text, DisplayStyle style = DisplayStyle::Centered);
+
+// The one subscriber to DisplayRequest calls this for each event; it
+// draws the text and returns the block to the pool
+void display_handle_request(const BusEvent &event);
+
+// display_begin() also registers the "glyph_cache" and "layout_cache"
+// sections of /diag
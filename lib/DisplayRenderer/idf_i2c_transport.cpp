@@ -0,0 +1,210 @@
+#include "idf_i2c_transport.h"
+#include <string.h>
+#include "esp_idf_version.h"
+#include "logger.h"
+
+#define IDF_I2C_MASTER_NG (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0))
+
+#if IDF_I2C_MASTER_NG
+#include <driver/i2c_master.h>
+#else
+#include <driver/i2c.h>
+#endif
+
+// A whole 128x64 frame takes ~23 ms at 400 kHz and ~93 ms at 100 kHz
+static const int TRANSFER_TIMEOUT_MS = 250;
+
+// Addressing commands as (0x80, cmd) pairs, then the 0x40 data control byte
+static const size_t HEADER_MAX = 2 * OLED_MAX_ADDRESS_COMMANDS + 1;
+
+static size_t build_header(uint8_t *header, const uint8_t *cmds, size_t cmd_len)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < cmd_len; i++)
+    {
+        header[n++] = 0x80;
+        header[n++] = cmds[i];
+    }
+    header[n++] = 0x40;
+    return n;
+}
+
+bool IdfI2cTransport::command(const uint8_t *bytes, size_t len)
+{
+    // Co=0: everything after the control byte is a command stream
+    static const uint8_t control = 0x00;
+    return transmit(&control, 1, bytes, len);
+}
+
+bool IdfI2cTransport::data(const uint8_t *bytes, size_t len)
+{
+    static const uint8_t control = 0x40;
+    return transmit(&control, 1, bytes, len);
+}
+
+bool IdfI2cTransport::write(const uint8_t *cmds, size_t cmd_len, const uint8_t *bytes, size_t len)
+{
+    if (cmd_len > OLED_MAX_ADDRESS_COMMANDS)
+    {
+        return command(cmds, cmd_len) && data(bytes, len);
+    }
+    uint8_t header[HEADER_MAX];
+    return transmit(header, build_header(header, cmds, cmd_len), bytes, len);
+}
+
+#if IDF_I2C_MASTER_NG
+
+// i2c_master_transmit takes one contiguous buffer, so the header and the
+// data are staged together. Copying a frame costs a few microseconds
+// against milliseconds on the wire.
+static uint8_t staging[HEADER_MAX + 128 * 64 / 8];
+
+bool IdfI2cTransport::begin()
+{
+    if (started_)
+    {
+        return true;
+    }
+    i2c_master_bus_config_t bus_config = {};
+    bus_config.i2c_port = port_;
+    bus_config.sda_io_num = (gpio_num_t)sda_pin_;
+    bus_config.scl_io_num = (gpio_num_t)scl_pin_;
+    bus_config.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_config.glitch_ignore_cnt = 7;
+    bus_config.flags.enable_internal_pullup = true;
+    i2c_master_bus_handle_t bus;
+    if (i2c_new_master_bus(&bus_config, &bus) != ESP_OK)
+    {
+        LOG_ERROR("I2C: bus %d unavailable", port_);
+        return false;
+    }
+    bus_ = bus;
+    started_ = true;
+    return set_clock(clock_hz_);
+}
+
+void IdfI2cTransport::end()
+{
+    if (device_)
+    {
+        i2c_master_bus_rm_device((i2c_master_dev_handle_t)device_);
+        device_ = nullptr;
+    }
+    if (bus_)
+    {
+        i2c_del_master_bus((i2c_master_bus_handle_t)bus_);
+        bus_ = nullptr;
+    }
+    started_ = false;
+}
+
+bool IdfI2cTransport::set_clock(uint32_t clock_hz)
+{
+    clock_hz_ = clock_hz;
+    if (!started_)
+    {
+        return true;
+    }
+    // The device carries the bus speed, so it is added again
+    if (device_)
+    {
+        i2c_master_bus_rm_device((i2c_master_dev_handle_t)device_);
+        device_ = nullptr;
+    }
+    i2c_device_config_t device_config = {};
+    device_config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    device_config.device_address = address_;
+    device_config.scl_speed_hz = clock_hz;
+    i2c_master_dev_handle_t device;
+    if (i2c_master_bus_add_device((i2c_master_bus_handle_t)bus_, &device_config, &device) != ESP_OK)
+    {
+        return false;
+    }
+    device_ = device;
+    return true;
+}
+
+bool IdfI2cTransport::transmit(const uint8_t *header, size_t header_len, const uint8_t *bytes, size_t len)
+{
+    if (!device_ || header_len + len > sizeof(staging))
+    {
+        errors_++;
+        return false;
+    }
+    memcpy(staging, header, header_len);
+    memcpy(staging + header_len, bytes, len);
+    transactions_++;
+    if (i2c_master_transmit((i2c_master_dev_handle_t)device_, staging, header_len + len, TRANSFER_TIMEOUT_MS) !=
+        ESP_OK)
+    {
+        errors_++;
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool IdfI2cTransport::begin()
+{
+    if (started_)
+    {
+        return true;
+    }
+    if (!set_clock(clock_hz_) || i2c_driver_install((i2c_port_t)port_, I2C_MODE_MASTER, 0, 0, 0) != ESP_OK)
+    {
+        LOG_ERROR("I2C: driver install on port %d failed", port_);
+        return false;
+    }
+    started_ = true;
+    return true;
+}
+
+void IdfI2cTransport::end()
+{
+    if (started_)
+    {
+        i2c_driver_delete((i2c_port_t)port_);
+        started_ = false;
+    }
+}
+
+bool IdfI2cTransport::set_clock(uint32_t clock_hz)
+{
+    clock_hz_ = clock_hz;
+    i2c_config_t config = {};
+    config.mode = I2C_MODE_MASTER;
+    config.sda_io_num = sda_pin_;
+    config.scl_io_num = scl_pin_;
+    config.sda_pullup_en = true;
+    config.scl_pullup_en = true;
+    config.master.clk_speed = clock_hz;
+    return i2c_param_config((i2c_port_t)port_, &config) == ESP_OK;
+}
+
+bool IdfI2cTransport::transmit(const uint8_t *header, size_t header_len, const uint8_t *bytes, size_t len)
+{
+    // Start, address, header, data, stop: the link only holds pointers,
+    // so nothing is copied and nothing comes from the heap
+    uint8_t link[I2C_LINK_RECOMMENDED_SIZE(3)];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link, sizeof(link));
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (uint8_t)(address_ << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write(cmd, header, header_len, true);
+    if (len)
+    {
+        i2c_master_write(cmd, bytes, len, true);
+    }
+    i2c_master_stop(cmd);
+    transactions_++;
+    esp_err_t err = i2c_master_cmd_begin((i2c_port_t)port_, cmd, pdMS_TO_TICKS(TRANSFER_TIMEOUT_MS));
+    i2c_cmd_link_delete_static(cmd);
+    if (err != ESP_OK)
+    {
+        errors_++;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "oled_panel.h"
+
+// ===========================================================
+// Native I2C Transport (ESP-IDF I2C master driver)
+// ===========================================================
+// Bypasses Wire and its TX buffer limit: write() sends the addressing
+// commands as Co=1 pairs followed by 0x40 and the pixel data in a single
+// transaction, so an SSD1306 frame is one transaction and an SH1106
+// frame one per page. Uses the i2c_master driver on IDF 5.2+, otherwise
+// the legacy driver with a static command link (no heap either way).
+// Owns the port while begun; end() releases it for Wire.
+
+class IdfI2cTransport
+{
+public:
+    IdfI2cTransport(int port, uint8_t address, uint32_t clock_hz = 400000)
+        : port_(port), address_(address), clock_hz_(clock_hz)
+    {
+    }
+
+    // Before begin()
+    void set_pins(int sda_pin, int scl_pin)
+    {
+        sda_pin_ = sda_pin;
+        scl_pin_ = scl_pin;
+    }
+
+    bool begin();
+    void end();
+    bool set_clock(uint32_t clock_hz);
+
+    bool command(const uint8_t *bytes, size_t len);
+    bool data(const uint8_t *bytes, size_t len);
+    bool write(const uint8_t *cmds, size_t cmd_len, const uint8_t *bytes, size_t len);
+
+    uint32_t transactions() const { return transactions_; }
+    uint32_t errors() const { return errors_; }
+
+private:
+    bool transmit(const uint8_t *header, size_t header_len, const uint8_t *bytes, size_t len);
+
+    int port_;
+    uint8_t address_;
+    uint32_t clock_hz_;
+    int sda_pin_ = -1;
+    int scl_pin_ = -1;
+    bool started_ = false;
+    void *bus_ = nullptr;    // i2c_master bus and device handles (IDF 5.2+)
+    void *device_ = nullptr;
+    uint32_t transactions_ = 0;
+    uint32_t errors_ = 0;
+};
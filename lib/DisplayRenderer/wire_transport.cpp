@@ -0,0 +1,45 @@
+#include "wire_transport.h"
+
+// One byte of every transaction goes to the control byte
+#if defined(I2C_BUFFER_LENGTH)
+static const size_t WIRE_MAX = (I2C_BUFFER_LENGTH < 256 ? I2C_BUFFER_LENGTH : 256) - 1;
+#elif defined(BUFFER_LENGTH)
+static const size_t WIRE_MAX = (BUFFER_LENGTH < 256 ? BUFFER_LENGTH : 256) - 1;
+#else
+static const size_t WIRE_MAX = 31;
+#endif
+
+bool WireTransport::begin()
+{
+    wire_->setClock(clock_hz_);
+    return true;
+}
+
+bool WireTransport::send(uint8_t control, const uint8_t *bytes, size_t len)
+{
+    while (len > 0)
+    {
+        size_t chunk = len < WIRE_MAX ? len : WIRE_MAX;
+        wire_->beginTransmission(address_);
+        wire_->write(control);
+        wire_->write(bytes, chunk);
+        transactions_++;
+        if (wire_->endTransmission() != 0)
+        {
+            return false;
+        }
+        bytes += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool WireTransport::command(const uint8_t *bytes, size_t len)
+{
+    return send(0x00, bytes, len);
+}
+
+bool WireTransport::data(const uint8_t *bytes, size_t len)
+{
+    return send(0x40, bytes, len);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// ===========================================================
+// Wire Transport (Arduino TwoWire)
+// ===========================================================
+// Sends panel bytes the way Adafruit_SSD1306 does: every transaction is
+// limited by the Wire TX buffer, so a frame is cut into many short
+// transactions, each paying its own start, address and stop.
+
+class WireTransport
+{
+public:
+    WireTransport(TwoWire &wire, uint8_t address, uint32_t clock_hz = 400000)
+        : wire_(&wire), address_(address), clock_hz_(clock_hz)
+    {
+    }
+
+    bool begin();
+    bool command(const uint8_t *bytes, size_t len);
+    bool data(const uint8_t *bytes, size_t len);
+    // Wire cannot mix commands and data in a transaction; sent separately
+    bool write(const uint8_t *cmds, size_t cmd_len, const uint8_t *bytes, size_t len)
+    {
+        return command(cmds, cmd_len) && data(bytes, len);
+    }
+
+    // Hand the bus back, e.g. to another transport
+    void end() { wire_->end(); }
+
+    uint32_t transactions() const { return transactions_; }
+
+private:
+    bool send(uint8_t control, const uint8_t *bytes, size_t len);
+
+    TwoWire *wire_;
+    uint8_t address_;
+    uint32_t clock_hz_;
+    uint32_t transactions_ = 0;
+};
@@ -0,0 +1,225 @@
+#include "envelope.h"
+#include <string.h>
+#include <mbedtls/base64.h>
+
+const char *envelope_error_message(EnvelopeError error)
+{
+    switch (error)
+    {
+    case EnvelopeError::None:
+        return "OK";
+    case EnvelopeError::Base64:
+        return "Base64 decode failed";
+    case EnvelopeError::TooShort:
+        return "Encrypted data too short";
+    case EnvelopeError::OutputTooSmall:
+        return "Decrypted output buffer too small";
+    case EnvelopeError::Cipher:
+        return "AES decryption failed";
+    case EnvelopeError::UnknownKey:
+        return "Unknown key id";
+    case EnvelopeError::TooLong:
+        return "Plaintext too long";
+    }
+    return "Unknown error";
+}
+
+EnvelopeError envelope_decode(const char *encrypted_b64, EnvelopeData &out)
+{
+    out.len = 0;
+    if (mbedtls_base64_decode(out.bytes, sizeof(out.bytes), &out.len, (const uint8_t *)encrypted_b64,
+                              strlen(encrypted_b64)) != 0)
+    {
+        out.len = 0;
+        return EnvelopeError::Base64;
+    }
+    return EnvelopeError::None;
+}
+
+// data is IV || ciphertext; aes already holds the decryption schedule
+static EnvelopeError decrypt_blocks(mbedtls_aes_context &aes, const uint8_t *data, size_t len, char *output,
+                                    size_t output_size)
+{
+    if (len < ENVELOPE_IV_SIZE)
+    {
+        return EnvelopeError::TooShort;
+    }
+    uint8_t iv[ENVELOPE_IV_SIZE];
+    memcpy(iv, data, ENVELOPE_IV_SIZE);
+    const uint8_t *ciphertext = data + ENVELOPE_IV_SIZE;
+    size_t ciphertext_len = len - ENVELOPE_IV_SIZE;
+    if (ciphertext_len >= output_size)
+    {
+        return EnvelopeError::OutputTooSmall;
+    }
+    if (mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_DECRYPT, ciphertext_len, iv, ciphertext, (uint8_t *)output) != 0)
+    {
+        output[0] = '\0';
+        return EnvelopeError::Cipher;
+    }
+    output[ciphertext_len] = '\0';
+    return EnvelopeError::None;
+}
+
+EnvelopeError envelope_nonce(const EnvelopeData &data, uint8_t iv_out[ENVELOPE_IV_SIZE])
+{
+    size_t offset = data.len % ENVELOPE_IV_SIZE == 1 ? 1 : 0; // Skip the key id
+    if (data.len < offset + ENVELOPE_IV_SIZE)
+    {
+        return EnvelopeError::TooShort;
+    }
+    memcpy(iv_out, data.bytes + offset, ENVELOPE_IV_SIZE);
+    return EnvelopeError::None;
+}
+
+EnvelopeError envelope_nonce(const char *encrypted_b64, uint8_t iv_out[ENVELOPE_IV_SIZE])
+{
+    EnvelopeData data;
+    EnvelopeError error = envelope_decode(encrypted_b64, data);
+    return error != EnvelopeError::None ? error : envelope_nonce(data, iv_out);
+}
+
+EnvelopeError envelope_decrypt(const uint8_t key[ENVELOPE_KEY_SIZE], const EnvelopeData &data, char *output,
+                               size_t output_size)
+{
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_dec(&aes, key, 128);
+    EnvelopeError error = decrypt_blocks(aes, data.bytes, data.len, output, output_size);
+    mbedtls_aes_free(&aes);
+    return error;
+}
+
+EnvelopeError envelope_decrypt(const uint8_t key[ENVELOPE_KEY_SIZE], const char *encrypted_b64, char *output,
+                               size_t output_size)
+{
+    EnvelopeData data;
+    EnvelopeError error = envelope_decode(encrypted_b64, data);
+    return error != EnvelopeError::None ? error : envelope_decrypt(key, data, output, output_size);
+}
+
+EnvelopeError envelope_encrypt(mbedtls_aes_context &enc, int key_id, const uint8_t iv[ENVELOPE_IV_SIZE],
+                               const char *plaintext, char *out_b64, size_t out_size)
+{
+    size_t plaintext_len = strlen(plaintext);
+    if (plaintext_len > ENVELOPE_MAX_PLAINTEXT)
+    {
+        return EnvelopeError::TooLong;
+    }
+    if (key_id >= (int)ENVELOPE_KEY_SLOTS)
+    {
+        return EnvelopeError::UnknownKey;
+    }
+    uint8_t envelope[ENVELOPE_MAX_DECODED];
+    size_t n = 0;
+    if (key_id != ENVELOPE_NO_KEY_ID)
+    {
+        envelope[n++] = (uint8_t)key_id;
+    }
+    memcpy(envelope + n, iv, ENVELOPE_IV_SIZE);
+    n += ENVELOPE_IV_SIZE;
+    // Zero padding: the decoder NUL-terminates after the last block, so
+    // trailing zeros just end the string early
+    uint8_t padded[ENVELOPE_MAX_PLAINTEXT] = {0};
+    memcpy(padded, plaintext, plaintext_len);
+    size_t padded_len = (plaintext_len + ENVELOPE_IV_SIZE - 1) / ENVELOPE_IV_SIZE * ENVELOPE_IV_SIZE;
+    if (padded_len == 0)
+    {
+        padded_len = ENVELOPE_IV_SIZE;
+    }
+    uint8_t chain[ENVELOPE_IV_SIZE];
+    memcpy(chain, iv, ENVELOPE_IV_SIZE);
+    if (mbedtls_aes_crypt_cbc(&enc, MBEDTLS_AES_ENCRYPT, padded_len, chain, padded, envelope + n) != 0)
+    {
+        return EnvelopeError::Cipher;
+    }
+    n += padded_len;
+    size_t written = 0;
+    if (mbedtls_base64_encode((uint8_t *)out_b64, out_size, &written, envelope, n) != 0)
+    {
+        return EnvelopeError::OutputTooSmall;
+    }
+    return EnvelopeError::None;
+}
+
+// ===========================================================
+// Key Ring
+// ===========================================================
+
+void envelope_keyring_init(EnvelopeKeyRing &ring)
+{
+    for (size_t i = 0; i < ENVELOPE_KEY_SLOTS; i++)
+    {
+        mbedtls_aes_init(&ring.schedules[i]);
+        ring.loaded[i] = false;
+    }
+}
+
+void envelope_keyring_free(EnvelopeKeyRing &ring)
+{
+    for (size_t i = 0; i < ENVELOPE_KEY_SLOTS; i++)
+    {
+        mbedtls_aes_free(&ring.schedules[i]);
+        ring.loaded[i] = false;
+    }
+}
+
+bool envelope_keyring_set(EnvelopeKeyRing &ring, uint8_t id, const uint8_t key[ENVELOPE_KEY_SIZE])
+{
+    if (id >= ENVELOPE_KEY_SLOTS)
+    {
+        return false;
+    }
+    // Free and re-init so no part of the previous schedule survives
+    mbedtls_aes_free(&ring.schedules[id]);
+    mbedtls_aes_init(&ring.schedules[id]);
+    ring.loaded[id] = mbedtls_aes_setkey_dec(&ring.schedules[id], key, 128) == 0;
+    return ring.loaded[id];
+}
+
+void envelope_keyring_remove(EnvelopeKeyRing &ring, uint8_t id)
+{
+    if (id < ENVELOPE_KEY_SLOTS)
+    {
+        mbedtls_aes_free(&ring.schedules[id]);
+        mbedtls_aes_init(&ring.schedules[id]);
+        ring.loaded[id] = false;
+    }
+}
+
+size_t envelope_keyring_count(const EnvelopeKeyRing &ring)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < ENVELOPE_KEY_SLOTS; i++)
+    {
+        count += ring.loaded[i] ? 1 : 0;
+    }
+    return count;
+}
+
+EnvelopeError envelope_decrypt_keyring(EnvelopeKeyRing &ring, const EnvelopeData &data, char *output,
+                                       size_t output_size)
+{
+    uint8_t id = 0;
+    const uint8_t *blocks = data.bytes;
+    size_t len = data.len;
+    if (len % ENVELOPE_IV_SIZE == 1)
+    {
+        id = blocks[0];
+        blocks++;
+        len--;
+    }
+    if (id >= ENVELOPE_KEY_SLOTS || !ring.loaded[id])
+    {
+        return EnvelopeError::UnknownKey;
+    }
+    return decrypt_blocks(ring.schedules[id], blocks, len, output, output_size);
+}
+
+EnvelopeError envelope_decrypt_keyring(EnvelopeKeyRing &ring, const char *encrypted_b64, char *output,
+                                       size_t output_size)
+{
+    EnvelopeData data;
+    EnvelopeError error = envelope_decode(encrypted_b64, data);
+    return error != EnvelopeError::None ? error : envelope_decrypt_keyring(ring, data, output, output_size);
+}
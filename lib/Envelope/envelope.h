@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mbedtls/aes.h>
+
+// ===========================================================
+// Credential Envelope (base64([key id] || IV || AES-128-CBC ciphertext))
+// ===========================================================
+// Pure decoding/decryption with no Arduino dependencies, so it builds
+// and can be measured on the host. Callers own logging and key policy.
+//
+// The key id byte is optional: ciphertext is whole AES blocks, so a
+// decoded length of 16n + 1 carries a key id and 16n is the original
+// format, which decrypts with slot 0.
+
+static const size_t ENVELOPE_KEY_SIZE = 16;
+static const size_t ENVELOPE_IV_SIZE = 16;
+static const size_t ENVELOPE_MAX_DECODED = 65; // Key id, IV and up to 48 bytes of ciphertext
+static const size_t ENVELOPE_MAX_PLAINTEXT = 48; // Zero-padded to whole blocks
+static const size_t ENVELOPE_KEY_SLOTS = 8;
+static const int ENVELOPE_NO_KEY_ID = -1;
+
+enum class EnvelopeError : uint8_t
+{
+    None = 0,
+    Base64,         // Not valid base64, or longer than ENVELOPE_MAX_DECODED
+    TooShort,       // Shorter than one IV
+    OutputTooSmall, // Plaintext plus terminator does not fit the output
+    Cipher,         // Ciphertext is not a whole number of AES blocks
+    UnknownKey,     // Key id is out of range or its slot is empty
+    TooLong         // Plaintext exceeds ENVELOPE_MAX_PLAINTEXT
+};
+
+// Fixed table of decryption schedules indexed directly by key id, so
+// the lookup is O(1) and the AES key expansion happens once at load
+// time rather than on every request
+struct EnvelopeKeyRing
+{
+    mbedtls_aes_context schedules[ENVELOPE_KEY_SLOTS];
+    bool loaded[ENVELOPE_KEY_SLOTS];
+};
+
+// Decoded envelope bytes, so a caller that checks the nonce before
+// decrypting pays for one base64 decode, not two
+struct EnvelopeData
+{
+    uint8_t bytes[ENVELOPE_MAX_DECODED];
+    size_t len;
+};
+
+const char *envelope_error_message(EnvelopeError error);
+
+EnvelopeError envelope_decode(const char *encrypted_b64, EnvelopeData &out);
+
+// Copy the envelope's IV without decrypting, for replay checks
+EnvelopeError envelope_nonce(const EnvelopeData &data, uint8_t iv_out[ENVELOPE_IV_SIZE]);
+EnvelopeError envelope_nonce(const char *encrypted_b64, uint8_t iv_out[ENVELOPE_IV_SIZE]);
+
+// Decrypt encrypted_b64 with key into output as a NUL-terminated string
+EnvelopeError envelope_decrypt(const uint8_t key[ENVELOPE_KEY_SIZE], const EnvelopeData &data, char *output,
+                               size_t output_size);
+EnvelopeError envelope_decrypt(const uint8_t key[ENVELOPE_KEY_SIZE], const char *encrypted_b64, char *output,
+                               size_t output_size);
+
+// Encrypt a NUL-terminated plaintext into base64([key_id] || IV || ct).
+// enc must already hold an encryption schedule; key_id is a slot number
+// or ENVELOPE_NO_KEY_ID for the original layout. Used by host tooling;
+// the output round-trips through envelope_decrypt_keyring.
+EnvelopeError envelope_encrypt(mbedtls_aes_context &enc, int key_id, const uint8_t iv[ENVELOPE_IV_SIZE],
+                               const char *plaintext, char *out_b64, size_t out_size);
+
+void envelope_keyring_init(EnvelopeKeyRing &ring);
+void envelope_keyring_free(EnvelopeKeyRing &ring);
+// Expand key into slot id, replacing whatever was there
+bool envelope_keyring_set(EnvelopeKeyRing &ring, uint8_t id, const uint8_t key[ENVELOPE_KEY_SIZE]);
+void envelope_keyring_remove(EnvelopeKeyRing &ring, uint8_t id);
+size_t envelope_keyring_count(const EnvelopeKeyRing &ring);
+
+// Decrypt with the slot named by the envelope's key id (slot 0 if absent)
+EnvelopeError envelope_decrypt_keyring(EnvelopeKeyRing &ring, const EnvelopeData &data, char *output,
+                                       size_t output_size);
+EnvelopeError envelope_decrypt_keyring(EnvelopeKeyRing &ring, const char *encrypted_b64, char *output,
+                                       size_t output_size);
@@ -0,0 +1,233 @@
+#include "event_bus.h"
+#include <atomic>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static_assert((EVENT_RING_SLOTS & (EVENT_RING_SLOTS - 1)) == 0, "EVENT_RING_SLOTS must be a power of two");
+
+struct EventSlot
+{
+    std::atomic<uint8_t> ready;
+    BusEvent event;
+};
+
+struct Subscriber
+{
+    const char *name;
+    uint32_t mask;
+    TaskHandle_t task;
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail; // Only the subscribing task moves it
+    std::atomic<uint32_t> dropped;
+    EventSlot slots[EVENT_RING_SLOTS];
+};
+
+struct TypeStats
+{
+    std::atomic<uint32_t> published;
+    std::atomic<uint32_t> dropped;
+    uint32_t received;
+    uint32_t latency_max_us;
+    uint64_t latency_total_us;
+};
+
+// Internal RAM: the ready flags and cursors are atomics
+static Subscriber subscribers[EVENT_MAX_SUBSCRIBERS];
+static std::atomic<uint8_t> subscriberCount(0);
+static TypeStats typeStats[(size_t)BusEventType::Count];
+static portMUX_TYPE statMux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE subscribeMux = portMUX_INITIALIZER_UNLOCKED;
+
+const char *event_type_name(BusEventType type)
+{
+    switch (type)
+    {
+    case BusEventType::CredentialsReceived:
+        return "credentials";
+    case BusEventType::Connected:
+        return "connected";
+    case BusEventType::Disconnected:
+        return "disconnected";
+    case BusEventType::ConnectFailed:
+        return "connect_failed";
+    case BusEventType::ButtonGesture:
+        return "button";
+    case BusEventType::DisplayRequest:
+        return "display";
+    default:
+        return "unknown";
+    }
+}
+
+EventSubscription event_bus_subscribe(const char *name, uint32_t type_mask)
+{
+    portENTER_CRITICAL(&subscribeMux);
+    uint8_t index = subscriberCount.load(std::memory_order_relaxed);
+    if (index >= EVENT_MAX_SUBSCRIBERS)
+    {
+        portEXIT_CRITICAL(&subscribeMux);
+        return -1;
+    }
+    Subscriber &s = subscribers[index];
+    s.name = name;
+    s.mask = type_mask;
+    s.task = xTaskGetCurrentTaskHandle();
+    s.head.store(0, std::memory_order_relaxed);
+    s.tail.store(0, std::memory_order_relaxed);
+    // Publishers only look at subscribers below the count
+    subscriberCount.store(index + 1, std::memory_order_release);
+    portEXIT_CRITICAL(&subscribeMux);
+    return (EventSubscription)index;
+}
+
+// Copy event into every matching ring; returns the tasks to wake as a bitmask
+static uint32_t deliver(const BusEvent &event, bool &all_delivered)
+{
+    uint32_t wake = 0;
+    all_delivered = true;
+    uint8_t count = subscriberCount.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Subscriber &s = subscribers[i];
+        if (!(s.mask & EVENT_MASK(event.type)))
+        {
+            continue;
+        }
+        uint32_t h = s.head.load(std::memory_order_relaxed);
+        bool reserved = true;
+        do
+        {
+            if (h - s.tail.load(std::memory_order_acquire) >= EVENT_RING_SLOTS)
+            {
+                reserved = false;
+                break;
+            }
+        } while (!s.head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+        if (!reserved)
+        {
+            s.dropped.fetch_add(1, std::memory_order_relaxed);
+            all_delivered = false;
+            continue;
+        }
+        EventSlot &slot = s.slots[h & (EVENT_RING_SLOTS - 1)];
+        slot.event = event;
+        slot.ready.store(1, std::memory_order_release);
+        wake |= 1u << i;
+    }
+    TypeStats &t = typeStats[(size_t)event.type];
+    t.published.fetch_add(1, std::memory_order_relaxed);
+    if (!all_delivered)
+    {
+        t.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return wake;
+}
+
+// Deliver and wake; returns how many subscribers took the event
+static uint8_t publish(BusEvent &event, bool &all_delivered)
+{
+    all_delivered = false;
+    if (event.type >= BusEventType::Count)
+    {
+        return 0;
+    }
+    event.stamp_us = (uint32_t)esp_timer_get_time();
+    uint32_t wake = deliver(event, all_delivered);
+    uint8_t delivered = 0;
+    for (uint8_t i = 0; wake; i++, wake >>= 1)
+    {
+        if (wake & 1)
+        {
+            xTaskNotifyGive(subscribers[i].task);
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+bool event_bus_publish(BusEvent &event)
+{
+    bool all_delivered;
+    publish(event, all_delivered);
+    return all_delivered;
+}
+
+uint8_t event_bus_publish_counted(BusEvent &event)
+{
+    bool all_delivered;
+    return publish(event, all_delivered);
+}
+
+bool event_bus_receive(EventSubscription sub, BusEvent &out, TickType_t wait_ticks)
+{
+    if (sub < 0 || (uint8_t)sub >= subscriberCount.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    Subscriber &s = subscribers[sub];
+    while (true)
+    {
+        uint32_t t = s.tail.load(std::memory_order_relaxed);
+        EventSlot &slot = s.slots[t & (EVENT_RING_SLOTS - 1)];
+        if (slot.ready.load(std::memory_order_acquire))
+        {
+            out = slot.event;
+            slot.ready.store(0, std::memory_order_relaxed);
+            s.tail.store(t + 1, std::memory_order_release);
+            uint32_t latency_us = (uint32_t)esp_timer_get_time() - out.stamp_us;
+            TypeStats &ts = typeStats[(size_t)out.type];
+            portENTER_CRITICAL(&statMux);
+            ts.received++;
+            ts.latency_total_us += latency_us;
+            if (latency_us > ts.latency_max_us)
+            {
+                ts.latency_max_us = latency_us;
+            }
+            portEXIT_CRITICAL(&statMux);
+            return true;
+        }
+        // Each publish gives one notification, so an empty ring here
+        // means waiting for the next one
+        if (ulTaskNotifyTake(pdTRUE, wait_ticks) == 0)
+        {
+            return false;
+        }
+    }
+}
+
+size_t event_bus_to_json(char *out, size_t size)
+{
+    size_t n = snprintf(out, size, "{\"types\":[");
+    for (size_t i = 0; i < (size_t)BusEventType::Count && n < size; i++)
+    {
+        TypeStats &t = typeStats[i];
+        portENTER_CRITICAL(&statMux);
+        uint32_t received = t.received;
+        uint32_t max_us = t.latency_max_us;
+        uint64_t total_us = t.latency_total_us;
+        portEXIT_CRITICAL(&statMux);
+        n += snprintf(out + n, size - n,
+                      "%s{\"name\":\"%s\",\"published\":%lu,\"dropped\":%lu,\"received\":%lu,\"avg_us\":%lu,"
+                      "\"max_us\":%lu}",
+                      i ? "," : "", event_type_name((BusEventType)i), (unsigned long)t.published.load(),
+                      (unsigned long)t.dropped.load(), (unsigned long)received,
+                      (unsigned long)(received ? total_us / received : 0), (unsigned long)max_us);
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "],\"subscribers\":[");
+    }
+    uint8_t count = subscriberCount.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count && n < size; i++)
+    {
+        Subscriber &s = subscribers[i];
+        n += snprintf(out + n, size - n, "%s{\"name\":\"%s\",\"pending\":%lu,\"dropped\":%lu}", i ? "," : "", s.name,
+                      (unsigned long)(s.head.load() - s.tail.load()), (unsigned long)s.dropped.load());
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "]}");
+    }
+    return n < size ? n : size - 1;
+}
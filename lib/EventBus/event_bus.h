@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+#include "gesture_detector.h"
+
+// ===========================================================
+// Event Bus (typed events, lock-free per-subscriber rings)
+// ===========================================================
+// Each subscriber owns a fixed ring. Publishing copies the event into
+// the ring of every subscriber whose mask matches (CAS reservation and
+// a ready flag, as in the logger) and wakes the subscribing task with a
+// notification. A full ring drops the event for that subscriber; a
+// publisher never waits, so it is safe from async_tcp, the timer task
+// and the Wi-Fi event task. Interrupts do not publish: the button ISR
+// only restarts its debounce timer.
+//
+// The subscribing task's notification value belongs to the bus. Events
+// stay small; a payload too large for a slot (display text) travels as
+// a pointer to a pooled block that the one subscriber releases.
+//
+// Dispatch latency (publish to receive) is recorded per event type.
+
+#define EVENT_RING_SLOTS 16 // Power of two
+#define EVENT_MAX_SUBSCRIBERS 4
+
+enum class BusEventType : uint8_t
+{
+    CredentialsReceived = 0,
+    Connected,
+    Disconnected,
+    ConnectFailed, // Credentials could not be parsed or the join timed out
+    ButtonGesture,
+    DisplayRequest,
+    Count
+};
+
+enum class CredentialSource : uint8_t
+{
+    Http,
+    Fleet
+};
+
+enum class DisplayStyle : uint8_t
+{
+    Centered, // Auto-fit, word-wrapped (display_show_centered)
+    Lines     // Up to three '\n'-separated lines from the top (display_show_lines)
+};
+
+struct BusEvent
+{
+    BusEventType type;
+    uint32_t stamp_us; // Set by the bus on publish
+    union
+    {
+        CredentialSource source;    // CredentialsReceived
+        uint32_t ipv4;              // Connected
+        uint8_t reason;             // Disconnected (wifi_err_reason_t)
+        ButtonGesture gesture;      // ButtonGesture
+        struct
+        {
+            char *text;             // Pooled block, see display_request()
+            DisplayStyle style;
+        } display;                  // DisplayRequest
+    };
+};
+
+#define EVENT_MASK(type) (1u << (uint32_t)(type))
+
+typedef int8_t EventSubscription; // -1 when subscribing failed
+
+// Call from the consuming task; it is the one that gets woken
+EventSubscription event_bus_subscribe(const char *name, uint32_t type_mask);
+
+// Task context. False if any matching subscriber's ring was full; true
+// when nobody subscribes to the type.
+bool event_bus_publish(BusEvent &event);
+
+// As above, but returns how many subscribers took the event. For events
+// that hand over ownership (a pooled block), where 0 means the publisher
+// still owns it.
+uint8_t event_bus_publish_counted(BusEvent &event);
+
+// Block up to wait_ticks for the next event on this subscription
+bool event_bus_receive(EventSubscription sub, BusEvent &out, TickType_t wait_ticks = portMAX_DELAY);
+
+const char *event_type_name(BusEventType type);
+
+// {"types":[{"name":..,"published":..,"dropped":..,"avg_us":..,"max_us":..}],"subscribers":[..]}
+size_t event_bus_to_json(char *out, size_t size);
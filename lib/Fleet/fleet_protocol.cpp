@@ -0,0 +1,282 @@
+#include "fleet_protocol.h"
+#include <string.h>
+
+static const uint8_t FLEET_MAGIC0 = 'F';
+static const uint8_t FLEET_MAGIC1 = 'P';
+static const uint8_t FLEET_VERSION = 1;
+
+FleetAddress fleet_address_mac(const uint8_t mac[FLEET_MAC_SIZE])
+{
+    FleetAddress a = {FleetAddressMode::Mac, {}};
+    memcpy(a.addr, mac, FLEET_MAC_SIZE);
+    return a;
+}
+
+FleetAddress fleet_address_group(uint8_t group)
+{
+    FleetAddress a = {FleetAddressMode::Group, {}};
+    a.addr[0] = group;
+    return a;
+}
+
+FleetAddress fleet_address_all()
+{
+    FleetAddress a = {FleetAddressMode::All, {}};
+    return a;
+}
+
+const char *fleet_ack_status_name(FleetAckStatus status)
+{
+    switch (status)
+    {
+    case FleetAckStatus::Accepted:
+        return "accepted";
+    case FleetAckStatus::DecryptFailed:
+        return "decrypt failed";
+    case FleetAckStatus::Busy:
+        return "busy";
+    }
+    return "unknown";
+}
+
+// ===========================================================
+// Frame Encoding
+// ===========================================================
+
+static size_t put_header(uint8_t *frame, FleetFrameType type, uint16_t seq, const FleetAddress &address)
+{
+    frame[0] = FLEET_MAGIC0;
+    frame[1] = FLEET_MAGIC1;
+    frame[2] = FLEET_VERSION;
+    frame[3] = (uint8_t)type;
+    frame[4] = (uint8_t)(seq & 0xff);
+    frame[5] = (uint8_t)(seq >> 8);
+    frame[6] = (uint8_t)address.mode;
+    memcpy(frame + 7, address.addr, FLEET_MAC_SIZE);
+    return FLEET_HEADER_SIZE;
+}
+
+// Header fields of a well-formed frame; false for anything else
+static bool get_header(const uint8_t *data, size_t len, FleetFrameType &type, uint16_t &seq, FleetAddress &address)
+{
+    if (len <= FLEET_HEADER_SIZE || len > FLEET_MAX_FRAME || data[0] != FLEET_MAGIC0 || data[1] != FLEET_MAGIC1 ||
+        data[2] != FLEET_VERSION || data[6] > (uint8_t)FleetAddressMode::All)
+    {
+        return false;
+    }
+    type = (FleetFrameType)data[3];
+    seq = (uint16_t)(data[4] | (data[5] << 8));
+    address.mode = (FleetAddressMode)data[6];
+    memcpy(address.addr, data + 7, FLEET_MAC_SIZE);
+    return true;
+}
+
+// ===========================================================
+// Receiver
+// ===========================================================
+
+void FleetReceiver::begin(const FleetReceiverConfig &config)
+{
+    config_ = config;
+    memset(recent_, 0, sizeof(recent_));
+    next_recent_ = 0;
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+bool FleetReceiver::addressed_to_me(const FleetAddress &address) const
+{
+    switch (address.mode)
+    {
+    case FleetAddressMode::Mac:
+        return memcmp(address.addr, config_.mac, FLEET_MAC_SIZE) == 0;
+    case FleetAddressMode::Group:
+        return address.addr[0] == config_.group;
+    case FleetAddressMode::All:
+        return true;
+    }
+    return false;
+}
+
+void FleetReceiver::ack(const uint8_t src[FLEET_MAC_SIZE], uint16_t seq, FleetAckStatus status)
+{
+    uint8_t frame[FLEET_HEADER_SIZE + 1];
+    put_header(frame, FleetFrameType::Ack, seq, fleet_address_mac(src));
+    frame[FLEET_HEADER_SIZE] = (uint8_t)status;
+    config_.send(config_.ctx, src, frame, sizeof(frame));
+}
+
+void FleetReceiver::on_frame(const uint8_t src[FLEET_MAC_SIZE], const uint8_t *data, size_t len)
+{
+    stats_.frames++;
+    FleetFrameType type;
+    uint16_t seq;
+    FleetAddress address;
+    if (!get_header(data, len, type, seq, address) || type != FleetFrameType::Credentials ||
+        !addressed_to_me(address))
+    {
+        stats_.ignored++;
+        return;
+    }
+    size_t envelope_len = data[FLEET_HEADER_SIZE];
+    if (envelope_len == 0 || FLEET_HEADER_SIZE + 1 + envelope_len > len)
+    {
+        stats_.ignored++;
+        return;
+    }
+
+    // A retransmission: repeat the earlier answer without decrypting
+    for (size_t i = 0; i < FLEET_RECENT; i++)
+    {
+        const Recent &r = recent_[i];
+        if (r.used && r.seq == seq && memcmp(r.src, src, FLEET_MAC_SIZE) == 0)
+        {
+            stats_.duplicates++;
+            ack(src, seq, r.status);
+            return;
+        }
+    }
+
+    char envelope[FLEET_MAX_ENVELOPE + 1];
+    memcpy(envelope, data + FLEET_HEADER_SIZE + 1, envelope_len);
+    envelope[envelope_len] = '\0';
+    char credentials[128];
+    FleetAckStatus status;
+    if (!config_.decrypt(config_.ctx, envelope, credentials, sizeof(credentials)))
+    {
+        status = FleetAckStatus::DecryptFailed;
+    }
+    else
+    {
+        status = config_.deliver(config_.ctx, credentials) ? FleetAckStatus::Accepted : FleetAckStatus::Busy;
+    }
+    memset(credentials, 0, sizeof(credentials));
+    if (status == FleetAckStatus::Accepted)
+    {
+        stats_.accepted++;
+    }
+    else
+    {
+        stats_.rejected++;
+    }
+    // Busy is not remembered, so a retry can still get through
+    if (status != FleetAckStatus::Busy)
+    {
+        Recent &r = recent_[next_recent_];
+        r.used = true;
+        memcpy(r.src, src, FLEET_MAC_SIZE);
+        r.seq = seq;
+        r.status = status;
+        next_recent_ = (next_recent_ + 1) % FLEET_RECENT;
+    }
+    ack(src, seq, status);
+}
+
+// ===========================================================
+// Sender
+// ===========================================================
+
+void FleetSender::begin(FleetSend send, void *ctx)
+{
+    send_ = send;
+    ctx_ = ctx;
+    active_ = false;
+}
+
+bool FleetSender::start(const char *envelope_b64, const FleetCampaign &campaign, uint32_t now_ms)
+{
+    size_t envelope_len = strlen(envelope_b64);
+    if (envelope_len == 0 || envelope_len > FLEET_MAX_ENVELOPE)
+    {
+        return false;
+    }
+    campaign_ = campaign;
+    frame_len_ = put_header(frame_, FleetFrameType::Credentials, campaign.seq, campaign.target);
+    frame_[frame_len_++] = (uint8_t)envelope_len;
+    memcpy(frame_ + frame_len_, envelope_b64, envelope_len);
+    frame_len_ += envelope_len;
+    sent_ = 0;
+    next_send_ms_ = now_ms;
+    peer_count_ = 0;
+    memset(&stats_, 0, sizeof(stats_));
+    stats_.started_ms = now_ms;
+    active_ = true;
+    return true;
+}
+
+void FleetSender::finish(uint32_t now_ms)
+{
+    active_ = false;
+    stats_.finished_ms = now_ms;
+}
+
+void FleetSender::cancel()
+{
+    active_ = false;
+}
+
+uint32_t FleetSender::poll(uint32_t now_ms)
+{
+    if (!active_)
+    {
+        return 0;
+    }
+    if ((int32_t)(now_ms - next_send_ms_) < 0)
+    {
+        return next_send_ms_ - now_ms;
+    }
+    if (sent_ > campaign_.retries)
+    {
+        finish(now_ms);
+        return 0;
+    }
+    // MAC campaigns go straight to the peer; the rest are broadcast
+    const uint8_t *dst = campaign_.target.mode == FleetAddressMode::Mac ? campaign_.target.addr : FLEET_BROADCAST_MAC;
+    send_(ctx_, dst, frame_, frame_len_);
+    sent_++;
+    stats_.transmissions++;
+    next_send_ms_ = now_ms + campaign_.interval_ms;
+    return campaign_.interval_ms ? campaign_.interval_ms : 1;
+}
+
+void FleetSender::on_frame(const uint8_t src[FLEET_MAC_SIZE], const uint8_t *data, size_t len, uint32_t now_ms)
+{
+    FleetFrameType type;
+    uint16_t seq;
+    FleetAddress address;
+    if (!active_ || !get_header(data, len, type, seq, address) || type != FleetFrameType::Ack ||
+        seq != campaign_.seq)
+    {
+        return;
+    }
+    for (size_t i = 0; i < peer_count_; i++)
+    {
+        if (memcmp(peers_[i], src, FLEET_MAC_SIZE) == 0)
+        {
+            return; // Already counted
+        }
+    }
+    FleetAckStatus status = (FleetAckStatus)data[FLEET_HEADER_SIZE];
+    if (status == FleetAckStatus::Busy)
+    {
+        return; // Not final; the next retransmission asks again
+    }
+    if (peer_count_ == FLEET_MAX_PEERS)
+    {
+        stats_.untracked++; // Cannot tell a new peer from a repeat any more
+        return;
+    }
+    memcpy(peers_[peer_count_++], src, FLEET_MAC_SIZE);
+    if (status == FleetAckStatus::Accepted)
+    {
+        stats_.accepted++;
+    }
+    else
+    {
+        stats_.failed++;
+    }
+    bool enough = campaign_.expected && stats_.accepted + stats_.failed >= campaign_.expected;
+    if (enough || (campaign_.target.mode == FleetAddressMode::Mac))
+    {
+        finish(now_ms);
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Fleet Provisioning Protocol (ESP-NOW frames, radio-agnostic)
+// ===========================================================
+// A sender broadcasts a credential envelope (the same base64 string
+// /set_wifi takes in "data") addressed to one MAC, one group, or every
+// listener. Each receiver that the address matches decrypts it through
+// the normal key ring, hands the credentials to the connect path and
+// unicasts an ack. The sender repeats the frame every interval_ms until
+// the expected number of peers has acked or the retries run out.
+//
+// Retransmissions keep the campaign's seq. Receivers remember recent
+// (sender, seq) pairs and re-ack from that table without decrypting
+// again, which also keeps retries clear of the replay guard.
+//
+// Frame, little endian, at most FLEET_MAX_FRAME (ESP-NOW's limit):
+//   'F' 'P' version type seq:u16 addr_mode addr[6] | body
+//   Credentials body: len:u8 envelope[len]
+//   Ack body:         status:u8
+//
+// No Arduino or ESP-IDF dependencies; tools/fleet_sim drives it over a
+// simulated broadcast medium on the host.
+
+static const size_t FLEET_MAC_SIZE = 6;
+static const size_t FLEET_MAX_FRAME = 250;
+static const size_t FLEET_HEADER_SIZE = 13;
+static const size_t FLEET_MAX_ENVELOPE = FLEET_MAX_FRAME - FLEET_HEADER_SIZE - 1;
+static const size_t FLEET_RECENT = 4;     // (sender, seq) pairs a receiver re-acks from
+static const size_t FLEET_MAX_PEERS = 256; // Distinct acks a sender tracks per campaign
+static const uint8_t FLEET_BROADCAST_MAC[FLEET_MAC_SIZE] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+enum class FleetFrameType : uint8_t
+{
+    Credentials = 1,
+    Ack = 2
+};
+
+enum class FleetAddressMode : uint8_t
+{
+    Mac = 0,   // addr is the receiver's MAC
+    Group = 1, // addr[0] is a group id
+    All = 2    // Every listener
+};
+
+enum class FleetAckStatus : uint8_t
+{
+    Accepted = 0,
+    DecryptFailed = 1,
+    Busy = 2 // Connect path still handling an earlier campaign
+};
+
+struct FleetAddress
+{
+    FleetAddressMode mode;
+    uint8_t addr[FLEET_MAC_SIZE];
+};
+
+FleetAddress fleet_address_mac(const uint8_t mac[FLEET_MAC_SIZE]);
+FleetAddress fleet_address_group(uint8_t group);
+FleetAddress fleet_address_all();
+
+const char *fleet_ack_status_name(FleetAckStatus status);
+
+// Transport hook: unicast, or broadcast when dst is FLEET_BROADCAST_MAC
+typedef bool (*FleetSend)(void *ctx, const uint8_t dst[FLEET_MAC_SIZE], const uint8_t *frame, size_t len);
+
+// ===========================================================
+// Receiver
+// ===========================================================
+
+struct FleetReceiverConfig
+{
+    uint8_t mac[FLEET_MAC_SIZE];
+    uint8_t group;
+    FleetSend send;
+    // Same contract as the /set_wifi decrypt: envelope in, "ssid|password" out
+    bool (*decrypt)(void *ctx, const char *envelope_b64, char *output, size_t output_size);
+    // Hand decrypted credentials on; false if the connect path is busy
+    bool (*deliver)(void *ctx, const char *credentials);
+    void *ctx;
+};
+
+struct FleetReceiverStats
+{
+    uint32_t frames;
+    uint32_t ignored; // Malformed, or addressed elsewhere
+    uint32_t duplicates;
+    uint32_t accepted;
+    uint32_t rejected;
+};
+
+class FleetReceiver
+{
+public:
+    void begin(const FleetReceiverConfig &config);
+    void on_frame(const uint8_t src[FLEET_MAC_SIZE], const uint8_t *data, size_t len);
+    const FleetReceiverStats &stats() const { return stats_; }
+
+private:
+    struct Recent
+    {
+        bool used;
+        uint8_t src[FLEET_MAC_SIZE];
+        uint16_t seq;
+        FleetAckStatus status;
+    };
+
+    bool addressed_to_me(const FleetAddress &address) const;
+    void ack(const uint8_t src[FLEET_MAC_SIZE], uint16_t seq, FleetAckStatus status);
+
+    FleetReceiverConfig config_ = {};
+    Recent recent_[FLEET_RECENT] = {};
+    size_t next_recent_ = 0;
+    FleetReceiverStats stats_ = {};
+};
+
+// ===========================================================
+// Sender
+// ===========================================================
+
+struct FleetCampaign
+{
+    FleetAddress target;
+    uint16_t seq;
+    uint16_t expected;    // Stop once this many peers acked (at most FLEET_MAX_PEERS); 0 runs all retries
+    uint8_t retries;      // Transmissions after the first
+    uint32_t interval_ms; // Gap between transmissions
+};
+
+struct FleetSenderStats
+{
+    uint32_t transmissions;
+    uint32_t accepted; // Distinct peers that accepted
+    uint32_t failed;   // Distinct peers that acked with an error
+    uint32_t untracked; // Acks that arrived after the peer table filled
+    uint32_t started_ms;
+    uint32_t finished_ms;
+};
+
+class FleetSender
+{
+public:
+    void begin(FleetSend send, void *ctx);
+    // Start fanning envelope_b64 out; false if it does not fit a frame
+    bool start(const char *envelope_b64, const FleetCampaign &campaign, uint32_t now_ms);
+    // Transmit if due; returns ms until the next transmission, or 0 when done
+    uint32_t poll(uint32_t now_ms);
+    void on_frame(const uint8_t src[FLEET_MAC_SIZE], const uint8_t *data, size_t len, uint32_t now_ms);
+    void cancel();
+    bool active() const { return active_; }
+    const FleetSenderStats &stats() const { return stats_; }
+
+private:
+    void finish(uint32_t now_ms);
+
+    FleetSend send_ = nullptr;
+    void *ctx_ = nullptr;
+    bool active_ = false;
+    FleetCampaign campaign_ = {};
+    uint8_t frame_[FLEET_MAX_FRAME] = {};
+    size_t frame_len_ = 0;
+    uint8_t sent_ = 0;
+    uint32_t next_send_ms_ = 0;
+    uint8_t peers_[FLEET_MAX_PEERS][FLEET_MAC_SIZE] = {};
+    size_t peer_count_ = 0;
+    FleetSenderStats stats_ = {};
+};
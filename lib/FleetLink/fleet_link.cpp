@@ -0,0 +1,236 @@
+#include "fleet_link.h"
+#include <Arduino.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_system.h>
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_random.h>
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "wifi_controller.h"
+#include "event_bus.h"
+#include "static_alloc.h"
+#include "logger.h"
+
+enum class FleetEventKind : uint8_t
+{
+    Frame, // Received from the radio
+    Start  // Campaign queued by fleet_link_send
+};
+
+struct FleetEvent
+{
+    FleetEventKind kind;
+    uint8_t src[FLEET_MAC_SIZE];
+    uint8_t len;
+    uint8_t data[FLEET_MAX_FRAME]; // Frame bytes, or the NUL-terminated envelope for Start
+    FleetCampaign campaign;
+};
+
+static const size_t FLEET_QUEUE_DEPTH = 4;
+static const uint32_t FLEET_TASK_STACK = 4096;
+
+static QueueHandle_t fleetQueue = NULL;
+static FleetReceiver receiver;
+static FleetSender sender;
+static CredentialDecrypt decryptFn = nullptr;
+static uint8_t fleetGroup = 0;
+static volatile uint32_t rxDropped = 0; // Frames lost to a full queue
+static FleetEvent rxScratch;            // Only the Wi-Fi task writes it
+
+static wifi_interface_t current_interface()
+{
+    wifi_mode_t mode = WIFI_MODE_NULL;
+    esp_wifi_get_mode(&mode);
+    return mode == WIFI_MODE_AP ? WIFI_IF_AP : WIFI_IF_STA;
+}
+
+// Peers follow the active interface, which changes once a unit joins
+static bool ensure_peer(const uint8_t mac[FLEET_MAC_SIZE])
+{
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, mac, FLEET_MAC_SIZE);
+    peer.channel = 0; // Current channel
+    peer.ifidx = current_interface();
+    peer.encrypt = false; // The envelope is already encrypted
+    if (esp_now_is_peer_exist(mac))
+    {
+        return esp_now_mod_peer(&peer) == ESP_OK;
+    }
+    return esp_now_add_peer(&peer) == ESP_OK;
+}
+
+static bool link_send(void *, const uint8_t dst[FLEET_MAC_SIZE], const uint8_t *frame, size_t len)
+{
+    return ensure_peer(dst) && esp_now_send(dst, frame, len) == ESP_OK;
+}
+
+static bool link_decrypt(void *, const char *envelope_b64, char *output, size_t output_size)
+{
+    return decryptFn && decryptFn(envelope_b64, nullptr, output, output_size);
+}
+
+static bool link_deliver(void *, const char *credentials)
+{
+    if (!wifi_dispatch_credentials(credentials))
+    {
+        return false;
+    }
+    LOG_INFO("Fleet credentials accepted");
+    BusEvent event;
+    event.type = BusEventType::CredentialsReceived;
+    event.source = CredentialSource::Fleet;
+    event_bus_publish(event);
+    return true;
+}
+
+static void enqueue_frame(const uint8_t *src, const uint8_t *data, int len)
+{
+    if (len <= 0 || len > (int)FLEET_MAX_FRAME)
+    {
+        return;
+    }
+    rxScratch.kind = FleetEventKind::Frame;
+    memcpy(rxScratch.src, src, FLEET_MAC_SIZE);
+    rxScratch.len = (uint8_t)len;
+    memcpy(rxScratch.data, data, len);
+    // Runs on the Wi-Fi task: never block it
+    if (xQueueSend(fleetQueue, &rxScratch, 0) != pdTRUE)
+    {
+        rxDropped++;
+    }
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static void on_recv(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    enqueue_frame(info->src_addr, data, len);
+}
+#else
+static void on_recv(const uint8_t *mac, const uint8_t *data, int len)
+{
+    enqueue_frame(mac, data, len);
+}
+#endif
+
+static void fleet_task(void *)
+{
+    FleetEvent ev;
+    uint32_t wait_ms = 0;
+    while (true)
+    {
+        // +1 tick so a sub-tick wait does not spin
+        TickType_t timeout = sender.active() ? pdMS_TO_TICKS(wait_ms) + 1 : portMAX_DELAY;
+        if (xQueueReceive(fleetQueue, &ev, timeout) == pdTRUE)
+        {
+            if (ev.kind == FleetEventKind::Frame)
+            {
+                receiver.on_frame(ev.src, ev.data, ev.len);
+                sender.on_frame(ev.src, ev.data, ev.len, millis());
+            }
+            else
+            {
+                if (sender.active())
+                {
+                    LOG_WARN("Fleet campaign replaced by a new one");
+                }
+                sender.start((const char *)ev.data, ev.campaign, millis());
+                LOG_INFO("Fleet campaign %04x started", ev.campaign.seq);
+            }
+        }
+        bool was_active = sender.active();
+        wait_ms = sender.poll(millis());
+        if (was_active && !sender.active())
+        {
+            const FleetSenderStats &s = sender.stats();
+            LOG_INFO("Fleet campaign done: %lu accepted, %lu failed, %lu transmissions in %lu ms",
+                     (unsigned long)s.accepted, (unsigned long)s.failed, (unsigned long)s.transmissions,
+                     (unsigned long)(s.finished_ms - s.started_ms));
+        }
+    }
+}
+
+bool fleet_link_begin(uint8_t group, CredentialDecrypt decrypt)
+{
+    if (esp_now_init() != ESP_OK)
+    {
+        LOG_ERROR("ESP-NOW init failed");
+        return false;
+    }
+    decryptFn = decrypt;
+    fleetGroup = group;
+    FleetReceiverConfig config = {};
+    esp_wifi_get_mac(WIFI_IF_STA, config.mac);
+    config.group = group;
+    config.send = link_send;
+    config.decrypt = link_decrypt;
+    config.deliver = link_deliver;
+    receiver.begin(config);
+    sender.begin(link_send, nullptr);
+
+#if STATIC_ALLOCATION
+    static StaticQueue_t queueStorage;
+    static uint8_t queueBuffer[FLEET_QUEUE_DEPTH * sizeof(FleetEvent)];
+    static StaticTask_t taskTcb;
+    static StackType_t taskStack[FLEET_TASK_STACK];
+    fleetQueue = xQueueCreateStatic(FLEET_QUEUE_DEPTH, sizeof(FleetEvent), queueBuffer, &queueStorage);
+    TaskHandle_t task =
+        xTaskCreateStatic(fleet_task, "fleetLink", FLEET_TASK_STACK, NULL, 1, taskStack, &taskTcb);
+#else
+    fleetQueue = xQueueCreate(FLEET_QUEUE_DEPTH, sizeof(FleetEvent));
+    TaskHandle_t task = NULL;
+    if (fleetQueue)
+    {
+        xTaskCreate(fleet_task, "fleetLink", FLEET_TASK_STACK, NULL, 1, &task);
+    }
+#endif
+    if (!fleetQueue || !task)
+    {
+        LOG_ERROR("Fleet link task creation failed");
+        esp_now_deinit();
+        return false;
+    }
+    esp_now_register_recv_cb(on_recv);
+    LOG_INFO("Fleet link up: group %u, MAC %02x:%02x:%02x:%02x:%02x:%02x", group, config.mac[0], config.mac[1],
+             config.mac[2], config.mac[3], config.mac[4], config.mac[5]);
+    return true;
+}
+
+bool fleet_link_send(const char *envelope_b64, const FleetAddress &target, uint16_t expected, uint8_t retries,
+                     uint32_t interval_ms)
+{
+    size_t len = strlen(envelope_b64);
+    if (!fleetQueue || len == 0 || len > FLEET_MAX_ENVELOPE)
+    {
+        return false;
+    }
+    FleetEvent ev = {};
+    ev.kind = FleetEventKind::Start;
+    memcpy(ev.data, envelope_b64, len);
+    ev.campaign.target = target;
+    ev.campaign.seq = (uint16_t)esp_random();
+    ev.campaign.expected = expected;
+    ev.campaign.retries = retries;
+    ev.campaign.interval_ms = interval_ms;
+    return xQueueSend(fleetQueue, &ev, 0) == pdTRUE;
+}
+
+size_t fleet_link_to_json(char *out, size_t size)
+{
+    // Counters are single words updated by the fleet task; a snapshot may
+    // be a frame out of date but is never torn
+    const FleetReceiverStats &r = receiver.stats();
+    const FleetSenderStats &s = sender.stats();
+    int n = snprintf(out, size,
+                     "{\"group\":%u,\"rx_dropped\":%lu,\"receiver\":{\"frames\":%lu,\"ignored\":%lu,\"duplicates\":%lu,"
+                     "\"accepted\":%lu,\"rejected\":%lu},\"sender\":{\"active\":%s,\"transmissions\":%lu,"
+                     "\"accepted\":%lu,\"failed\":%lu,\"untracked\":%lu}}",
+                     fleetGroup, (unsigned long)rxDropped, (unsigned long)r.frames, (unsigned long)r.ignored,
+                     (unsigned long)r.duplicates, (unsigned long)r.accepted, (unsigned long)r.rejected,
+                     sender.active() ? "true" : "false", (unsigned long)s.transmissions, (unsigned long)s.accepted,
+                     (unsigned long)s.failed, (unsigned long)s.untracked);
+    return n < 0 ? 0 : ((size_t)n < size ? (size_t)n : size - 1);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fleet_protocol.h"
+#include "wifi_setup.h"
+
+// ===========================================================
+// Fleet Link (ESP-NOW transport for lib/Fleet)
+// ===========================================================
+// Every unit listens for credential frames addressed to its station
+// MAC, its group or everyone, and hands accepted credentials to the
+// same connect path /set_wifi uses. A provisioned unit can also act as
+// the sender and fan an envelope out to its peers (POST /fleet/send).
+//
+// ESP-NOW only reaches peers on the same channel. Unprovisioned units
+// listen on their softAP channel (1 unless configured otherwise), so a
+// fan-out sender must be on that channel as well.
+
+// Start ESP-NOW and the fleet task; decrypt is the /set_wifi decrypt
+bool fleet_link_begin(uint8_t group, CredentialDecrypt decrypt);
+
+// Queue a fan-out campaign for envelope_b64; false if ESP-NOW is not
+// running, the envelope does not fit a frame or the queue is full
+bool fleet_link_send(const char *envelope_b64, const FleetAddress &target, uint16_t expected, uint8_t retries,
+                     uint32_t interval_ms);
+
+// {"group":..,"receiver":{..},"sender":{..}} into out
+size_t fleet_link_to_json(char *out, size_t size);
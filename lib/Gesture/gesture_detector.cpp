@@ -0,0 +1,96 @@
+#include "gesture_detector.h"
+
+GestureDetector::GestureDetector(const GestureTiming &timing)
+    : timing_(timing), state_(State::Idle), mark_ms_(0)
+{
+}
+
+void GestureDetector::reset()
+{
+    state_ = State::Idle;
+    mark_ms_ = 0;
+}
+
+ButtonGesture GestureDetector::on_edge(bool pressed, uint32_t now_ms)
+{
+    switch (state_)
+    {
+    case State::Idle:
+        if (pressed)
+        {
+            state_ = State::Pressed;
+            mark_ms_ = now_ms;
+        }
+        break;
+    case State::Pressed:
+        if (!pressed)
+        {
+            if (now_ms - mark_ms_ >= timing_.long_ms)
+            {
+                state_ = State::Idle;
+                return ButtonGesture::LongPress;
+            }
+            state_ = State::WaitSecond;
+            mark_ms_ = now_ms;
+        }
+        break;
+    case State::WaitSecond:
+        if (pressed)
+        {
+            state_ = State::SecondPressed;
+            mark_ms_ = now_ms;
+        }
+        break;
+    case State::SecondPressed:
+        if (!pressed)
+        {
+            state_ = State::Idle;
+            return ButtonGesture::DoublePress;
+        }
+        break;
+    case State::HeldVeryLong:
+        if (!pressed)
+        {
+            state_ = State::Idle;
+        }
+        break;
+    }
+    return ButtonGesture::None;
+}
+
+ButtonGesture GestureDetector::on_timeout(uint32_t now_ms)
+{
+    uint32_t deadline;
+    // Signed difference keeps this correct across millis() wrap-around
+    if (!next_deadline(deadline) || (int32_t)(now_ms - deadline) < 0)
+    {
+        return ButtonGesture::None;
+    }
+    if (state_ == State::Pressed || state_ == State::SecondPressed)
+    {
+        state_ = State::HeldVeryLong;
+        return ButtonGesture::VeryLongPress;
+    }
+    if (state_ == State::WaitSecond)
+    {
+        state_ = State::Idle;
+        return ButtonGesture::ShortPress;
+    }
+    return ButtonGesture::None;
+}
+
+bool GestureDetector::next_deadline(uint32_t &deadline_ms) const
+{
+    switch (state_)
+    {
+    case State::Pressed:
+    case State::SecondPressed:
+        deadline_ms = mark_ms_ + timing_.very_long_ms;
+        return true;
+    case State::WaitSecond:
+        deadline_ms = mark_ms_ + timing_.double_gap_ms;
+        return true;
+    default:
+        return false;
+    }
+}
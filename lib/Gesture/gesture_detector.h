@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===========================================================
+// Boot Button Gesture Detector
+// ===========================================================
+// Pure state machine: fed with debounced press/release edges and
+// deadline expiries, it reports short, double, long and very-long
+// presses. It has no Arduino dependencies so it can run on the host
+// (test/test_gesture drives it with simulated edge timings).
+
+enum class ButtonGesture : uint8_t
+{
+    None = 0,
+    ShortPress,
+    DoublePress,
+    LongPress,
+    VeryLongPress,
+    Count
+};
+
+struct GestureTiming
+{
+    uint32_t debounce_ms = 30;      // Level must be stable this long to count
+    uint32_t double_gap_ms = 300;   // Max release-to-press gap for a double press
+    uint32_t long_ms = 1500;        // Held at least this long -> long press (on release)
+    uint32_t very_long_ms = 5000;   // Held this long -> very-long press (fires while held)
+};
+
+class GestureDetector
+{
+public:
+    explicit GestureDetector(const GestureTiming &timing = GestureTiming());
+
+    // Debounced level change. Returns the gesture it completes, if any.
+    ButtonGesture on_edge(bool pressed, uint32_t now_ms);
+
+    // Called when the deadline from next_deadline() has passed.
+    ButtonGesture on_timeout(uint32_t now_ms);
+
+    // True if a timeout is pending; deadline_ms receives its absolute time.
+    bool next_deadline(uint32_t &deadline_ms) const;
+
+    const GestureTiming &timing() const { return timing_; }
+    void reset();
+
+private:
+    enum class State : uint8_t
+    {
+        Idle,
+        Pressed,       // First press held
+        WaitSecond,    // Released after a short press, waiting for a second one
+        SecondPressed, // Second press of a double press held; held on, it
+                       // becomes a very-long press like the first
+        HeldVeryLong   // Very-long press already reported, waiting for release
+    };
+
+    GestureTiming timing_;
+    State state_;
+    uint32_t mark_ms_; // Press start or release time, depending on state
+};
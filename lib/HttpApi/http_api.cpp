@@ -0,0 +1,679 @@
+#include "http_api.h"
+#include <ArduinoJson.h>
+#include "wifi_setup.h"
+#include "session.h"
+#include <mbedtls/base64.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_random.h>
+#endif
+#include "request_capture.h"
+#include "display_renderer.h"
+#include "wifi_controller.h"
+#include "power_manager.h"
+#include "diagnostics.h"
+#include "static_alloc.h"
+#include "mem_placement.h"
+#include "boot_profiler.h"
+#include "logger.h"
+#include "ota_update.h"
+#include "credential_store.h"
+#include "replay_guard.h"
+#include "fleet_link.h"
+#include "event_bus.h"
+#include "lifecycle.h"
+#include "request_pool.h"
+#include "utf8.h"
+#include "credentials.h"
+#include <new>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Slot 0 holds the built-in key so envelopes without a key id still work
+static EnvelopeKeyRing keyRing;
+// Evicting a nonce younger than this is counted as early in /diag: more
+// than 32 envelopes in that time means a flood (see replay_guard.h)
+static const uint32_t REPLAY_HOLD_MS = 5 * 60 * 1000;
+
+// Envelopes are opened on async_tcp (/set_wifi, /keys) and on the fleet
+// task; one holder at a time covers the key ring, the session cache and
+// the replay check together
+static SemaphoreHandle_t cryptoMutex = NULL;
+
+class CryptoLock
+{
+public:
+    CryptoLock() { xSemaphoreTake(cryptoMutex, portMAX_DELAY); }
+    ~CryptoLock() { xSemaphoreGive(cryptoMutex); }
+    CryptoLock(const CryptoLock &) = delete;
+    CryptoLock &operator=(const CryptoLock &) = delete;
+};
+
+// Plaintext shape expected by the endpoint that opened the envelope
+typedef bool (*PlaintextCheck)(const char *plaintext);
+
+// Envelopes are not authenticated: random bytes decrypt to something. A
+// nonce is only kept once its plaintext also parses, so junk neither
+// holds slots nor pushes out real entries for long.
+static bool decrypt_envelope(const char *encrypted_b64, const char *session_id, char *output, size_t output_size,
+                             PlaintextCheck accept)
+{
+    PowerLockGuard lock(PowerLock::Crypto);
+    CryptoLock serialized;
+    // Reject a replayed envelope before decrypting it, and long before
+    // it could trigger a reconnect. One base64 decode serves both.
+    EnvelopeData envelope;
+    uint8_t nonce[ENVELOPE_IV_SIZE];
+    EnvelopeError error = envelope_decode(encrypted_b64, envelope);
+    if (error == EnvelopeError::None)
+    {
+        error = envelope_nonce(envelope, nonce);
+    }
+    if (error != EnvelopeError::None)
+    {
+        LOG_WARN("%s", envelope_error_message(error));
+        return false;
+    }
+    uint32_t started = ESP.getCycleCount();
+    ReplayVerdict verdict = replay_guard_admit(nonce, sizeof(nonce), millis());
+    replay_guard_add_cost(ESP.getCycleCount() - started);
+    if (verdict != ReplayVerdict::Fresh)
+    {
+        LOG_WARN("Replayed envelope rejected");
+        return false;
+    }
+    if (session_id)
+    {
+        uint8_t id[SESSION_ID_SIZE];
+        uint8_t session_key[SESSION_KEY_SIZE];
+        if (!session_id_from_hex(session_id, id) || !session_lookup_key(id, millis(), session_key))
+        {
+            LOG_WARN("Unknown or expired session");
+            replay_guard_forget(nonce, sizeof(nonce));
+            return false;
+        }
+        error = envelope_decrypt(session_key, envelope, output, output_size);
+        memset(session_key, 0, sizeof(session_key));
+    }
+    else
+    {
+        error = envelope_decrypt_keyring(keyRing, envelope, output, output_size);
+    }
+    if (error != EnvelopeError::None)
+    {
+        LOG_WARN("%s", envelope_error_message(error));
+        replay_guard_forget(nonce, sizeof(nonce));
+        return false;
+    }
+    if (!accept(output))
+    {
+        LOG_WARN("Malformed envelope plaintext");
+        memset(output, 0, output_size);
+        replay_guard_forget(nonce, sizeof(nonce));
+        return false;
+    }
+    LOG_DEBUG("Decrypted output: [%s]", log_secret(output));
+    return true;
+}
+
+static bool credentials_well_formed(const char *plaintext)
+{
+    WifiCredentials creds;
+    bool ok = parse_credentials(plaintext, creds);
+    wipe_credentials(creds);
+    return ok;
+}
+
+bool decrypt_wifi_credentials(const char *encrypted_b64, const char *session_id, char *output, size_t output_size)
+{
+    return decrypt_envelope(encrypted_b64, session_id, output, output_size, credentials_well_formed);
+}
+
+// ===========================================================
+// HTTP Request Handlers
+// ===========================================================
+// Each request borrows a context block from the request pool (see
+// request_pool.h) and parses its JSON out of the arena inside it, in
+// both builds, so request traffic never touches the general heap. The
+// blocks are cold buffers.
+alignas(8) COLD_BSS static uint8_t requestPoolStorage[REQUEST_POOL_STORAGE_SIZE];
+
+class ArenaJsonAllocator : public ArduinoJson::Allocator
+{
+public:
+    explicit ArenaJsonAllocator(FixedArena &arena) : arena_(arena) {}
+    void *allocate(size_t size) override { return arena_.allocate(size); }
+    void deallocate(void *) override {}
+    void *reallocate(void *ptr, size_t new_size) override { return arena_.reallocate(ptr, new_size); }
+
+private:
+    FixedArena &arena_;
+};
+
+static const size_t REQUEST_JSON_ARENA_SIZE = 1024;
+
+struct RequestContext
+{
+    RequestContext() : arena(json, sizeof(json)), allocator(arena) {}
+
+    WifiSetupRequest setup;
+    uint8_t json[REQUEST_JSON_ARENA_SIZE];
+    FixedArena arena;
+    ArenaJsonAllocator allocator;
+};
+static_assert(sizeof(RequestContext) <= REQUEST_BLOCK_SIZE, "RequestContext must fit a request pool block");
+
+static RequestContext *context_acquire()
+{
+    void *block = request_block_acquire();
+    return block ? new (block) RequestContext() : nullptr;
+}
+
+static void context_release(RequestContext *ctx)
+{
+    if (ctx)
+    {
+        ctx->~RequestContext();
+        request_block_release(ctx);
+    }
+}
+
+// Borrows a context for the duration of a single-chunk handler
+class ContextLease
+{
+public:
+    ContextLease() : ctx_(context_acquire()) {}
+    ~ContextLease() { context_release(ctx_); }
+
+    RequestContext *operator->() const { return ctx_; }
+    explicit operator bool() const { return ctx_ != nullptr; }
+
+private:
+    RequestContext *ctx_;
+};
+
+// /set_wifi bodies span several chunks, so their context is looked up
+// by request until the reply is sent or the client goes away. Only the
+// async_tcp task touches this table.
+static RequestContext *setupContexts[REQUEST_POOL_BLOCKS];
+
+static void release_setup_context(RequestContext *&slot)
+{
+    context_release(slot);
+    slot = nullptr;
+}
+
+static RequestContext *setup_context(AsyncWebServerRequest *request, size_t index)
+{
+    for (RequestContext *ctx : setupContexts)
+    {
+        if (ctx && ctx->setup.owner == request)
+        {
+            return ctx;
+        }
+    }
+    if (index != 0)
+    {
+        return nullptr;
+    }
+    for (RequestContext *&slot : setupContexts)
+    {
+        if (!slot)
+        {
+            slot = context_acquire();
+            if (!slot)
+            {
+                return nullptr;
+            }
+            wifi_setup_reset(slot->setup, request, &slot->allocator);
+            request->onDisconnect([request]()
+                                  {
+                                      for (RequestContext *&c : setupContexts)
+                                      {
+                                          if (c && c->setup.owner == request)
+                                          {
+                                              release_setup_context(c);
+                                          }
+                                      }
+                                  });
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+void handle_wifi_setup(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    ScopedTiming timing("set_wifi");
+    request_capture_body(request, data, len, index, total);
+    if (index == 0)
+    {
+        LOG_INFO("Received WiFi setup request...");
+    }
+    RequestContext *ctx = setup_context(request, index);
+    if (!ctx)
+    {
+        if (index == 0)
+        {
+            LOG_WARN("No free setup context, request rejected");
+            request->send(503, "text/plain", "Busy");
+        }
+        return;
+    }
+    WifiSetupReply reply;
+    if (!wifi_setup_feed(ctx->setup, data, len, index, total, reply))
+    {
+        return; // More chunks to come
+    }
+    if (reply.status != 200)
+    {
+        LOG_WARN("%s", reply.message);
+    }
+    request->send(reply.status, "text/plain", reply.message);
+    timing.stop();
+    if (ctx->setup.has_credentials)
+    {
+        LOG_DEBUG("Decrypted String: [%s]", log_secret(ctx->setup.credentials));
+        // No sleep here: the connect task pauses before touching the radio,
+        // which leaves time for the reply to flush
+        if (wifi_dispatch_credentials(ctx->setup.credentials))
+        {
+            BusEvent event;
+            event.type = BusEventType::CredentialsReceived;
+            event.source = CredentialSource::Http;
+            event_bus_publish(event);
+        }
+        else
+        {
+            LOG_WARN("WiFi setup already in progress, request dropped");
+        }
+    }
+    for (RequestContext *&slot : setupContexts)
+    {
+        if (slot == ctx)
+        {
+            release_setup_context(slot);
+        }
+    }
+}
+
+static uint32_t cycle_count()
+{
+    return ESP.getCycleCount();
+}
+
+static int session_rng(void *, unsigned char *buf, size_t len)
+{
+    esp_fill_random(buf, len);
+    return 0;
+}
+
+void handle_session(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture_body(request, data, len, index, total);
+    // The body is a single small JSON object; it always arrives whole
+    if (index != 0 || len != total || total > 128)
+    {
+        request->send(400, "text/plain", "Invalid session request");
+        return;
+    }
+    ContextLease ctx;
+    if (!ctx)
+    {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    JsonDocument jsonDoc(&ctx->allocator);
+    const char *client_pub_b64 = nullptr;
+    if (!deserializeJson(jsonDoc, (const char *)data, len))
+    {
+        client_pub_b64 = jsonDoc["client_pub"];
+    }
+    uint8_t client_pub[SESSION_PUB_SIZE + 4];
+    size_t client_pub_len = 0;
+    if (!client_pub_b64 ||
+        mbedtls_base64_decode(client_pub, sizeof(client_pub), &client_pub_len, (const uint8_t *)client_pub_b64,
+                              strlen(client_pub_b64)) != 0 ||
+        client_pub_len != SESSION_PUB_SIZE)
+    {
+        request->send(400, "text/plain", "Missing or malformed 'client_pub'");
+        return;
+    }
+
+    SessionResult result;
+    int64_t started = esp_timer_get_time();
+    bool ok;
+    {
+        PowerLockGuard crypto(PowerLock::Crypto);
+        CryptoLock serialized;
+        ok = session_handshake(client_pub, (uint32_t)request->client()->remoteIP(), millis(), result);
+    }
+    uint32_t took_us = (uint32_t)(esp_timer_get_time() - started);
+    if (!ok)
+    {
+        LOG_WARN("Session handshake failed");
+        request->send(400, "text/plain", "Handshake failed");
+        return;
+    }
+    diagnostics_record_timing(result.cached ? "session_cached" : "session_handshake", took_us);
+
+    char id_hex[2 * SESSION_ID_SIZE + 1];
+    session_id_to_hex(result.id, id_hex);
+    uint8_t server_pub_b64[48];
+    size_t b64_len = 0;
+    mbedtls_base64_encode(server_pub_b64, sizeof(server_pub_b64), &b64_len, result.server_pub, SESSION_PUB_SIZE);
+    char json[128];
+    snprintf(json, sizeof(json), "{\"session\":\"%s\",\"server_pub\":\"%.*s\",\"ttl_s\":%lu}", id_hex, (int)b64_len,
+             (const char *)server_pub_b64, (unsigned long)(session_ttl_ms() / 1000));
+    LOG_INFO("Session %s %s in %lu us", id_hex, result.cached ? "reused" : "established", (unsigned long)took_us);
+    request->send(200, "application/json", json);
+}
+
+void handle_fleet_send(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture_body(request, data, len, index, total);
+    if (index != 0 || len != total || total > 384)
+    {
+        request->send(400, "text/plain", "Invalid fleet request");
+        return;
+    }
+    ContextLease ctx;
+    if (!ctx)
+    {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    JsonDocument jsonDoc(&ctx->allocator);
+    if (deserializeJson(jsonDoc, (const char *)data, len))
+    {
+        request->send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+    const char *envelope = jsonDoc["data"];
+    if (!envelope)
+    {
+        request->send(400, "text/plain", "Missing 'data' parameter");
+        return;
+    }
+    FleetAddress target = fleet_address_all();
+    const char *mac_text = jsonDoc["mac"];
+    if (mac_text)
+    {
+        unsigned m[FLEET_MAC_SIZE];
+        if (sscanf(mac_text, "%2x:%2x:%2x:%2x:%2x:%2x", &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != 6)
+        {
+            request->send(400, "text/plain", "Malformed 'mac'");
+            return;
+        }
+        uint8_t mac[FLEET_MAC_SIZE];
+        for (size_t i = 0; i < FLEET_MAC_SIZE; i++)
+        {
+            mac[i] = (uint8_t)m[i];
+        }
+        target = fleet_address_mac(mac);
+    }
+    else if (!jsonDoc["group"].isNull())
+    {
+        target = fleet_address_group(jsonDoc["group"].as<uint8_t>());
+    }
+    uint16_t expected = jsonDoc["expect"] | 0;
+    uint8_t retries = jsonDoc["retries"] | 10;
+    uint32_t interval_ms = jsonDoc["interval_ms"] | 50;
+    if (!fleet_link_send(envelope, target, expected, retries, interval_ms))
+    {
+        request->send(503, "text/plain", "Fleet link unavailable");
+        return;
+    }
+    request->send(202, "text/plain", "Fleet campaign queued");
+}
+
+struct KeyCommand
+{
+    bool remove;
+    unsigned id;
+    uint8_t key[ENVELOPE_KEY_SIZE];
+};
+
+// "set|<id>|<32 hex digits>" or "remove|<id>"; slot 0 can be replaced but
+// not removed, since the built-in key would come back at the next boot
+static bool parse_key_command(const char *plaintext, KeyCommand &out)
+{
+    char hex[2 * ENVELOPE_KEY_SIZE + 1] = "";
+    bool ok = false;
+    out.remove = false;
+    out.id = ENVELOPE_KEY_SLOTS;
+    if (sscanf(plaintext, "set|%u|%32[0-9a-fA-F]", &out.id, hex) == 2 && strlen(hex) == 2 * ENVELOPE_KEY_SIZE &&
+        out.id < ENVELOPE_KEY_SLOTS)
+    {
+        for (size_t i = 0; i < ENVELOPE_KEY_SIZE; i++)
+        {
+            unsigned v;
+            sscanf(hex + 2 * i, "%2x", &v);
+            out.key[i] = (uint8_t)v;
+        }
+        ok = true;
+    }
+    else if (sscanf(plaintext, "remove|%u", &out.id) == 1 && out.id > 0 && out.id < ENVELOPE_KEY_SLOTS)
+    {
+        out.remove = true;
+        ok = true;
+    }
+    memset(hex, 0, sizeof(hex));
+    return ok;
+}
+
+static bool key_command_well_formed(const char *plaintext)
+{
+    KeyCommand cmd;
+    bool ok = parse_key_command(plaintext, cmd);
+    memset(&cmd, 0, sizeof(cmd));
+    return ok;
+}
+
+// Body {"data": envelope} holding a key command (see parse_key_command).
+// The envelope must decrypt with a key already in the ring (never a
+// session key, which anyone can negotiate) and passes the same replay
+// guard as /set_wifi, so only a holder of a current fleet key can rotate
+// keys.
+void handle_keys(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture_body(request, data, len, index, total);
+    if (index != 0 || len != total || total > 256)
+    {
+        request->send(400, "text/plain", "Invalid key request");
+        return;
+    }
+    ContextLease ctx;
+    if (!ctx)
+    {
+        request->send(503, "text/plain", "Busy");
+        return;
+    }
+    JsonDocument jsonDoc(&ctx->allocator);
+    const char *envelope = nullptr;
+    if (!deserializeJson(jsonDoc, (const char *)data, len))
+    {
+        envelope = jsonDoc["data"];
+    }
+    // A malformed command is rejected here too, and its nonce released
+    char command[ENVELOPE_MAX_PLAINTEXT + 1];
+    KeyCommand cmd;
+    if (!envelope || !decrypt_envelope(envelope, nullptr, command, sizeof(command), key_command_well_formed) ||
+        !parse_key_command(command, cmd))
+    {
+        memset(command, 0, sizeof(command));
+        request->send(403, "text/plain", "Key command rejected");
+        return;
+    }
+    memset(command, 0, sizeof(command));
+    bool ok;
+    {
+        CryptoLock serialized;
+        if (cmd.remove)
+        {
+            credential_store_remove_key((uint8_t)cmd.id);
+            envelope_keyring_remove(keyRing, (uint8_t)cmd.id);
+            ok = true;
+        }
+        else
+        {
+            ok = credential_store_save_key((uint8_t)cmd.id, cmd.key) &&
+                 envelope_keyring_set(keyRing, (uint8_t)cmd.id, cmd.key);
+        }
+    }
+    unsigned id = cmd.id;
+    memset(&cmd, 0, sizeof(cmd));
+    if (!ok)
+    {
+        request->send(500, "text/plain", "Key update failed");
+        return;
+    }
+    LOG_INFO("Envelope key slot %u updated", id);
+    request->send(200, "text/plain", "Key updated");
+}
+
+static bool ota_authorization_well_formed(const char *plaintext)
+{
+    OtaAuthorization authorization;
+    return ota_parse_authorization(plaintext, authorization);
+}
+
+// Opens the /ota authorization like a key command: key ring only, never
+// a session key, and through the shared replay guard
+static bool authorize_ota(const char *envelope_b64, OtaAuthorization &out)
+{
+    char plaintext[ENVELOPE_MAX_PLAINTEXT + 1];
+    bool ok = decrypt_envelope(envelope_b64, nullptr, plaintext, sizeof(plaintext), ota_authorization_well_formed) &&
+              ota_parse_authorization(plaintext, out);
+    memset(plaintext, 0, sizeof(plaintext));
+    return ok;
+}
+
+void handle_fleet_status(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture(request);
+    char json[384];
+    fleet_link_to_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
+
+void handle_display_message(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    ScopedTiming timing("display");
+    request_capture(request);
+    String msg = "";
+    if (request->hasParam("msg"))
+    {
+        msg = request->getParam("msg")->value();
+    }
+    // UTF-8 passes through; an over-long message is cut before a
+    // multi-byte character rather than inside it. Drawing happens on the
+    // bus consumer; the I2C write never blocks async_tcp.
+    if (!display_request(msg.c_str()))
+    {
+        request->send(503, "text/plain", "Display busy");
+        return;
+    }
+    size_t len = utf8_prefix(msg.c_str(), DISPLAY_TEXT_SIZE - 1);
+    request->send(200, "text/plain; charset=utf-8", String("Displayed: ") + msg.substring(0, len));
+}
+
+void handle_event_stats(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture(request);
+    char json[768];
+    event_bus_to_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
+
+void handle_lifecycle(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture(request);
+    // Too large for the async_tcp stack; handlers run on that one task
+    static char json[LIFECYCLE_JSON_SIZE];
+    lifecycle_to_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
+
+void handle_diagnostics(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture(request);
+    diagnostics_sample();
+    // Too large for the async_tcp stack; handlers run on that one task
+    static char json[DIAG_JSON_SIZE];
+    diagnostics_to_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
+
+void handle_boot_profile(AsyncWebServerRequest *request)
+{
+    PowerLockGuard lock(PowerLock::Http);
+    request_capture(request);
+    char json[768];
+    boot_profile_to_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
+
+void http_api_begin(AsyncWebServer &server, const uint8_t aes_key[ENVELOPE_KEY_SIZE])
+{
+#if STATIC_ALLOCATION
+    static StaticSemaphore_t cryptoMutexStorage;
+    cryptoMutex = xSemaphoreCreateMutexStatic(&cryptoMutexStorage);
+#else
+    cryptoMutex = xSemaphoreCreateMutex();
+#endif
+    envelope_keyring_init(keyRing);
+    envelope_keyring_set(keyRing, 0, aes_key);
+    // Stored keys may also replace slot 0 once the built-in key is rotated out
+    size_t stored = credential_store_load_keys(keyRing);
+    LOG_INFO("Envelope keys: %u stored, %u active", (unsigned)stored, (unsigned)envelope_keyring_count(keyRing));
+    session_configure(session_rng, nullptr);
+    // Also lends the connect task its credential blocks
+    request_pool_begin(requestPoolStorage, cycle_count);
+    uint8_t salt[REPLAY_GUARD_SALT_SIZE];
+    esp_fill_random(salt, sizeof(salt));
+    replay_guard_configure(salt, REPLAY_HOLD_MS);
+    // The pool and the guard are pure cores; their /diag sections are
+    // registered by the module that runs them
+    diagnostics_register_section("replay", replay_guard_to_json);
+    diagnostics_register_section("request_pool", request_pool_to_json);
+    wifi_setup_configure(decrypt_wifi_credentials);
+    server.on("/session", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, handle_session);
+    // Fleet key rotation: /keys
+    server.on("/keys", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, handle_keys);
+    server.on("/set_wifi", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, handle_wifi_setup);
+    // ESP-NOW fan-out to peers and link counters: /fleet/send, /fleet
+    server.on("/fleet/send", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, handle_fleet_send);
+    server.on("/fleet", HTTP_GET, handle_fleet_status);
+    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
+              { request->send(200, "text/plain", "Hello, world!"); });
+    // New endpoint: /display?msg=your_message_here
+    server.on("/display", HTTP_GET, handle_display_message);
+    // Stack and heap high-water marks: /diag
+    server.on("/diag", HTTP_GET, handle_diagnostics);
+    // Event bus counters and dispatch latency: /events
+    server.on("/events", HTTP_GET, handle_event_stats);
+    // Current lifecycle state and recent transitions: /lifecycle
+    server.on("/lifecycle", HTTP_GET, handle_lifecycle);
+    // Boot phase timings for this and the previous boot: /boot
+    server.on("/boot", HTTP_GET, handle_boot_profile);
+    // Streaming firmware update: /ota
+    ota_update_configure(authorize_ota);
+    server.on("/ota", HTTP_POST, handle_ota_request, NULL, handle_ota_body);
+    server.on("/ota", HTTP_GET, handle_ota_status);
+#if REQUEST_CAPTURE
+    // Traffic capture for host replay: /capture/start, /capture/stop, /capture
+    request_capture_register(server);
+#endif
+}
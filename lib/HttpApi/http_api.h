@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include "envelope.h"
+
+// ===========================================================
+// HTTP API
+// ===========================================================
+//   POST /session    {"client_pub": base64(X25519 public key)}
+//   POST /set_wifi   {"data": base64([key id] || IV || AES-CBC("ssid|password")), "session": "<id>"}
+//   POST /keys       {"data": envelope("set|<id>|<hex key>" | "remove|<id>")}, existing fleet key
+//   POST /fleet/send {"data": envelope, "group": n | "mac": "aa:bb:..", "expect": n,
+//                     "retries": n, "interval_ms": n}; no group or mac sends to all
+//   GET  /fleet
+//   GET  /display?msg=...  UTF-8, URL-encoded
+//   GET  /diag
+//   GET  /events
+//   GET  /lifecycle
+//   GET  /boot
+//   POST /ota        raw firmware image, X-Firmware-Authorization:
+//                    envelope("ota|<size>|<SHA-256 prefix hex>"), existing fleet key
+//   GET  /ota        state and timings of the last update
+//   GET  /
+
+// Register every endpoint on server; aes_key fills key slot 0 unless NVS
+// holds a replacement
+void http_api_begin(AsyncWebServer &server, const uint8_t aes_key[ENVELOPE_KEY_SIZE]);
+
+// Decrypt with the session's key, or the envelope's key slot when session_id is nullptr.
+// Fails, releasing the nonce, unless the plaintext parses as "ssid|password".
+// Callable from any task: calls are serialized on one mutex.
+bool decrypt_wifi_credentials(const char *encrypted_b64, const char *session_id, char *output, size_t output_size);
+
+void handle_wifi_setup(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handle_session(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handle_keys(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handle_fleet_send(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handle_fleet_status(AsyncWebServerRequest *request);
+void handle_display_message(AsyncWebServerRequest *request);
+void handle_diagnostics(AsyncWebServerRequest *request);
+void handle_event_stats(AsyncWebServerRequest *request);
+void handle_lifecycle(AsyncWebServerRequest *request);
+void handle_boot_profile(AsyncWebServerRequest *request);
@@ -0,0 +1,147 @@
+#include "lifecycle.h"
+#include <stdio.h>
+
+typedef LifecycleState S;
+typedef LifecycleInput I;
+typedef Transition<S, I> T;
+
+static constexpr S ANY = S::Count;
+
+static constexpr T transitions[] = {
+    {S::Boot, I::StoredFound, S::TryStored},
+    {S::Boot, I::NoStored, S::ApMode},
+    {S::TryStored, I::JoinOk, S::Connected},
+    {S::TryStored, I::JoinFailed, S::ApMode},
+    {S::TryStored, I::Credentials, S::Provisioning},
+    {S::ApMode, I::Credentials, S::Provisioning},
+    {S::ApMode, I::JoinOk, S::Connected},
+    {S::Provisioning, I::JoinOk, S::Connected},
+    {S::Provisioning, I::JoinFailed, S::ApMode},
+    {S::Connected, I::Disconnected, S::TryStored},
+    {S::Connected, I::Credentials, S::Provisioning},
+    {ANY, I::ResetRequested, S::Reset},
+};
+
+static constexpr StateTable<S, I> table(transitions);
+
+// Properties of the whole table, checked on every build
+static_assert(table.duplicates() == 0, "a (state, input) pair appears twice");
+static_assert(table.terminal(S::Reset), "Reset must not be left");
+static_assert(table.next(S::Reset, I::ResetRequested) == S::Count, "Reset must not re-enter itself");
+static_assert(table.reachable(S::Boot, S::Connected) && table.reachable(S::Boot, S::ApMode) &&
+                  table.reachable(S::Boot, S::Provisioning) && table.reachable(S::Boot, S::TryStored),
+              "every lifecycle state must be reachable from Boot");
+static_assert(table.next(S::Boot, I::ResetRequested) == S::Reset && table.next(S::TryStored, I::ResetRequested) == S::Reset &&
+                  table.next(S::ApMode, I::ResetRequested) == S::Reset &&
+                  table.next(S::Provisioning, I::ResetRequested) == S::Reset &&
+                  table.next(S::Connected, I::ResetRequested) == S::Reset,
+              "a reset must be possible from every live state");
+static_assert(table.reachable(S::Provisioning, S::ApMode) && table.reachable(S::ApMode, S::Provisioning),
+              "a failed provisioning attempt must return to AP mode and be retryable");
+static_assert(!table.reachable(S::Connected, S::Boot), "Boot is only entered at power-on");
+static_assert(table.next(S::TryStored, I::JoinFailed) == S::ApMode,
+              "the rejoin deadline must fall back to AP mode");
+
+static LifecycleMachine machine(table, S::Boot);
+
+const char *lifecycle_state_name(LifecycleState state)
+{
+    switch (state)
+    {
+    case S::Boot:
+        return "boot";
+    case S::TryStored:
+        return "try-stored";
+    case S::ApMode:
+        return "ap";
+    case S::Provisioning:
+        return "provisioning";
+    case S::Connected:
+        return "connected";
+    case S::Reset:
+        return "reset";
+    default:
+        return "unknown";
+    }
+}
+
+const char *lifecycle_input_name(LifecycleInput input)
+{
+    switch (input)
+    {
+    case I::StoredFound:
+        return "stored-found";
+    case I::NoStored:
+        return "no-stored";
+    case I::JoinOk:
+        return "join-ok";
+    case I::JoinFailed:
+        return "join-failed";
+    case I::Credentials:
+        return "credentials";
+    case I::Disconnected:
+        return "disconnected";
+    case I::ResetRequested:
+        return "reset-requested";
+    default:
+        return "unknown";
+    }
+}
+
+void lifecycle_on_enter(LifecycleState state, LifecycleMachine::EntryHook hook)
+{
+    if (state < S::Count)
+    {
+        machine.on_enter(state, hook);
+    }
+}
+
+bool lifecycle_dispatch(LifecycleInput input, uint32_t now_ms)
+{
+    return input < I::Count && machine.dispatch(input, now_ms);
+}
+
+LifecycleState lifecycle_state()
+{
+    return machine.state();
+}
+
+const StateTable<LifecycleState, LifecycleInput> &lifecycle_table()
+{
+    return table;
+}
+
+uint32_t lifecycle_timeout_ms(uint32_t now_ms)
+{
+    if (machine.state() != S::TryStored)
+    {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = now_ms - machine.entered_ms();
+    return elapsed >= LIFECYCLE_REJOIN_MS ? 0 : LIFECYCLE_REJOIN_MS - elapsed;
+}
+
+bool lifecycle_poll(uint32_t now_ms)
+{
+    return lifecycle_timeout_ms(now_ms) == 0 && machine.dispatch(I::JoinFailed, now_ms);
+}
+
+size_t lifecycle_to_json(char *out, size_t size)
+{
+    size_t n = snprintf(out, size, "{\"state\":\"%s\",\"moves\":%lu,\"ignored\":%lu,\"log\":[",
+                        lifecycle_state_name(machine.state()), (unsigned long)machine.moves(),
+                        (unsigned long)machine.ignored());
+    size_t count = machine.log_size();
+    for (size_t i = 0; i < count && n < size; i++)
+    {
+        LifecycleMachine::Record r = machine.log_at(i);
+        n += snprintf(out + n, size - n, "%s{\"ms\":%lu,\"from\":\"%s\",\"input\":\"%s\",\"to\":\"%s\"}", i ? "," : "",
+                      (unsigned long)r.ms, lifecycle_state_name(r.from), lifecycle_input_name(r.input),
+                      lifecycle_state_name(r.to));
+    }
+    if (n < size)
+    {
+        n += snprintf(out + n, size - n, "]}");
+    }
+    return n < size ? n : size - 1;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "state_machine.h"
+
+// ===========================================================
+// Device Lifecycle
+// ===========================================================
+//   Boot --StoredFound--> TryStored --JoinOk--> Connected
+//   Boot --NoStored--> ApMode       TryStored --JoinFailed--> ApMode
+//   ApMode/TryStored/Connected --Credentials--> Provisioning
+//   Provisioning --JoinOk--> Connected, --JoinFailed--> ApMode
+//   Connected --Disconnected--> TryStored (the driver re-joins)
+//   ApMode --JoinOk--> Connected (the driver re-joined after all)
+//   any --ResetRequested--> Reset (terminal)
+//
+// After a disconnect nothing else reports failure, so TryStored has a
+// deadline: lifecycle_poll() turns LIFECYCLE_REJOIN_MS in that state
+// into JoinFailed. The table is built at compile time and checked with
+// static_asserts in lifecycle.cpp. Dispatch from the loop task only;
+// entry hooks run there.
+
+enum class LifecycleState : uint8_t
+{
+    Boot = 0,
+    TryStored,
+    ApMode,
+    Provisioning,
+    Connected,
+    Reset,
+    Count
+};
+
+enum class LifecycleInput : uint8_t
+{
+    StoredFound = 0,
+    NoStored,
+    JoinOk,
+    JoinFailed,
+    Credentials,
+    Disconnected,
+    ResetRequested,
+    Count
+};
+
+typedef StateMachine<LifecycleState, LifecycleInput> LifecycleMachine;
+
+#ifndef LIFECYCLE_REJOIN_MS
+#define LIFECYCLE_REJOIN_MS 30000 // TryStored gives up after this long
+#endif
+
+// The compiled transition table, for tests and tools
+const StateTable<LifecycleState, LifecycleInput> &lifecycle_table();
+
+const char *lifecycle_state_name(LifecycleState state);
+const char *lifecycle_input_name(LifecycleInput input);
+
+// Run hook on every entry into state (nullptr clears it)
+void lifecycle_on_enter(LifecycleState state, LifecycleMachine::EntryHook hook);
+
+// Apply input; false if the current state ignores it
+bool lifecycle_dispatch(LifecycleInput input, uint32_t now_ms);
+
+LifecycleState lifecycle_state();
+
+// Milliseconds until the current state's deadline (0 once it has
+// passed), or UINT32_MAX when the state has none
+uint32_t lifecycle_timeout_ms(uint32_t now_ms);
+
+// Dispatch JoinFailed if TryStored has run out of time; true if it did
+bool lifecycle_poll(uint32_t now_ms);
+
+// Worst case for a full log: 32 records of the longest names
+#define LIFECYCLE_JSON_SIZE 2816
+
+// {"state":..,"moves":..,"ignored":..,"log":[{"ms":..,"from":..,"input":..,"to":..}]}
+size_t lifecycle_to_json(char *out, size_t size);
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// ===========================================================
+// Table-Driven State Machine (compile-time transition table)
+// ===========================================================
+// Transitions are listed as {from, input, to}; StateTable folds that
+// list into a dense [state][input] array in a constexpr constructor, so
+// dispatch is one array index and no virtual call. A `from` equal to
+// State::Count matches every state except the row's own target, and
+// specific rows win over wildcards.
+// Entry hooks are plain function pointers indexed by state.
+//
+// Both enums must be dense, start at 0 and end with Count. Pure C++17.
+
+template <typename State, typename Input>
+struct Transition
+{
+    State from;
+    Input input;
+    State to;
+};
+
+template <typename State, typename Input>
+class StateTable
+{
+public:
+    static constexpr size_t STATES = (size_t)State::Count;
+    static constexpr size_t INPUTS = (size_t)Input::Count;
+
+    template <size_t N>
+    constexpr explicit StateTable(const Transition<State, Input> (&rows)[N]) : next_{}, duplicates_(0)
+    {
+        for (size_t s = 0; s < STATES; s++)
+        {
+            for (size_t i = 0; i < INPUTS; i++)
+            {
+                next_[s][i] = State::Count;
+            }
+        }
+        // Wildcards first so specific rows override them
+        for (size_t r = 0; r < N; r++)
+        {
+            if (rows[r].from == State::Count)
+            {
+                for (size_t s = 0; s < STATES; s++)
+                {
+                    if (s != (size_t)rows[r].to)
+                    {
+                        next_[s][(size_t)rows[r].input] = rows[r].to;
+                    }
+                }
+            }
+        }
+        bool specific[STATES][INPUTS] = {};
+        for (size_t r = 0; r < N; r++)
+        {
+            if (rows[r].from != State::Count)
+            {
+                size_t s = (size_t)rows[r].from;
+                size_t i = (size_t)rows[r].input;
+                duplicates_ += specific[s][i] ? 1 : 0;
+                specific[s][i] = true;
+                next_[s][i] = rows[r].to;
+            }
+        }
+    }
+
+    // State::Count when the input has no transition from this state
+    constexpr State next(State from, Input input) const { return next_[(size_t)from][(size_t)input]; }
+
+    // Rows naming the same (from, input) twice; a table should have none
+    constexpr size_t duplicates() const { return duplicates_; }
+
+    // True if target can be reached from start by some input sequence
+    constexpr bool reachable(State start, State target) const
+    {
+        bool seen[STATES] = {};
+        seen[(size_t)start] = true;
+        for (size_t round = 0; round < STATES; round++)
+        {
+            for (size_t s = 0; s < STATES; s++)
+            {
+                for (size_t i = 0; seen[s] && i < INPUTS; i++)
+                {
+                    if (next_[s][i] != State::Count)
+                    {
+                        seen[(size_t)next_[s][i]] = true;
+                    }
+                }
+            }
+        }
+        return seen[(size_t)target];
+    }
+
+    constexpr bool terminal(State s) const
+    {
+        for (size_t i = 0; i < INPUTS; i++)
+        {
+            if (next_[(size_t)s][i] != State::Count)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    State next_[STATES][INPUTS];
+    size_t duplicates_;
+};
+
+template <typename State, typename Input>
+struct TransitionRecord
+{
+    uint32_t ms;
+    State from;
+    Input input;
+    State to;
+};
+
+// Runtime half: current state, entry hooks and a ring of recent moves.
+// Drive it from one task; readers in other tasks may see a record that
+// is being overwritten once the ring wraps, never a torn count.
+template <typename State, typename Input, size_t LOG_SIZE = 32>
+class StateMachine
+{
+public:
+    typedef void (*EntryHook)(State from, Input input);
+    typedef TransitionRecord<State, Input> Record;
+
+    constexpr StateMachine(const StateTable<State, Input> &table, State initial)
+        : table_(table), state_(initial), entered_ms_(0), hooks_{}, log_{}, moves_(0), ignored_(0)
+    {
+    }
+
+    void on_enter(State state, EntryHook hook) { hooks_[(size_t)state] = hook; }
+
+    // Apply input; false (and counted as ignored) if it has no transition
+    bool dispatch(Input input, uint32_t now_ms)
+    {
+        State from = state_;
+        State to = table_.next(from, input);
+        if (to == State::Count)
+        {
+            ignored_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t n = moves_.load(std::memory_order_relaxed);
+        log_[n % LOG_SIZE] = Record{now_ms, from, input, to};
+        moves_.store(n + 1, std::memory_order_release);
+        state_ = to;
+        entered_ms_ = now_ms;
+        if (hooks_[(size_t)to])
+        {
+            hooks_[(size_t)to](from, input);
+        }
+        return true;
+    }
+
+    State state() const { return state_; }
+    // now_ms of the move into the current state; 0 before the first move
+    uint32_t entered_ms() const { return entered_ms_; }
+    uint32_t moves() const { return moves_.load(std::memory_order_acquire); }
+    uint32_t ignored() const { return ignored_.load(std::memory_order_relaxed); }
+
+    // index 0 is the oldest record still held
+    size_t log_size() const
+    {
+        uint32_t n = moves();
+        return n < LOG_SIZE ? n : LOG_SIZE;
+    }
+    Record log_at(size_t index) const
+    {
+        uint32_t n = moves();
+        uint32_t first = n < LOG_SIZE ? 0 : n - LOG_SIZE;
+        return log_[(first + index) % LOG_SIZE];
+    }
+
+private:
+    const StateTable<State, Input> &table_;
+    State state_;
+    uint32_t entered_ms_;
+    EntryHook hooks_[(size_t)State::Count];
+    Record log_[LOG_SIZE];
+    std::atomic<uint32_t> moves_;
+    std::atomic<uint32_t> ignored_;
+};
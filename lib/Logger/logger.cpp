@@ -0,0 +1,195 @@
+#include "logger.h"
+#include <atomic>
+#include <stdarg.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "static_alloc.h"
+#include "mem_placement.h"
+#include "diagnostics.h"
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+struct LogSlot
+{
+    std::atomic<uint8_t> ready;
+    uint8_t level;
+    uint16_t len;
+    uint32_t timestamp_ms;
+    char text[LOG_SLOT_TEXT];
+};
+
+// Producers reserve a slot by advancing head with CAS, format into it,
+// then publish it with `ready`. The single consumer drains in order from
+// tail and frees a slot by advancing tail. The ring is a cold buffer.
+COLD_BSS static LogSlot ring[LOG_RING_SLOTS];
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> tail(0);
+
+static std::atomic<uint32_t> statWritten(0);
+static std::atomic<uint32_t> statDropped(0);
+static std::atomic<uint32_t> statTruncated(0);
+static std::atomic<uint32_t> statCyclesMax(0);
+static uint64_t statCyclesTotal = 0;
+static portMUX_TYPE statMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t drainTask = NULL;
+static std::atomic<bool> draining(false);
+static const char level_tags[] = {'-', 'E', 'W', 'I', 'D'};
+
+static bool reserve_slot(uint32_t &index)
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    do
+    {
+        if (h - tail.load(std::memory_order_acquire) >= LOG_RING_SLOTS)
+        {
+            return false;
+        }
+    } while (!head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+    index = h;
+    return true;
+}
+
+void log_writef(uint8_t level, const char *fmt, ...)
+{
+    uint32_t start = ESP.getCycleCount();
+    uint32_t index;
+    if (!reserve_slot(index))
+    {
+        statDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    LogSlot &slot = ring[index & (LOG_RING_SLOTS - 1)];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(slot.text, sizeof(slot.text), fmt, args);
+    va_end(args);
+    if (n < 0)
+    {
+        n = 0;
+    }
+    else if ((size_t)n >= sizeof(slot.text))
+    {
+        n = sizeof(slot.text) - 1;
+        statTruncated.fetch_add(1, std::memory_order_relaxed);
+    }
+    slot.level = level;
+    slot.len = (uint16_t)n;
+    slot.timestamp_ms = millis();
+    slot.ready.store(1, std::memory_order_release);
+    statWritten.fetch_add(1, std::memory_order_relaxed);
+
+    if (drainTask)
+    {
+        xTaskNotifyGive(drainTask);
+    }
+
+    uint32_t cycles = ESP.getCycleCount() - start;
+    uint32_t prev_max = statCyclesMax.load(std::memory_order_relaxed);
+    while (cycles > prev_max && !statCyclesMax.compare_exchange_weak(prev_max, cycles, std::memory_order_relaxed))
+    {
+    }
+    portENTER_CRITICAL(&statMux);
+    statCyclesTotal += cycles;
+    portEXIT_CRITICAL(&statMux);
+}
+
+// Write out every published slot at the tail; stops at the first slot
+// still being formatted so output stays in order. Only one caller drains
+// at a time (the drain task, or logger_flush()).
+static void drain()
+{
+    if (draining.exchange(true, std::memory_order_acquire))
+    {
+        return;
+    }
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    while (t != head.load(std::memory_order_acquire))
+    {
+        LogSlot &slot = ring[t & (LOG_RING_SLOTS - 1)];
+        if (!slot.ready.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        char prefix[20];
+        int plen = snprintf(prefix, sizeof(prefix), "[%8lu][%c] ", (unsigned long)slot.timestamp_ms,
+                            slot.level < sizeof(level_tags) ? level_tags[slot.level] : '?');
+        Serial.write((const uint8_t *)prefix, plen);
+        Serial.write((const uint8_t *)slot.text, slot.len);
+        Serial.write('\n');
+        slot.ready.store(0, std::memory_order_relaxed);
+        t++;
+        tail.store(t, std::memory_order_release);
+    }
+    draining.store(false, std::memory_order_release);
+}
+
+static void drain_task(void *)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drain();
+    }
+}
+
+bool logger_begin()
+{
+#if STATIC_ALLOCATION
+    static StaticTask_t drainTcb;
+    static StackType_t drainStack[2560];
+    drainTask = xTaskCreateStatic(drain_task, "logDrain", sizeof(drainStack), NULL, tskIDLE_PRIORITY + 1, drainStack,
+                                  &drainTcb);
+#else
+    xTaskCreate(drain_task, "logDrain", 2560, NULL, tskIDLE_PRIORITY + 1, &drainTask);
+#endif
+    if (!drainTask)
+    {
+        return false;
+    }
+    // Pick up anything logged before the task existed
+    xTaskNotifyGive(drainTask);
+    diagnostics_register_section("log", logger_to_json);
+    return true;
+}
+
+void logger_flush()
+{
+    // Bounded: a producer stuck mid-format must not hang a restart
+    for (int i = 0; i < 50 && tail.load(std::memory_order_acquire) != head.load(std::memory_order_acquire); i++)
+    {
+        drain();
+        vTaskDelay(1);
+    }
+    Serial.flush();
+}
+
+size_t logger_free_slots()
+{
+    uint32_t used = head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    return used >= LOG_RING_SLOTS ? 0 : LOG_RING_SLOTS - used;
+}
+
+LoggerStats logger_stats()
+{
+    LoggerStats s;
+    s.written = statWritten.load(std::memory_order_relaxed);
+    s.dropped = statDropped.load(std::memory_order_relaxed);
+    s.truncated = statTruncated.load(std::memory_order_relaxed);
+    s.enqueue_cycles_max = statCyclesMax.load(std::memory_order_relaxed);
+    portENTER_CRITICAL(&statMux);
+    s.enqueue_cycles_total = statCyclesTotal;
+    portEXIT_CRITICAL(&statMux);
+    return s;
+}
+
+size_t logger_to_json(char *out, size_t size)
+{
+    LoggerStats log = logger_stats();
+    return snprintf(out, size,
+                    "{\"written\":%lu,\"dropped\":%lu,\"truncated\":%lu,\"enqueue_cycles_avg\":%lu,"
+                    "\"enqueue_cycles_max\":%lu}",
+                    (unsigned long)log.written, (unsigned long)log.dropped, (unsigned long)log.truncated,
+                    (unsigned long)(log.written ? log.enqueue_cycles_total / log.written : 0),
+                    (unsigned long)log.enqueue_cycles_max);
+}
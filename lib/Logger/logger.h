@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===========================================================
+// Asynchronous Ring-Buffer Logger
+// ===========================================================
+// LOG_ERROR/WARN/INFO/DEBUG format into a fixed slot of a lock-free
+// ring and return; a low-priority task drains the ring to Serial. The
+// caller never waits on the UART. Levels above LOG_LEVEL compile out
+// entirely, arguments included.
+//
+// Secrets are redacted by type: wrap them in log_secret() and they are
+// printed as "[redacted]" unless built with LOG_REVEAL_SECRETS=1.
+//
+// Not for ISR context.
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_REVEAL_SECRETS
+#define LOG_REVEAL_SECRETS 0
+#endif
+
+// Ring geometry; slot count must be a power of two
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS 32
+#endif
+#define LOG_SLOT_TEXT 112
+
+struct LogSecret
+{
+    const char *value;
+};
+
+inline LogSecret log_secret(const char *value) { return LogSecret{value}; }
+
+struct LoggerStats
+{
+    uint32_t written;
+    uint32_t dropped;        // Ring full at the time of the call
+    uint32_t truncated;      // Message longer than LOG_SLOT_TEXT
+    uint32_t enqueue_cycles_max;
+    uint64_t enqueue_cycles_total;
+};
+
+// Start the drain task; messages logged earlier wait in the ring
+bool logger_begin();
+
+// Drain everything pending on the calling task (e.g. before a restart)
+void logger_flush();
+
+// Ring slots not yet reserved; a bulk writer waits for room with this
+// rather than having its lines dropped
+size_t logger_free_slots();
+
+LoggerStats logger_stats();
+
+// {"written":..,"dropped":..,"truncated":..,"enqueue_cycles_avg":..,"enqueue_cycles_max":..}
+size_t logger_to_json(char *out, size_t size);
+
+// A LOG_* call whose arguments do not match its format fails to build
+#pragma GCC diagnostic error "-Wformat"
+
+void log_writef(uint8_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// Argument mapping applied at the call site before formatting: secrets
+// are replaced, Strings become C strings, everything else passes through
+// by reference. The mapped arguments go straight to log_writef(), so the
+// compiler checks them against the literal format.
+template <typename T>
+inline const T &log_arg(const T &value) { return value; }
+inline const char *log_arg(const String &value) { return value.c_str(); }
+inline const char *log_arg(const LogSecret &secret)
+{
+#if LOG_REVEAL_SECRETS
+    return secret.value;
+#else
+    (void)secret;
+    return "[redacted]";
+#endif
+}
+
+// LOG_MAP(fmt, a, b, ...) -> fmt, log_arg(a), log_arg(b), ...; up to 15
+// arguments after the format
+#define LOG_MAP_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define LOG_MAP_CAT(a, b) a##b
+#define LOG_MAP_GO(n, ...) LOG_MAP_CAT(LOG_MAP_, n)(__VA_ARGS__)
+#define LOG_MAP(...)                                                                                          \
+    LOG_MAP_GO(LOG_MAP_N(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), __VA_ARGS__)
+#define LOG_MAP_1(f) f
+#define LOG_ARGS_1(a) log_arg(a)
+#define LOG_ARGS_2(a, ...) log_arg(a), LOG_ARGS_1(__VA_ARGS__)
+#define LOG_ARGS_3(a, ...) log_arg(a), LOG_ARGS_2(__VA_ARGS__)
+#define LOG_ARGS_4(a, ...) log_arg(a), LOG_ARGS_3(__VA_ARGS__)
+#define LOG_ARGS_5(a, ...) log_arg(a), LOG_ARGS_4(__VA_ARGS__)
+#define LOG_ARGS_6(a, ...) log_arg(a), LOG_ARGS_5(__VA_ARGS__)
+#define LOG_ARGS_7(a, ...) log_arg(a), LOG_ARGS_6(__VA_ARGS__)
+#define LOG_ARGS_8(a, ...) log_arg(a), LOG_ARGS_7(__VA_ARGS__)
+#define LOG_ARGS_9(a, ...) log_arg(a), LOG_ARGS_8(__VA_ARGS__)
+#define LOG_ARGS_10(a, ...) log_arg(a), LOG_ARGS_9(__VA_ARGS__)
+#define LOG_ARGS_11(a, ...) log_arg(a), LOG_ARGS_10(__VA_ARGS__)
+#define LOG_ARGS_12(a, ...) log_arg(a), LOG_ARGS_11(__VA_ARGS__)
+#define LOG_ARGS_13(a, ...) log_arg(a), LOG_ARGS_12(__VA_ARGS__)
+#define LOG_ARGS_14(a, ...) log_arg(a), LOG_ARGS_13(__VA_ARGS__)
+#define LOG_ARGS_15(a, ...) log_arg(a), LOG_ARGS_14(__VA_ARGS__)
+#define LOG_MAP_2(f, ...) f, LOG_ARGS_1(__VA_ARGS__)
+#define LOG_MAP_3(f, ...) f, LOG_ARGS_2(__VA_ARGS__)
+#define LOG_MAP_4(f, ...) f, LOG_ARGS_3(__VA_ARGS__)
+#define LOG_MAP_5(f, ...) f, LOG_ARGS_4(__VA_ARGS__)
+#define LOG_MAP_6(f, ...) f, LOG_ARGS_5(__VA_ARGS__)
+#define LOG_MAP_7(f, ...) f, LOG_ARGS_6(__VA_ARGS__)
+#define LOG_MAP_8(f, ...) f, LOG_ARGS_7(__VA_ARGS__)
+#define LOG_MAP_9(f, ...) f, LOG_ARGS_8(__VA_ARGS__)
+#define LOG_MAP_10(f, ...) f, LOG_ARGS_9(__VA_ARGS__)
+#define LOG_MAP_11(f, ...) f, LOG_ARGS_10(__VA_ARGS__)
+#define LOG_MAP_12(f, ...) f, LOG_ARGS_11(__VA_ARGS__)
+#define LOG_MAP_13(f, ...) f, LOG_ARGS_12(__VA_ARGS__)
+#define LOG_MAP_14(f, ...) f, LOG_ARGS_13(__VA_ARGS__)
+#define LOG_MAP_15(f, ...) f, LOG_ARGS_14(__VA_ARGS__)
+#define LOG_MAP_16(f, ...) f, LOG_ARGS_15(__VA_ARGS__)
+
+#define LOG_AT(level, ...)                                                \
+    do                                                                    \
+    {                                                                     \
+        if ((level) <= LOG_LEVEL)                                         \
+        {                                                                 \
+            log_writef((level), LOG_MAP(__VA_ARGS__));                    \
+        }                                                                 \
+    } while (0)
+
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
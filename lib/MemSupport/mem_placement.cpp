@@ -0,0 +1,50 @@
+#include "mem_placement.h"
+#include <esp_heap_caps.h>
+
+static uint32_t internalFreeAtBoot = 0;
+static uint32_t coldBytesInPsram = 0;
+static uint32_t coldBytesFallback = 0;
+
+bool placement_psram_available()
+{
+    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+}
+
+void *placement_alloc(size_t size, MemPlacement placement)
+{
+    if (placement == MemPlacement::Cold)
+    {
+        void *ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (ptr)
+        {
+            coldBytesInPsram += size;
+            return ptr;
+        }
+        coldBytesFallback += size;
+    }
+    return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+void placement_free(void *ptr)
+{
+    heap_caps_free(ptr);
+}
+
+void placement_mark_boot()
+{
+    internalFreeAtBoot = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+}
+
+void placement_report()
+{
+    uint32_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    Serial.printf("Internal RAM: %lu free (boot %lu, delta %ld)\n", (unsigned long)internal_free,
+                  (unsigned long)internalFreeAtBoot, (long)internal_free - (long)internalFreeAtBoot);
+    if (placement_psram_available())
+    {
+        Serial.printf("PSRAM: %lu free of %lu\n", (unsigned long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                      (unsigned long)heap_caps_get_total_size(MALLOC_CAP_SPIRAM));
+    }
+    Serial.printf("Cold buffers: %lu bytes in PSRAM, %lu bytes fell back to internal\n",
+                  (unsigned long)coldBytesInPsram, (unsigned long)coldBytesFallback);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===========================================================
+// Memory Placement Policy (internal DRAM vs PSRAM)
+// ===========================================================
+// Hot buffers (touched on every request or from ISRs/DMA: AES context,
+// active framebuffer, queues) stay in internal DRAM. Large, cold buffers
+// (request accumulators, scan caches, log rings, offscreen strips) go to
+// PSRAM when the board has it and fall back to internal RAM otherwise.
+
+enum class MemPlacement : uint8_t
+{
+    Hot,  // Internal DRAM only
+    Cold  // PSRAM preferred, internal fallback
+};
+
+// Static storage for cold buffers. Lands in PSRAM .bss when the build
+// allows it (CONFIG_SPIRAM_ALLOW_BSS_EXT_MEM), otherwise plain .bss.
+#if defined(CONFIG_SPIRAM_ALLOW_BSS_EXT_MEM) && CONFIG_SPIRAM_ALLOW_BSS_EXT_MEM
+#include <esp_attr.h>
+#define COLD_BSS EXT_RAM_BSS_ATTR
+#else
+#define COLD_BSS
+#endif
+
+void *placement_alloc(size_t size, MemPlacement placement);
+void placement_free(void *ptr);
+
+bool placement_psram_available();
+
+// Capture internal RAM headroom; call first thing in setup()
+void placement_mark_boot();
+
+// Print internal/PSRAM free now against the boot mark
+void placement_report();
@@ -0,0 +1,150 @@
+#include "static_alloc.h"
+#include <Arduino.h>
+#include <string.h>
+
+// ===========================================================
+// Fixed Arena
+// ===========================================================
+static const size_t kArenaAlign = sizeof(void *);
+
+static size_t align_up(size_t n)
+{
+    return (n + kArenaAlign - 1) & ~(kArenaAlign - 1);
+}
+
+void *FixedArena::allocate(size_t size)
+{
+    size_t needed = align_up(size);
+    if (needed > capacity_ - used_)
+    {
+        return nullptr;
+    }
+    last_ = buffer_ + used_;
+    used_ += needed;
+    return last_;
+}
+
+void *FixedArena::reallocate(void *ptr, size_t new_size)
+{
+    if (ptr == nullptr)
+    {
+        return allocate(new_size);
+    }
+    uint8_t *block = (uint8_t *)ptr;
+    if (block == last_)
+    {
+        // Grow or shrink the tail block in place
+        size_t offset = block - buffer_;
+        size_t needed = align_up(new_size);
+        if (needed > capacity_ - offset)
+        {
+            return nullptr;
+        }
+        used_ = offset + needed;
+        return block;
+    }
+    // Older block: its size is not tracked, but it ends before the new
+    // block starts, so copying up to that distance never reads past it.
+    void *moved = allocate(new_size);
+    if (moved)
+    {
+        size_t available = (size_t)((uint8_t *)moved - block);
+        memcpy(moved, block, new_size < available ? new_size : available);
+    }
+    return moved;
+}
+
+// ===========================================================
+// Allocation Guard
+// ===========================================================
+static volatile bool guardArmed = false;
+static AllocGuardStats guardStats = {};
+static portMUX_TYPE guardMux = portMUX_INITIALIZER_UNLOCKED;
+
+void alloc_guard_arm()
+{
+    guardArmed = true;
+}
+
+bool alloc_guard_armed()
+{
+    return guardArmed;
+}
+
+AllocGuardStats alloc_guard_stats()
+{
+    portENTER_CRITICAL(&guardMux);
+    AllocGuardStats copy = guardStats;
+    portEXIT_CRITICAL(&guardMux);
+    return copy;
+}
+
+#if STATIC_ALLOCATION
+
+static void IRAM_ATTR record_alloc(size_t size, void *caller)
+{
+    if (!guardArmed)
+    {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&guardMux);
+    if (guardStats.post_boot_allocs++ == 0)
+    {
+        guardStats.first_caller = caller;
+        guardStats.first_size = size;
+    }
+    guardStats.post_boot_bytes += size;
+    portEXIT_CRITICAL_SAFE(&guardMux);
+#if STATIC_ALLOCATION_STRICT
+    // Not safe to print from here (Serial may allocate); stop hard instead
+    abort();
+#endif
+}
+
+// Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so every
+// call site in the image is routed through the guard first.
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+
+    void *__wrap_malloc(size_t size)
+    {
+        record_alloc(size, __builtin_return_address(0));
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        record_alloc(n * size, __builtin_return_address(0));
+        return __real_calloc(n, size);
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        record_alloc(size, __builtin_return_address(0));
+        return __real_realloc(ptr, size);
+    }
+}
+
+void alloc_guard_report()
+{
+    AllocGuardStats s = alloc_guard_stats();
+    if (s.post_boot_allocs == 0)
+    {
+        Serial.println("Alloc guard: no heap allocations since boot");
+        return;
+    }
+    Serial.printf("Alloc guard: %lu post-boot allocations (%lu bytes), first %u bytes from %p\n",
+                  (unsigned long)s.post_boot_allocs, (unsigned long)s.post_boot_bytes,
+                  (unsigned)s.first_size, s.first_caller);
+}
+
+#else
+
+void alloc_guard_report()
+{
+}
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Static Allocation Mode
+// ===========================================================
+// Build with -DSTATIC_ALLOCATION=1 (see [env:esp32dev-static]) to create
+// every task, queue and timer from static storage. Request JSON is
+// parsed out of pooled request contexts in every build (request_pool.h).
+// The allocation guard then flags any malloc that happens after
+// alloc_guard_arm() is called at the end of setup().
+
+#ifndef STATIC_ALLOCATION
+#define STATIC_ALLOCATION 0
+#endif
+
+// Abort on the first post-boot allocation instead of just counting it
+#ifndef STATIC_ALLOCATION_STRICT
+#define STATIC_ALLOCATION_STRICT 0
+#endif
+
+struct AllocGuardStats
+{
+    uint32_t post_boot_allocs;  // malloc/calloc/realloc calls after arming
+    uint32_t post_boot_bytes;
+    void *first_caller;         // Return address of the first offender
+    size_t first_size;
+};
+
+// Mark boot as complete; later heap allocations are recorded
+void alloc_guard_arm();
+bool alloc_guard_armed();
+AllocGuardStats alloc_guard_stats();
+
+// Print the guard state to Serial (no-op in dynamic builds)
+void alloc_guard_report();
+
+// ===========================================================
+// Fixed Arena (bump allocator reset once per request)
+// ===========================================================
+class FixedArena
+{
+public:
+    FixedArena(uint8_t *buffer, size_t capacity) : buffer_(buffer), capacity_(capacity), used_(0), last_(nullptr) {}
+
+    void *allocate(size_t size);
+    void *reallocate(void *ptr, size_t new_size);
+    void reset() { used_ = 0; last_ = nullptr; }
+
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    uint8_t *buffer_;
+    size_t capacity_;
+    size_t used_;
+    uint8_t *last_; // Most recent block; the only one that can grow in place
+};
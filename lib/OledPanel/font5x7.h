@@ -0,0 +1,6 @@
+#pragma once
+
+#include "page_canvas.h"
+
+// Classic 5x7 font in a 6x8 cell; same metrics as Adafruit_GFX text size 1
+extern const FixedFont FONT_5X7;
@@ -0,0 +1,227 @@
+// Generated by scripts/font_atlas.py from /root/repo/fonts/prop8.bdf; do not edit.
+#include "font_prop8.h"
+
+static const uint8_t bitmaps[] = {
+    0x5F, // !
+    0x07, 0x00, 0x07, // "
+    0x14, 0x7F, 0x14, 0x7F, 0x14, // #
+    0x24, 0x2A, 0x7F, 0x2A, 0x12, // $
+    0x23, 0x13, 0x08, 0x64, 0x62, // %
+    0x36, 0x49, 0x56, 0x20, 0x50, // &
+    0x08, 0x07, 0x03, // '
+    0x1C, 0x22, 0x41, // (
+    0x41, 0x22, 0x1C, // )
+    0x2A, 0x1C, 0x7F, 0x1C, 0x2A, // *
+    0x08, 0x08, 0x3E, 0x08, 0x08, // +
+    0x80, 0x70, 0x30, // ,
+    0x08, 0x08, 0x08, 0x08, 0x08, // -
+    0x60, 0x60, // .
+    0x20, 0x10, 0x08, 0x04, 0x02, // /
+    0x3E, 0x51, 0x49, 0x45, 0x3E, // 0
+    0x42, 0x7F, 0x40, // 1
+    0x72, 0x49, 0x49, 0x49, 0x46, // 2
+    0x21, 0x41, 0x49, 0x4D, 0x33, // 3
+    0x18, 0x14, 0x12, 0x7F, 0x10, // 4
+    0x27, 0x45, 0x45, 0x45, 0x39, // 5
+    0x3C, 0x4A, 0x49, 0x49, 0x31, // 6
+    0x41, 0x21, 0x11, 0x09, 0x07, // 7
+    0x36, 0x49, 0x49, 0x49, 0x36, // 8
+    0x46, 0x49, 0x49, 0x29, 0x1E, // 9
+    0x14, // :
+    0x40, 0x34, // ;
+    0x08, 0x14, 0x22, 0x41, // <
+    0x14, 0x14, 0x14, 0x14, 0x14, // =
+    0x41, 0x22, 0x14, 0x08, // >
+    0x02, 0x01, 0x59, 0x09, 0x06, // ?
+    0x3E, 0x41, 0x5D, 0x59, 0x4E, // @
+    0x7C, 0x12, 0x11, 0x12, 0x7C, // A
+    0x7F, 0x49, 0x49, 0x49, 0x36, // B
+    0x3E, 0x41, 0x41, 0x41, 0x22, // C
+    0x7F, 0x41, 0x41, 0x41, 0x3E, // D
+    0x7F, 0x49, 0x49, 0x49, 0x41, // E
+    0x7F, 0x09, 0x09, 0x09, 0x01, // F
+    0x3E, 0x41, 0x41, 0x51, 0x73, // G
+    0x7F, 0x08, 0x08, 0x08, 0x7F, // H
+    0x41, 0x7F, 0x41, // I
+    0x20, 0x40, 0x41, 0x3F, 0x01, // J
+    0x7F, 0x08, 0x14, 0x22, 0x41, // K
+    0x7F, 0x40, 0x40, 0x40, 0x40, // L
+    0x7F, 0x02, 0x1C, 0x02, 0x7F, // M
+    0x7F, 0x04, 0x08, 0x10, 0x7F, // N
+    0x3E, 0x41, 0x41, 0x41, 0x3E, // O
+    0x7F, 0x09, 0x09, 0x09, 0x06, // P
+    0x3E, 0x41, 0x51, 0x21, 0x5E, // Q
+    0x7F, 0x09, 0x19, 0x29, 0x46, // R
+    0x26, 0x49, 0x49, 0x49, 0x32, // S
+    0x03, 0x01, 0x7F, 0x01, 0x03, // T
+    0x3F, 0x40, 0x40, 0x40, 0x3F, // U
+    0x1F, 0x20, 0x40, 0x20, 0x1F, // V
+    0x3F, 0x40, 0x38, 0x40, 0x3F, // W
+    0x63, 0x14, 0x08, 0x14, 0x63, // X
+    0x03, 0x04, 0x78, 0x04, 0x03, // Y
+    0x61, 0x59, 0x49, 0x4D, 0x43, // Z
+    0x7F, 0x41, 0x41, 0x41, // [
+    0x02, 0x04, 0x08, 0x10, 0x20, // backslash
+    0x41, 0x41, 0x41, 0x7F, // ]
+    0x04, 0x02, 0x01, 0x02, 0x04, // ^
+    0x40, 0x40, 0x40, 0x40, 0x40, // _
+    0x03, 0x07, 0x08, // `
+    0x20, 0x54, 0x54, 0x78, 0x40, // a
+    0x7F, 0x28, 0x44, 0x44, 0x38, // b
+    0x38, 0x44, 0x44, 0x44, 0x28, // c
+    0x38, 0x44, 0x44, 0x28, 0x7F, // d
+    0x38, 0x54, 0x54, 0x54, 0x18, // e
+    0x08, 0x7E, 0x09, 0x02, // f
+    0x18, 0xA4, 0xA4, 0x9C, 0x78, // g
+    0x7F, 0x08, 0x04, 0x04, 0x78, // h
+    0x44, 0x7D, 0x40, // i
+    0x20, 0x40, 0x40, 0x3D, // j
+    0x7F, 0x10, 0x28, 0x44, // k
+    0x41, 0x7F, 0x40, // l
+    0x7C, 0x04, 0x78, 0x04, 0x78, // m
+    0x7C, 0x08, 0x04, 0x04, 0x78, // n
+    0x38, 0x44, 0x44, 0x44, 0x38, // o
+    0xFC, 0x18, 0x24, 0x24, 0x18, // p
+    0x18, 0x24, 0x24, 0x18, 0xFC, // q
+    0x7C, 0x08, 0x04, 0x04, 0x08, // r
+    0x48, 0x54, 0x54, 0x54, 0x24, // s
+    0x04, 0x04, 0x3F, 0x44, 0x24, // t
+    0x3C, 0x40, 0x40, 0x20, 0x7C, // u
+    0x1C, 0x20, 0x40, 0x20, 0x1C, // v
+    0x3C, 0x40, 0x30, 0x40, 0x3C, // w
+    0x44, 0x28, 0x10, 0x28, 0x44, // x
+    0x4C, 0x90, 0x90, 0x90, 0x7C, // y
+    0x44, 0x64, 0x54, 0x4C, 0x44, // z
+    0x08, 0x36, 0x41, // {
+    0x77, // |
+    0x41, 0x36, 0x08, // }
+    0x02, 0x01, 0x02, 0x04, 0x02, // ~
+};
+
+// offset, width, bearing, advance, kern_count, kern_first
+static const AtlasGlyph glyphs[] = {
+    {0, 0, 0, 3, 0, 0}, // space
+    {0, 1, 0, 2, 0, 0}, // !
+    {1, 3, 0, 4, 3, 0}, // "
+    {4, 5, 0, 6, 0, 3}, // #
+    {9, 5, 0, 6, 0, 3}, // $
+    {14, 5, 0, 6, 0, 3}, // %
+    {19, 5, 0, 6, 9, 3}, // &
+    {24, 3, 0, 4, 4, 12}, // '
+    {27, 3, 0, 4, 3, 16}, // (
+    {30, 3, 0, 4, 0, 19}, // )
+    {33, 5, 0, 6, 0, 19}, // *
+    {38, 5, 0, 6, 12, 19}, // +
+    {43, 3, 0, 4, 6, 31}, // ,
+    {46, 5, 0, 6, 10, 37}, // -
+    {51, 2, 0, 3, 6, 47}, // .
+    {53, 5, 0, 6, 6, 53}, // /
+    {58, 5, 0, 6, 0, 59}, // 0
+    {63, 3, 0, 4, 0, 59}, // 1
+    {66, 5, 0, 6, 0, 59}, // 2
+    {71, 5, 0, 6, 0, 59}, // 3
+    {76, 5, 0, 6, 0, 59}, // 4
+    {81, 5, 0, 6, 0, 59}, // 5
+    {86, 5, 0, 6, 0, 59}, // 6
+    {91, 5, 0, 6, 6, 59}, // 7
+    {96, 5, 0, 6, 0, 65}, // 8
+    {101, 5, 0, 6, 0, 65}, // 9
+    {106, 1, 0, 2, 1, 65}, // :
+    {107, 2, 0, 3, 0, 66}, // ;
+    {109, 4, 0, 5, 3, 66}, // <
+    {113, 5, 0, 6, 1, 69}, // =
+    {118, 4, 0, 5, 5, 70}, // >
+    {122, 5, 0, 6, 6, 75}, // ?
+    {127, 5, 0, 6, 0, 81}, // @
+    {132, 5, 0, 6, 0, 81}, // A
+    {137, 5, 0, 6, 0, 81}, // B
+    {142, 5, 0, 6, 2, 81}, // C
+    {147, 5, 0, 6, 0, 83}, // D
+    {152, 5, 0, 6, 0, 83}, // E
+    {157, 5, 0, 6, 8, 83}, // F
+    {162, 5, 0, 6, 0, 91}, // G
+    {167, 5, 0, 6, 0, 91}, // H
+    {172, 3, 0, 4, 0, 91}, // I
+    {175, 5, 0, 6, 1, 91}, // J
+    {180, 5, 0, 6, 3, 92}, // K
+    {185, 5, 0, 6, 16, 95}, // L
+    {190, 5, 0, 6, 0, 111}, // M
+    {195, 5, 0, 6, 0, 111}, // N
+    {200, 5, 0, 6, 0, 111}, // O
+    {205, 5, 0, 6, 6, 111}, // P
+    {210, 5, 0, 6, 0, 117}, // Q
+    {215, 5, 0, 6, 0, 117}, // R
+    {220, 5, 0, 6, 0, 117}, // S
+    {225, 5, 0, 6, 8, 117}, // T
+    {230, 5, 0, 6, 0, 125}, // U
+    {235, 5, 0, 6, 0, 125}, // V
+    {240, 5, 0, 6, 0, 125}, // W
+    {245, 5, 0, 6, 0, 125}, // X
+    {250, 5, 0, 6, 6, 125}, // Y
+    {255, 5, 0, 6, 0, 131}, // Z
+    {260, 4, 0, 5, 7, 131}, // [
+    {264, 5, 0, 6, 9, 138}, // backslash
+    {269, 4, 0, 5, 0, 147}, // ]
+    {273, 5, 0, 6, 3, 147}, // ^
+    {278, 5, 0, 6, 8, 150}, // _
+    {283, 3, 0, 4, 2, 158}, // `
+    {286, 5, 0, 6, 6, 160}, // a
+    {291, 5, 0, 6, 0, 166}, // b
+    {296, 5, 0, 6, 0, 166}, // c
+    {301, 5, 0, 6, 0, 166}, // d
+    {306, 5, 0, 6, 0, 166}, // e
+    {311, 4, 0, 5, 6, 166}, // f
+    {315, 5, 0, 6, 0, 172}, // g
+    {320, 5, 0, 6, 0, 172}, // h
+    {325, 3, 0, 4, 0, 172}, // i
+    {328, 4, 0, 5, 0, 172}, // j
+    {332, 4, 0, 5, 0, 172}, // k
+    {336, 3, 0, 4, 0, 172}, // l
+    {339, 5, 0, 6, 0, 172}, // m
+    {344, 5, 0, 6, 0, 172}, // n
+    {349, 5, 0, 6, 0, 172}, // o
+    {354, 5, 0, 6, 0, 172}, // p
+    {359, 5, 0, 6, 0, 172}, // q
+    {364, 5, 0, 6, 9, 172}, // r
+    {369, 5, 0, 6, 0, 181}, // s
+    {374, 5, 0, 6, 0, 181}, // t
+    {379, 5, 0, 6, 0, 181}, // u
+    {384, 5, 0, 6, 0, 181}, // v
+    {389, 5, 0, 6, 0, 181}, // w
+    {394, 5, 0, 6, 0, 181}, // x
+    {399, 5, 0, 6, 0, 181}, // y
+    {404, 5, 0, 6, 0, 181}, // z
+    {409, 3, 0, 4, 0, 181}, // {
+    {412, 1, 0, 2, 0, 181}, // |
+    {413, 3, 0, 4, 0, 181}, // }
+    {416, 5, 0, 6, 3, 181}, // ~
+};
+
+// Right glyph, adjustment; grouped by left glyph
+static const AtlasKern kerns[] = {
+    {0x2F, -1}, {0x4A, -1}, {0x6A, -1}, {0x22, -1}, {0x3F, -1}, {0x54, -1}, {0x59, -1}, {0x5C, -1},
+    {0x5E, -1}, {0x60, -1}, {0x74, -1}, {0x7E, -1}, {0x2C, -1}, {0x2F, -1}, {0x4A, -1}, {0x6A, -1},
+    {0x2B, -1}, {0x2D, -1}, {0x3C, -1}, {0x29, -1}, {0x2E, -1}, {0x33, -1}, {0x37, -1}, {0x3E, -1},
+    {0x3F, -1}, {0x4A, -1}, {0x54, -1}, {0x5D, -1}, {0x5F, -1}, {0x6A, -1}, {0x7E, -1}, {0x3F, -1},
+    {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x60, -1}, {0x74, -1}, {0x29, -1}, {0x33, -1}, {0x37, -1},
+    {0x3E, -1}, {0x3F, -1}, {0x4A, -1}, {0x54, -1}, {0x5D, -1}, {0x6A, -1}, {0x7E, -1}, {0x2B, -1},
+    {0x3F, -1}, {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x74, -1}, {0x2C, -1}, {0x2E, -1}, {0x2F, -1},
+    {0x4A, -1}, {0x5F, -1}, {0x6A, -1}, {0x2C, -1}, {0x2E, -1}, {0x2F, -1}, {0x4A, -1}, {0x5F, -1},
+    {0x6A, -1}, {0x5D, -1}, {0x2B, -1}, {0x2D, -1}, {0x3C, -1}, {0x5D, -1}, {0x29, -1}, {0x37, -1},
+    {0x3E, -1}, {0x5D, -1}, {0x5F, -1}, {0x2C, -1}, {0x2E, -1}, {0x2F, -1}, {0x4A, -1}, {0x5F, -1},
+    {0x6A, -1}, {0x2B, -1}, {0x2D, -1}, {0x2C, -1}, {0x2E, -1}, {0x2F, -1}, {0x3B, -1}, {0x4A, -1},
+    {0x5F, -1}, {0x61, -1}, {0x6A, -1}, {0x2C, -1}, {0x2B, -1}, {0x2D, -1}, {0x3C, -1}, {0x22, -1},
+    {0x27, -1}, {0x2B, -1}, {0x2D, -1}, {0x34, -1}, {0x3A, -1}, {0x3C, -1}, {0x3D, -1}, {0x3F, -1},
+    {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x5E, -1}, {0x60, -1}, {0x74, -1}, {0x7E, -1}, {0x2C, -1},
+    {0x2E, -1}, {0x2F, -1}, {0x4A, -1}, {0x5F, -1}, {0x6A, -1}, {0x2B, -1}, {0x2C, -1}, {0x2D, -1},
+    {0x2E, -1}, {0x2F, -1}, {0x4A, -1}, {0x5F, -1}, {0x6A, -1}, {0x2C, -1}, {0x2E, -1}, {0x2F, -1},
+    {0x4A, -1}, {0x5F, -1}, {0x6A, -1}, {0x2B, -1}, {0x2D, -1}, {0x34, -1}, {0x3A, -1}, {0x3C, -1},
+    {0x3D, -1}, {0x74, -1}, {0x22, -1}, {0x3F, -1}, {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x5E, -1},
+    {0x60, -1}, {0x74, -1}, {0x7E, -1}, {0x2F, -1}, {0x4A, -1}, {0x6A, -1}, {0x2B, -1}, {0x34, -1},
+    {0x3C, -1}, {0x3F, -1}, {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x74, -1}, {0x4A, -1}, {0x6A, -1},
+    {0x3F, -1}, {0x54, -1}, {0x59, -1}, {0x5C, -1}, {0x60, -1}, {0x7E, -1}, {0x2C, -1}, {0x2E, -1},
+    {0x2F, -1}, {0x4A, -1}, {0x5F, -1}, {0x6A, -1}, {0x29, -1}, {0x2E, -1}, {0x33, -1}, {0x37, -1},
+    {0x3E, -1}, {0x4A, -1}, {0x5D, -1}, {0x5F, -1}, {0x6A, -1}, {0x2F, -1}, {0x4A, -1}, {0x6A, -1},
+};
+
+const FontAtlas FONT_PROP8 = {bitmaps, glyphs, kerns, 0x20, 0x7E, 1, 8, 0x3F};
@@ -0,0 +1,8 @@
+#pragma once
+
+// Generated by scripts/font_atlas.py from /root/repo/fonts/prop8.bdf; do not edit.
+
+#include "page_canvas.h"
+
+// 8 rows, 95 glyphs 0x20-0x7E
+extern const FontAtlas FONT_PROP8;
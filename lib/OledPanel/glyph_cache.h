@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Glyph Cache (LRU of rasterized glyphs)
+// ===========================================================
+// Slots fixed-size entries, each holding one glyph already in page
+// order, kept on an intrusive recency list: a hit moves the entry to the
+// front, a miss fills a free slot or the least recently used one. Lookup
+// scans the code points linearly, which for a few dozen slots is cheaper
+// than hashing. Not thread safe; one task draws. Pure C++.
+
+struct GlyphCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;     // Filled from the source
+    uint32_t evictions;
+    uint32_t missing;    // Not in the source at all
+    uint16_t slots;
+    uint16_t used;
+};
+
+template <size_t Slots, size_t GlyphBytes>
+class GlyphCache
+{
+    static_assert(Slots > 0 && Slots < 255, "slot links are 8 bit");
+
+public:
+    struct Entry
+    {
+        uint32_t codepoint;
+        uint8_t width;
+        int8_t bearing;
+        uint8_t advance;
+        uint8_t prev;
+        uint8_t next;
+        uint8_t columns[GlyphBytes]; // pages runs of width bytes
+    };
+
+    static constexpr size_t glyph_bytes = GlyphBytes;
+
+    // Cached glyph for codepoint. On a miss fill(Entry &) rasterizes into a
+    // slot; if it returns false the slot stays free and nullptr is returned.
+    template <class Fill>
+    const Entry *get(uint32_t codepoint, Fill fill)
+    {
+        for (uint8_t i = head_; i != NIL; i = entries_[i].next)
+        {
+            if (entries_[i].codepoint == codepoint)
+            {
+                stats_.hits++;
+                touch(i);
+                return &entries_[i];
+            }
+        }
+        uint8_t slot;
+        if (used_ < Slots)
+        {
+            slot = (uint8_t)used_++;
+        }
+        else
+        {
+            slot = tail_;
+            unlink(slot);
+            if (entries_[slot].codepoint != NONE)
+            {
+                stats_.evictions++;
+            }
+        }
+        Entry &e = entries_[slot];
+        e.codepoint = codepoint;
+        if (!fill(e))
+        {
+            // Park the slot at the back, next in line for reuse
+            e.codepoint = NONE;
+            push_back(slot);
+            stats_.missing++;
+            return nullptr;
+        }
+        stats_.misses++;
+        push_front(slot);
+        return &e;
+    }
+
+    void clear()
+    {
+        head_ = tail_ = NIL;
+        used_ = 0;
+    }
+
+    GlyphCacheStats stats() const
+    {
+        GlyphCacheStats s = stats_;
+        s.slots = (uint16_t)Slots;
+        s.used = (uint16_t)used_;
+        return s;
+    }
+
+private:
+    static constexpr uint8_t NIL = 0xFF;
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    void unlink(uint8_t i)
+    {
+        Entry &e = entries_[i];
+        (e.prev == NIL ? head_ : entries_[e.prev].next) = e.next;
+        (e.next == NIL ? tail_ : entries_[e.next].prev) = e.prev;
+    }
+
+    void push_front(uint8_t i)
+    {
+        entries_[i].prev = NIL;
+        entries_[i].next = head_;
+        (head_ == NIL ? tail_ : entries_[head_].prev) = i;
+        head_ = i;
+    }
+
+    void push_back(uint8_t i)
+    {
+        entries_[i].next = NIL;
+        entries_[i].prev = tail_;
+        (tail_ == NIL ? head_ : entries_[tail_].next) = i;
+        tail_ = i;
+    }
+
+    void touch(uint8_t i)
+    {
+        if (i != head_)
+        {
+            unlink(i);
+            push_front(i);
+        }
+    }
+
+    Entry entries_[Slots];
+    uint8_t head_ = NIL;
+    uint8_t tail_ = NIL;
+    size_t used_ = 0;
+    GlyphCacheStats stats_ = {};
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ===========================================================
+// Glyph Store (font partition image)
+// ===========================================================
+// Read-only view of a glyph image built by scripts/font_atlas.py
+// --partition and memory-mapped from the "font" data partition. The
+// image is little-endian:
+//   GlyphStoreHeader
+//   GlyphStoreEntry[count], sorted by code point
+//   bitmaps: per glyph, height rows of (width + 7) / 8 bytes, MSB left,
+//            covering the ink box that starts top rows below the cell top
+// Row-major keeps the image compact; rasterize() turns a glyph into the
+// panel's page order, which is what the glyph cache holds. Pure C++.
+
+static const uint32_t GLYPH_STORE_MAGIC = 0x31464C47; // "GLF1"
+
+struct GlyphStoreHeader
+{
+    uint32_t magic;
+    uint16_t count;
+    uint8_t rows;          // Cell height
+    uint8_t line_height;
+    uint32_t index_offset;
+    uint32_t bitmap_offset;
+    uint32_t size;         // Whole image
+};
+
+struct GlyphStoreEntry
+{
+    uint32_t codepoint;
+    uint32_t offset;       // From bitmap_offset
+    uint8_t width;         // Ink columns
+    uint8_t height;        // Ink rows
+    uint8_t top;           // Cell row of the first ink row
+    uint8_t advance;
+    int8_t bearing;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(GlyphStoreHeader) == 20, "header layout is shared with font_atlas.py");
+static_assert(sizeof(GlyphStoreEntry) == 16, "entry layout is shared with font_atlas.py");
+
+class GlyphStore
+{
+public:
+    // Validate and adopt a mapped image; false leaves the store empty
+    bool attach(const uint8_t *image, size_t size)
+    {
+        header_ = nullptr;
+        if (!image || size < sizeof(GlyphStoreHeader))
+        {
+            return false;
+        }
+        const GlyphStoreHeader *h = (const GlyphStoreHeader *)image;
+        if (h->magic != GLYPH_STORE_MAGIC || h->size > size || h->index_offset % 4 ||
+            h->index_offset + (size_t)h->count * sizeof(GlyphStoreEntry) > h->bitmap_offset ||
+            h->bitmap_offset > h->size)
+        {
+            return false;
+        }
+        image_ = image;
+        header_ = h;
+        entries_ = (const GlyphStoreEntry *)(image + h->index_offset);
+        return true;
+    }
+
+    bool attached() const { return header_ != nullptr; }
+    uint16_t count() const { return header_ ? header_->count : 0; }
+    uint8_t rows() const { return header_ ? header_->rows : 0; }
+
+    const GlyphStoreEntry *find(uint32_t codepoint) const
+    {
+        if (!header_)
+        {
+            return nullptr;
+        }
+        size_t lo = 0, hi = header_->count;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            uint32_t cp = entries_[mid].codepoint;
+            if (cp == codepoint)
+            {
+                return &entries_[mid];
+            }
+            if (cp < codepoint)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return nullptr;
+    }
+
+    // Write the glyph as pages runs of width bytes (framebuffer order,
+    // LSB on top) into out; false if it does not fit in out_size bytes or
+    // its bitmap lies outside the image. Rows below the last page are cut.
+    bool rasterize(const GlyphStoreEntry &e, uint8_t pages, uint8_t *out, size_t out_size) const
+    {
+        size_t row_bytes = (e.width + 7u) / 8u;
+        size_t need = (size_t)pages * e.width;
+        if (need > out_size || header_->bitmap_offset + e.offset + row_bytes * e.height > header_->size)
+        {
+            return false;
+        }
+        memset(out, 0, need);
+        const uint8_t *src = image_ + header_->bitmap_offset + e.offset;
+        for (uint8_t r = 0; r < e.height; r++, src += row_bytes)
+        {
+            unsigned row = e.top + r;
+            if (row >= pages * 8u)
+            {
+                break;
+            }
+            uint8_t *run = out + (row >> 3) * e.width;
+            uint8_t bit = (uint8_t)(1u << (row & 7));
+            for (uint8_t x = 0; x < e.width; x++)
+            {
+                if (src[x >> 3] & (0x80 >> (x & 7)))
+                {
+                    run[x] |= bit;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    const uint8_t *image_ = nullptr;
+    const GlyphStoreHeader *header_ = nullptr;
+    const GlyphStoreEntry *entries_ = nullptr;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ===========================================================
+// OLED Panel Layer (compile-time controller and geometry)
+// ===========================================================
+// A panel is OledPanel<Controller, Geometry, Transport>:
+//   Geometry   fixes the framebuffer size and page math
+//   Controller supplies the init sequence and frame addressing
+//   Transport  moves command and data bytes over the bus
+// All three are resolved at compile time, so drawing and flushing
+// compile to the same straight loops for every panel. Pure C++; builds
+// on the host, where NullTransport stands in for the bus.
+//
+// The framebuffer uses the controllers' native page order: byte
+// page * width + x holds rows page*8 .. page*8+7 of column x, LSB on top.
+//
+// Transport contract:
+//   bool begin();
+//   bool command(const uint8_t *bytes, size_t len); // Control byte 0x00
+//   bool data(const uint8_t *bytes, size_t len);    // Control byte 0x40, any length
+//   // Addressing commands followed by data; a transport that can sends
+//   // both in one bus transaction (Co=1 command pairs, then 0x40 + data)
+//   bool write(const uint8_t *cmds, size_t cmd_len, const uint8_t *data, size_t data_len);
+//
+// Controllers never address with more than OLED_MAX_ADDRESS_COMMANDS bytes.
+static const size_t OLED_MAX_ADDRESS_COMMANDS = 8;
+
+template <uint8_t W, uint8_t H>
+struct PanelGeometry
+{
+    static_assert(W > 0 && W <= 128, "SSD1306 and SH1106 drive at most 128 columns");
+    static_assert(H == 32 || H == 64, "supported heights are 32 and 64 rows");
+
+    static constexpr uint8_t width = W;
+    static constexpr uint8_t height = H;
+    static constexpr uint8_t pages = H / 8;
+    static constexpr size_t buffer_size = (size_t)W * pages;
+
+    static constexpr size_t index(uint8_t x, uint8_t y) { return (size_t)(y >> 3) * W + x; }
+    static constexpr uint8_t bit(uint8_t y) { return (uint8_t)(1u << (y & 7)); }
+};
+
+typedef PanelGeometry<128, 32> Panel128x32;
+typedef PanelGeometry<128, 64> Panel128x64;
+
+// ===========================================================
+// Controllers
+// ===========================================================
+// SSD1306: horizontal addressing, so any run of pages is one window and
+// one contiguous data stream
+struct Ssd1306
+{
+    static constexpr const char *name = "ssd1306";
+
+    template <class G, class T>
+    static bool init(T &transport)
+    {
+        const uint8_t sequence[] = {
+            0xAE,                            // Display off
+            0xD5, 0x80,                      // Clock divide ratio
+            0xA8, (uint8_t)(G::height - 1),  // Multiplex
+            0xD3, 0x00,                      // Display offset
+            0x40,                            // Start line 0
+            0x8D, 0x14,                      // Charge pump on
+            0x20, 0x00,                      // Horizontal addressing
+            0xA1, 0xC8,                      // Segment remap, COM scan descending
+            0xDA, G::height == 64 ? (uint8_t)0x12 : (uint8_t)0x02, // COM pins
+            0x81, G::height == 64 ? (uint8_t)0xCF : (uint8_t)0x8F, // Contrast
+            0xD9, 0xF1,                      // Pre-charge
+            0xDB, 0x40,                      // VCOMH deselect
+            0xA4, 0xA6,                      // Resume from RAM, normal polarity
+            0x2E,                            // Scrolling off
+            0xAF,                            // Display on
+        };
+        return transport.command(sequence, sizeof(sequence));
+    }
+
+    template <class G, class T>
+    static bool write_pages(T &transport, const uint8_t *buffer, uint8_t first, uint8_t last)
+    {
+        const uint8_t window[] = {0x21, 0, (uint8_t)(G::width - 1), 0x22, first, last};
+        return transport.write(window, sizeof(window), buffer + (size_t)first * G::width,
+                               (size_t)(last - first + 1) * G::width);
+    }
+};
+
+// SH1106: 132-column RAM with the glass on columns 2..129 and page
+// addressing only, so every page is addressed and written on its own
+struct Sh1106
+{
+    static constexpr const char *name = "sh1106";
+    static constexpr uint8_t column_offset = 2;
+
+    template <class G, class T>
+    static bool init(T &transport)
+    {
+        const uint8_t sequence[] = {
+            0xAE,                            // Display off
+            0xD5, 0x80,                      // Clock divide ratio
+            0xA8, (uint8_t)(G::height - 1),  // Multiplex
+            0xD3, 0x00,                      // Display offset
+            0x40,                            // Start line 0
+            0xAD, 0x8B,                      // DC-DC converter on
+            0xA1, 0xC8,                      // Segment remap, COM scan descending
+            0xDA, G::height == 64 ? (uint8_t)0x12 : (uint8_t)0x02, // COM pins
+            0x81, 0x80,                      // Contrast
+            0xD9, 0x22,                      // Pre-charge
+            0xDB, 0x35,                      // VCOM deselect
+            0xA4, 0xA6,                      // Resume from RAM, normal polarity
+            0xAF,                            // Display on
+        };
+        return transport.command(sequence, sizeof(sequence));
+    }
+
+    template <class G, class T>
+    static bool write_pages(T &transport, const uint8_t *buffer, uint8_t first, uint8_t last)
+    {
+        for (uint8_t page = first; page <= last; page++)
+        {
+            const uint8_t address[] = {(uint8_t)(0xB0 | page), (uint8_t)(column_offset & 0x0F),
+                                       (uint8_t)(0x10 | (column_offset >> 4))};
+            if (!transport.write(address, sizeof(address), buffer + (size_t)page * G::width, G::width))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// ===========================================================
+// Null Transport (headless runs)
+// ===========================================================
+// Accepts everything and counts what a real bus would have carried, so
+// rendering can be timed without a panel attached
+struct NullTransport
+{
+    uint32_t command_bytes = 0;
+    uint32_t data_bytes = 0;
+    uint32_t writes = 0;
+
+    bool begin() { return true; }
+
+    bool command(const uint8_t *, size_t len)
+    {
+        command_bytes += len;
+        writes++;
+        return true;
+    }
+
+    bool data(const uint8_t *, size_t len)
+    {
+        data_bytes += len;
+        writes++;
+        return true;
+    }
+
+    bool write(const uint8_t *, size_t cmd_len, const uint8_t *, size_t data_len)
+    {
+        command_bytes += cmd_len;
+        data_bytes += data_len;
+        writes++;
+        return true;
+    }
+};
+
+// ===========================================================
+// Panel
+// ===========================================================
+template <class Controller, class Geometry, class Transport>
+class OledPanel
+{
+public:
+    typedef Geometry geometry;
+    typedef Controller controller;
+
+    explicit OledPanel(const Transport &transport = Transport()) : transport_(transport) { clear(); }
+
+    bool begin() { return transport_.begin() && Controller::template init<Geometry>(transport_); }
+
+    // Push pages first..last (inclusive) of the framebuffer
+    bool flush_pages(uint8_t first, uint8_t last)
+    {
+        if (first > last || last >= Geometry::pages)
+        {
+            return false;
+        }
+        return Controller::template write_pages<Geometry>(transport_, buffer_, first, last);
+    }
+
+    bool flush() { return flush_pages(0, Geometry::pages - 1); }
+
+    bool command(uint8_t cmd) { return transport_.command(&cmd, 1); }
+
+    void clear() { memset(buffer_, 0, sizeof(buffer_)); }
+
+    void set_pixel(int x, int y, bool on)
+    {
+        if ((unsigned)x >= Geometry::width || (unsigned)y >= Geometry::height)
+        {
+            return;
+        }
+        uint8_t &cell = buffer_[Geometry::index((uint8_t)x, (uint8_t)y)];
+        cell = on ? (uint8_t)(cell | Geometry::bit((uint8_t)y)) : (uint8_t)(cell & ~Geometry::bit((uint8_t)y));
+    }
+
+    uint8_t *buffer() { return buffer_; }
+    const uint8_t *buffer() const { return buffer_; }
+    Transport &transport() { return transport_; }
+
+private:
+    Transport transport_;
+    // Word aligned so renderers may work on it 32 bits at a time
+    alignas(4) uint8_t buffer_[Geometry::buffer_size];
+};
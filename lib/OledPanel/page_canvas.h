@@ -0,0 +1,539 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "utf8.h"
+
+// ===========================================================
+// Page Canvas (drawing on the page-ordered framebuffer)
+// ===========================================================
+// Primitives work on whole framebuffer bytes instead of single pixels:
+// a glyph column of up to 8 rows is one byte, OR'ed into one page or,
+// when y is not page aligned, shifted across two. Rectangles are a byte
+// mask per page applied 32 bits at a time. Each primitive clips once up
+// front; the inner loops never test bounds. Pure C++ over the buffer of
+// an OledPanel with geometry G.
+
+// Column-major 1bpp glyphs, LSB on top, all in one fixed cell
+struct FixedFont
+{
+    const uint8_t *bitmaps; // width bytes per glyph, first..last
+    uint8_t first;
+    uint8_t last;
+    uint8_t width;
+    uint8_t advance;        // Cell width including spacing
+    uint8_t line_height;
+};
+
+// Proportional glyphs pre-rasterized by scripts/font_atlas.py. A glyph
+// is pages runs of width bytes, each run already in framebuffer order,
+// so drawing one is a copy per page with no per-pixel work.
+struct AtlasGlyph
+{
+    uint16_t offset;     // First bitmap byte
+    uint8_t width;       // Ink columns; 0 for blank glyphs
+    int8_t bearing;      // Pen position to the first ink column
+    uint8_t advance;
+    uint8_t kern_count;  // Pairs with this glyph on the left,
+    uint16_t kern_first; // starting at kerns[kern_first]
+};
+
+struct AtlasKern
+{
+    uint8_t right;
+    int8_t adjust;
+};
+
+struct FontAtlas
+{
+    const uint8_t *bitmaps;
+    const AtlasGlyph *glyphs; // first..last
+    const AtlasKern *kerns;
+    uint8_t first;
+    uint8_t last;
+    uint8_t pages;
+    uint8_t line_height;
+    uint8_t fallback;         // Drawn for codes outside first..last
+};
+
+inline const AtlasGlyph &atlas_glyph(const FontAtlas &font, uint8_t c)
+{
+    if (c < font.first || c > font.last)
+    {
+        c = font.fallback;
+    }
+    return font.glyphs[c - font.first];
+}
+
+// Pen advance after glyph when next follows, kerning included. A glyph's
+// pairs are sorted by right glyph, so the scan stops early
+inline int atlas_advance(const FontAtlas &font, const AtlasGlyph &glyph, uint8_t next)
+{
+    const AtlasKern *kern = font.kerns + glyph.kern_first;
+    for (uint8_t i = 0; i < glyph.kern_count && kern[i].right <= next; i++)
+    {
+        if (kern[i].right == next)
+        {
+            return glyph.advance + kern[i].adjust;
+        }
+    }
+    return glyph.advance;
+}
+
+// A glyph ready to draw, from an atlas or a cache: pages runs of width
+// bytes in framebuffer order. atlas is set for atlas glyphs, whose
+// kerning pairs then apply.
+struct GlyphRef
+{
+    const uint8_t *columns;
+    const AtlasGlyph *atlas;
+    uint8_t width;
+    int8_t bearing;
+    uint8_t advance;
+};
+
+// Framebuffer bytes are read and written as words; may_alias keeps that
+// well defined under strict aliasing
+typedef uint32_t __attribute__((may_alias)) PageWord;
+
+enum class PaintMode : uint8_t
+{
+    Set,
+    Clear,
+    Invert
+};
+
+template <class G>
+class PageCanvas
+{
+public:
+    explicit PageCanvas(uint8_t *buffer) : buffer_(buffer) {}
+
+    void clear() { memset(buffer_, 0, G::buffer_size); }
+
+    void fill_rect(int x, int y, int w, int h, PaintMode mode = PaintMode::Set)
+    {
+        if (!clip(x, y, w, h))
+        {
+            return;
+        }
+        int last_row = y + h - 1;
+        for (int page = y >> 3; page <= (last_row >> 3); page++)
+        {
+            int top = page * 8 > y ? 0 : y & 7;
+            int bottom = page * 8 + 7 < last_row ? 7 : last_row & 7;
+            uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+            apply_span(buffer_ + page * G::width + x, (size_t)w, mask, mode);
+        }
+    }
+
+    void invert_rect(int x, int y, int w, int h) { fill_rect(x, y, w, h, PaintMode::Invert); }
+
+    // OR w column bytes (8 rows each, LSB on top) into the buffer at any
+    // x and y, partly off-panel included
+    void blit_columns(int x, int y, const uint8_t *columns, int w) { draw_columns(x, y, columns, w); }
+
+    // Draw text in a fixed font, wrapping at the right edge like
+    // Adafruit_GFX; x and y are left at the pen position after the text
+    void draw_text(const FixedFont &font, int &x, int &y, const char *text, bool wrap = true)
+    {
+        for (const char *p = text; *p; p++)
+        {
+            uint8_t c = (uint8_t)*p;
+            if (c == '\n')
+            {
+                x = 0;
+                y += font.line_height;
+                continue;
+            }
+            if (c == '\r')
+            {
+                continue;
+            }
+            if (wrap && x + font.advance > G::width)
+            {
+                x = 0;
+                y += font.line_height;
+            }
+            if (c >= font.first && c <= font.last)
+            {
+                draw_columns(x, y, font.bitmaps + (size_t)(c - font.first) * font.width, font.width);
+            }
+            x += font.advance;
+        }
+    }
+
+    // Same for an atlas font: wrapping happens when a glyph's ink would
+    // cross the right edge
+    void draw_text(const FontAtlas &font, int &x, int &y, const char *text, bool wrap = true)
+    {
+        for (const char *p = text; *p; p++)
+        {
+            uint8_t c = (uint8_t)*p;
+            if (c == '\n')
+            {
+                x = 0;
+                y += font.line_height;
+                continue;
+            }
+            if (c == '\r')
+            {
+                continue;
+            }
+            const AtlasGlyph &glyph = atlas_glyph(font, c);
+            if (wrap && x > 0 && x + glyph.bearing + glyph.width > G::width)
+            {
+                x = 0;
+                y += font.line_height;
+            }
+            draw_glyph(font, glyph, x, y);
+            x += atlas_advance(font, glyph, (uint8_t)p[1]);
+        }
+    }
+
+    // Copy one atlas glyph with its pen at (x, y)
+    void draw_glyph(const FontAtlas &font, const AtlasGlyph &glyph, int x, int y)
+    {
+        const uint8_t *run = font.bitmaps + glyph.offset;
+        for (uint8_t page = 0; page < font.pages; page++, run += glyph.width)
+        {
+            draw_columns(x + glyph.bearing, y + page * 8, run, glyph.width);
+        }
+    }
+
+    // UTF-8 text through a font object providing
+    //   uint8_t pages(); uint8_t line_height();
+    //   GlyphRef glyph(uint32_t codepoint);
+    //   int advance(const GlyphRef &glyph, uint32_t next_codepoint);
+    // Each glyph is drawn before the next is looked up, so a font may hand
+    // out references into a cache it recycles.
+    template <class Font>
+    void draw_utf8(Font &font, int &x, int &y, const char *text, bool wrap = true)
+    {
+        const char *p = text;
+        uint32_t cp = *p ? utf8_next(p) : 0;
+        while (cp)
+        {
+            uint32_t next = *p ? utf8_next(p) : 0;
+            if (cp == '\n')
+            {
+                x = 0;
+                y += font.line_height();
+            }
+            else if (cp != '\r')
+            {
+                GlyphRef glyph = font.glyph(cp);
+                if (wrap && x > 0 && x + glyph.bearing + glyph.width > G::width)
+                {
+                    x = 0;
+                    y += font.line_height();
+                }
+                draw_glyph(glyph, font.pages(), x, y);
+                x += font.advance(glyph, next);
+            }
+            cp = next;
+        }
+    }
+
+    void draw_glyph(const GlyphRef &glyph, uint8_t pages, int x, int y)
+    {
+        const uint8_t *run = glyph.columns;
+        for (uint8_t page = 0; page < pages; page++, run += glyph.width)
+        {
+            draw_columns(x + glyph.bearing, y + page * 8, run, glyph.width);
+        }
+    }
+
+    // One line of len bytes of UTF-8 at an integer scale, no wrapping;
+    // newlines are skipped
+    template <class Font>
+    void draw_line(Font &font, int x, int y, const char *text, size_t len, uint8_t scale)
+    {
+        const char *end = text + len;
+        const char *p = text;
+        uint32_t cp = p < end ? utf8_next(p) : 0;
+        while (cp)
+        {
+            uint32_t next = p < end ? utf8_next(p) : 0;
+            if (cp != '\n' && cp != '\r')
+            {
+                GlyphRef glyph = font.glyph(cp);
+                draw_scaled(glyph, font.pages(), x, y, scale);
+                x += font.advance(glyph, next) * scale;
+            }
+            cp = next;
+        }
+    }
+
+    // Each source pixel becomes a scale x scale block; columns are widened
+    // into one 64-bit strip and written a page at a time
+    void draw_scaled(const GlyphRef &glyph, uint8_t pages, int x, int y, uint8_t scale)
+    {
+        if (scale <= 1)
+        {
+            draw_glyph(glyph, pages, x, y);
+            return;
+        }
+        const uint64_t block = (1ull << scale) - 1;
+        int rows = pages * 8;
+        x += glyph.bearing * scale;
+        for (uint8_t i = 0; i < glyph.width; i++)
+        {
+            uint64_t strip = 0;
+            for (int r = 0; r < rows && (r + 1) * scale <= 64; r++)
+            {
+                if (glyph.columns[(r >> 3) * glyph.width + i] & (1u << (r & 7)))
+                {
+                    strip |= block << (r * scale);
+                }
+            }
+            for (uint8_t dx = 0; dx < scale; dx++)
+            {
+                draw_strip(x + i * scale + dx, y, strip);
+            }
+        }
+    }
+
+    // Width and height the text would cover from (0, 0), wrapping included
+    static void measure_text(const FixedFont &font, const char *text, int &w, int &h, bool wrap = true)
+    {
+        int x = 0, y = 0, max_x = 0;
+        bool any = false;
+        for (const char *p = text; *p; p++)
+        {
+            if (*p == '\n')
+            {
+                x = 0;
+                y += font.line_height;
+                continue;
+            }
+            if (*p == '\r')
+            {
+                continue;
+            }
+            if (wrap && x + font.advance > G::width)
+            {
+                x = 0;
+                y += font.line_height;
+            }
+            x += font.advance;
+            max_x = x > max_x ? x : max_x;
+            any = true;
+        }
+        // The spacing column after the last glyph is not ink
+        w = any ? max_x - (font.advance - font.width) : 0;
+        h = any ? y + font.line_height : 0;
+    }
+
+    static void measure_text(const FontAtlas &font, const char *text, int &w, int &h, bool wrap = true)
+    {
+        int x = 0, y = 0, max_x = 0;
+        bool any = false;
+        for (const char *p = text; *p; p++)
+        {
+            uint8_t c = (uint8_t)*p;
+            if (c == '\n')
+            {
+                x = 0;
+                y += font.line_height;
+                continue;
+            }
+            if (c == '\r')
+            {
+                continue;
+            }
+            const AtlasGlyph &glyph = atlas_glyph(font, c);
+            if (wrap && x > 0 && x + glyph.bearing + glyph.width > G::width)
+            {
+                x = 0;
+                y += font.line_height;
+            }
+            int right = x + glyph.bearing + glyph.width;
+            max_x = right > max_x ? right : max_x;
+            x += atlas_advance(font, glyph, (uint8_t)p[1]);
+            any = true;
+        }
+        w = max_x;
+        h = any ? y + font.line_height : 0;
+    }
+
+    template <class Font>
+    static void measure_utf8(Font &font, const char *text, int &w, int &h, bool wrap = true)
+    {
+        int x = 0, y = 0, max_x = 0;
+        bool any = false;
+        const char *p = text;
+        uint32_t cp = *p ? utf8_next(p) : 0;
+        while (cp)
+        {
+            uint32_t next = *p ? utf8_next(p) : 0;
+            if (cp == '\n')
+            {
+                x = 0;
+                y += font.line_height();
+            }
+            else if (cp != '\r')
+            {
+                GlyphRef glyph = font.glyph(cp);
+                if (wrap && x > 0 && x + glyph.bearing + glyph.width > G::width)
+                {
+                    x = 0;
+                    y += font.line_height();
+                }
+                int right = x + glyph.bearing + glyph.width;
+                max_x = right > max_x ? right : max_x;
+                x += font.advance(glyph, next);
+                any = true;
+            }
+            cp = next;
+        }
+        w = max_x;
+        h = any ? y + font.line_height() : 0;
+    }
+
+    uint8_t *buffer() { return buffer_; }
+
+private:
+    // Trim the rectangle to the panel; false if nothing is left
+    static bool clip(int &x, int &y, int &w, int &h)
+    {
+        if (x < 0)
+        {
+            w += x;
+            x = 0;
+        }
+        if (y < 0)
+        {
+            h += y;
+            y = 0;
+        }
+        if (x + w > G::width)
+        {
+            w = G::width - x;
+        }
+        if (y + h > G::height)
+        {
+            h = G::height - y;
+        }
+        return w > 0 && h > 0;
+    }
+
+    // Clipped once: the column range is trimmed, and rows falling off the
+    // top or bottom shift out of the byte or land on a page that is skipped
+    void draw_columns(int x, int y, const uint8_t *columns, int w)
+    {
+        if (y <= -8 || y >= G::height || x >= G::width || x + w <= 0)
+        {
+            return;
+        }
+        if (x < 0)
+        {
+            columns -= x;
+            w += x;
+            x = 0;
+        }
+        if (x + w > G::width)
+        {
+            w = G::width - x;
+        }
+        int page = y >> 3; // Arithmetic shift: -1 for y in -7..-1
+        int shift = y & 7;
+        uint8_t *upper = page >= 0 ? buffer_ + page * G::width + x : nullptr;
+        uint8_t *lower = shift && page + 1 < G::pages ? buffer_ + (page + 1) * G::width + x : nullptr;
+        if (upper && !shift)
+        {
+            for (int i = 0; i < w; i++)
+            {
+                upper[i] |= columns[i];
+            }
+            return;
+        }
+        if (upper)
+        {
+            for (int i = 0; i < w; i++)
+            {
+                upper[i] |= (uint8_t)(columns[i] << shift);
+            }
+        }
+        if (lower)
+        {
+            for (int i = 0; i < w; i++)
+            {
+                lower[i] |= (uint8_t)(columns[i] >> (8 - shift));
+            }
+        }
+    }
+
+    // OR a column of up to 64 rows (bit 0 at row y) into column x
+    void draw_strip(int x, int y, uint64_t strip)
+    {
+        if (x < 0 || x >= G::width || !strip)
+        {
+            return;
+        }
+        for (int page = 0; page < G::pages; page++)
+        {
+            int shift = page * 8 - y;
+            if (shift >= 64 || shift <= -8)
+            {
+                continue;
+            }
+            buffer_[page * G::width + x] |= (uint8_t)(shift >= 0 ? strip >> shift : strip << -shift);
+        }
+    }
+
+    // Apply mask to len bytes at p: byte steps up to a word boundary, then
+    // whole 32-bit words, then the tail
+    static void apply_span(uint8_t *p, size_t len, uint8_t mask, PaintMode mode)
+    {
+        if (mask == 0xFF && mode != PaintMode::Invert)
+        {
+            memset(p, mode == PaintMode::Set ? 0xFF : 0x00, len);
+            return;
+        }
+        uint32_t wide = mask * 0x01010101u;
+        while (len && ((uintptr_t)p & 3))
+        {
+            apply_byte(*p++, mask, mode);
+            len--;
+        }
+        PageWord *words = (PageWord *)p;
+        size_t count = len / 4;
+        switch (mode)
+        {
+        case PaintMode::Set:
+            for (size_t i = 0; i < count; i++)
+            {
+                words[i] |= wide;
+            }
+            break;
+        case PaintMode::Clear:
+            for (size_t i = 0; i < count; i++)
+            {
+                words[i] &= ~wide;
+            }
+            break;
+        case PaintMode::Invert:
+            for (size_t i = 0; i < count; i++)
+            {
+                words[i] ^= wide;
+            }
+            break;
+        }
+        p += count * 4;
+        len -= count * 4;
+        while (len--)
+        {
+            apply_byte(*p++, mask, mode);
+        }
+    }
+
+    static void apply_byte(uint8_t &b, uint8_t mask, PaintMode mode)
+    {
+        b = mode == PaintMode::Set ? (uint8_t)(b | mask)
+                                   : mode == PaintMode::Clear ? (uint8_t)(b & ~mask) : (uint8_t)(b ^ mask);
+    }
+
+    uint8_t *buffer_;
+};
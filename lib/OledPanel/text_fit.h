@@ -0,0 +1,319 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "page_canvas.h"
+
+// ===========================================================
+// Auto-fit Text Layout
+// ===========================================================
+// Finds the largest integer text scale at which a message, word-wrapped,
+// fits the panel, and the line breaks at that scale. Each glyph's advance
+// and ink extent are measured once per message; every probe of the
+// binary search over scales then works on those numbers alone. Fitting
+// is monotonic (a smaller scale has more room per line and more lines),
+// which is what makes the binary search valid.
+//
+// At scale 1, words too wide for a line are broken between glyphs and
+// lines past the bottom are dropped, so every message gets a layout.
+// Layouts are cached by message: a 64-bit FNV-1a hash and the length pick
+// candidates, and the bytes that were laid out confirm the match, so a
+// hash collision never draws another message's layout. A repeated
+// message is drawn without measuring or searching. Pure C++; not
+// thread-safe, the caller serializes access.
+
+static const size_t TEXT_FIT_MAX_LINES = 8;   // 64-row panel at scale 1
+static const size_t TEXT_FIT_MAX_GLYPHS = 64; // Glyphs past this are not laid out
+static const size_t TEXT_FIT_MAX_BYTES = 255; // Nor are bytes past this
+
+struct FitLine
+{
+    uint8_t start;  // Byte offset into the message
+    uint8_t length; // Bytes
+    uint8_t width;  // Ink width at scale 1
+};
+
+struct TextLayout
+{
+    uint8_t scale;
+    uint8_t line_count;
+    FitLine lines[TEXT_FIT_MAX_LINES];
+};
+
+struct LayoutCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t probes;    // Scales tried by the search on misses
+};
+
+// 64-bit FNV-1a over the whole message; length is set to its strlen
+inline uint64_t text_hash(const char *text, size_t &length)
+{
+    uint64_t h = 14695981039346656037ull;
+    size_t n = 0;
+    for (; text[n]; n++)
+    {
+        h = (h ^ (uint8_t)text[n]) * 1099511628211ull;
+    }
+    length = n;
+    return h;
+}
+
+template <class G>
+class TextFitter
+{
+public:
+    // Lay text out with font (see PageCanvas::draw_utf8 for the font API)
+    template <class Font>
+    static void fit(Font &font, const char *text, TextLayout &out, uint32_t &probes)
+    {
+        Metrics m;
+        measure(font, text, m);
+        uint8_t line_height = font.line_height();
+        int lo = 1;
+        int hi = G::height / line_height;
+        hi = hi < 1 ? 1 : hi;
+        // Invariant: scale lo fits (1 always does, by breaking words)
+        while (lo < hi)
+        {
+            int mid = (lo + hi + 1) / 2;
+            probes++;
+            if (wrap(m, mid, line_height, nullptr))
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid - 1;
+            }
+        }
+        out.scale = (uint8_t)lo;
+        wrap(m, lo, line_height, &out);
+    }
+
+    // Draw a fitted layout centered on the panel
+    template <class Font>
+    static void draw(PageCanvas<G> &canvas, Font &font, const char *text, const TextLayout &layout)
+    {
+        int step = font.line_height() * layout.scale;
+        int y = ((int)G::height - step * layout.line_count) / 2;
+        for (uint8_t i = 0; i < layout.line_count; i++, y += step)
+        {
+            const FitLine &line = layout.lines[i];
+            int x = ((int)G::width - line.width * layout.scale) / 2;
+            canvas.draw_line(font, x, y, text + line.start, line.length, layout.scale);
+        }
+    }
+
+private:
+    struct Metrics
+    {
+        uint8_t count;
+        uint8_t start[TEXT_FIT_MAX_GLYPHS];   // Byte offset of each glyph
+        uint8_t advance[TEXT_FIT_MAX_GLYPHS]; // Kerning to the next glyph included
+        uint8_t ink[TEXT_FIT_MAX_GLYPHS];     // Pen to the right edge of the ink
+        uint8_t kind[TEXT_FIT_MAX_GLYPHS];    // Glyph, Space or Newline
+        uint8_t end;                          // Byte offset after the last glyph
+    };
+
+    enum : uint8_t
+    {
+        Glyph,
+        Space,
+        Newline
+    };
+
+    template <class Font>
+    static void measure(Font &font, const char *text, Metrics &m)
+    {
+        m.count = 0;
+        const char *p = text;
+        const char *at = p;
+        uint32_t cp = *p ? utf8_next(p) : 0;
+        while (cp && m.count < TEXT_FIT_MAX_GLYPHS && (size_t)(at - text) <= TEXT_FIT_MAX_BYTES &&
+               (size_t)(p - text) <= TEXT_FIT_MAX_BYTES)
+        {
+            const char *next_at = p;
+            uint32_t next = *p ? utf8_next(p) : 0;
+            uint8_t i = m.count++;
+            m.start[i] = (uint8_t)(at - text);
+            if (cp == '\n' || cp == '\r')
+            {
+                m.kind[i] = cp == '\n' ? Newline : Space;
+                m.advance[i] = 0;
+                m.ink[i] = 0;
+            }
+            else
+            {
+                GlyphRef glyph = font.glyph(cp);
+                int advance = font.advance(glyph, next);
+                int ink = glyph.bearing + glyph.width;
+                m.kind[i] = cp == ' ' ? Space : Glyph;
+                m.advance[i] = (uint8_t)(advance < 0 ? 0 : advance);
+                m.ink[i] = (uint8_t)(ink < 0 ? 0 : ink);
+            }
+            at = next_at;
+            cp = next;
+        }
+        m.end = (uint8_t)(at - text);
+    }
+
+    static uint8_t byte_end(const Metrics &m, uint8_t i) { return i < m.count ? m.start[i] : m.end; }
+
+    // Greedy word wrap at scale; false if a word must be broken or the
+    // lines overflow (scale 1 breaks and truncates instead). Fills out
+    // when given.
+    static bool wrap(const Metrics &m, int scale, uint8_t line_height, TextLayout *out)
+    {
+        const int max_width = G::width / scale;
+        int max_lines = G::height / (line_height * scale);
+        max_lines = max_lines > (int)TEXT_FIT_MAX_LINES ? (int)TEXT_FIT_MAX_LINES : max_lines;
+        const bool last_resort = scale == 1;
+        int lines = 0;
+        uint8_t i = 0;
+        while (i < m.count)
+        {
+            // Spaces at the start of a wrapped line are dropped
+            while (i < m.count && m.kind[i] == Space)
+            {
+                i++;
+            }
+            if (i == m.count)
+            {
+                break;
+            }
+            uint8_t first = i;
+            uint8_t last = i;       // One past the last glyph drawn on the line
+            int width = 0;          // Ink width up to last
+            int pen = 0;
+            uint8_t word_first = i; // First glyph of the current word
+            uint8_t kept_last = i;  // last and width before the current word
+            int kept_width = 0;
+            while (i < m.count && m.kind[i] != Newline)
+            {
+                if (m.kind[i] == Space)
+                {
+                    pen += m.advance[i++];
+                    word_first = i;
+                    kept_last = last;
+                    kept_width = width;
+                    continue;
+                }
+                if (pen + m.ink[i] > max_width)
+                {
+                    if (word_first > first)
+                    {
+                        // Move the whole word to the next line
+                        i = word_first;
+                        last = kept_last;
+                        width = kept_width;
+                    }
+                    else if (!last_resort)
+                    {
+                        return false;
+                    }
+                    else if (i == first)
+                    {
+                        // Not even one glyph fits; take it anyway
+                        width = m.ink[i];
+                        last = ++i;
+                    }
+                    break;
+                }
+                width = pen + m.ink[i];
+                pen += m.advance[i++];
+                last = i;
+            }
+            if (i < m.count && m.kind[i] == Newline)
+            {
+                i++;
+            }
+            if (lines == max_lines)
+            {
+                return last_resort;
+            }
+            if (out)
+            {
+                FitLine &line = out->lines[lines];
+                line.start = byte_end(m, first);
+                line.length = (uint8_t)(byte_end(m, last) - line.start);
+                line.width = (uint8_t)(width > 255 ? 255 : width);
+                out->line_count = (uint8_t)(lines + 1);
+            }
+            lines++;
+        }
+        if (out && lines == 0)
+        {
+            out->line_count = 0;
+        }
+        return true;
+    }
+};
+
+// Recently fitted layouts; the oldest is replaced when full. Each entry
+// keeps the bytes its layout was fitted to (TEXT_FIT_MAX_BYTES and the
+// kerning lookahead past them: all a layout depends on) and find()
+// compares them after the hash.
+template <size_t Slots>
+class LayoutCache
+{
+public:
+    // hash and length as returned by text_hash(text, length)
+    const TextLayout *find(const char *text, size_t length, uint64_t hash)
+    {
+        size_t kept = length < KEY_BYTES ? length : KEY_BYTES;
+        for (size_t i = 0; i < used_; i++)
+        {
+            Entry &e = entries_[i];
+            if (e.hash == hash && e.length == length && memcmp(e.text, text, kept) == 0)
+            {
+                e.stamp = ++clock_;
+                stats_.hits++;
+                return &e.layout;
+            }
+        }
+        stats_.misses++;
+        return nullptr;
+    }
+
+    TextLayout &insert(const char *text, size_t length, uint64_t hash)
+    {
+        const bool full = used_ == Slots;
+        size_t slot = full ? 0 : used_++;
+        for (size_t i = 1; full && i < Slots; i++)
+        {
+            if (entries_[i].stamp < entries_[slot].stamp)
+            {
+                slot = i;
+            }
+        }
+        Entry &e = entries_[slot];
+        e.stamp = ++clock_;
+        e.hash = hash;
+        e.length = length;
+        memcpy(e.text, text, length < KEY_BYTES ? length : KEY_BYTES);
+        return e.layout;
+    }
+
+    void count_probes(uint32_t probes) { stats_.probes += probes; }
+    LayoutCacheStats stats() const { return stats_; }
+
+private:
+    static const size_t KEY_BYTES = TEXT_FIT_MAX_BYTES + 4; // One UTF-8 sequence of lookahead
+
+    struct Entry
+    {
+        TextLayout layout;
+        uint64_t hash;
+        size_t length;
+        uint32_t stamp;
+        char text[KEY_BYTES];
+    };
+
+    Entry entries_[Slots];
+    size_t used_ = 0;
+    uint32_t clock_ = 0;
+    LayoutCacheStats stats_ = {};
+};
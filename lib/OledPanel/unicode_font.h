@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "page_canvas.h"
+#include "glyph_store.h"
+#include "glyph_cache.h"
+
+// ===========================================================
+// Unicode Font (atlas + glyph store + LRU cache)
+// ===========================================================
+// Font object for PageCanvas::draw_utf8. Code points inside the atlas
+// range come straight from the flash atlas; everything else is looked up
+// in the glyph store, rasterized once into the LRU cache and then served
+// from RAM. Code points neither has are drawn as the atlas fallback
+// glyph. The store should share the atlas cell height; taller glyphs are
+// cut at the atlas's last page.
+
+template <size_t Slots, size_t GlyphBytes>
+class UnicodeFont
+{
+public:
+    typedef GlyphCache<Slots, GlyphBytes> Cache;
+
+    UnicodeFont(const FontAtlas &atlas, const GlyphStore &store) : atlas_(atlas), store_(store) {}
+
+    uint8_t pages() const { return atlas_.pages; }
+    uint8_t line_height() const { return atlas_.line_height; }
+
+    GlyphRef glyph(uint32_t codepoint)
+    {
+        if (codepoint >= atlas_.first && codepoint <= atlas_.last)
+        {
+            return from_atlas(atlas_glyph(atlas_, (uint8_t)codepoint));
+        }
+        const typename Cache::Entry *cached =
+            cache_.get(codepoint, [this, codepoint](typename Cache::Entry &out) { return rasterize(codepoint, out); });
+        if (!cached)
+        {
+            return from_atlas(atlas_glyph(atlas_, atlas_.fallback));
+        }
+        return {cached->columns, nullptr, cached->width, cached->bearing, cached->advance};
+    }
+
+    int advance(const GlyphRef &glyph, uint32_t next)
+    {
+        if (glyph.atlas && next <= atlas_.last)
+        {
+            return atlas_advance(atlas_, *glyph.atlas, (uint8_t)next);
+        }
+        return glyph.advance;
+    }
+
+    GlyphCacheStats stats() const { return cache_.stats(); }
+    const GlyphStore &store() const { return store_; }
+
+private:
+    bool rasterize(uint32_t codepoint, typename Cache::Entry &out)
+    {
+        const GlyphStoreEntry *e = store_.find(codepoint);
+        if (!e || !store_.rasterize(*e, atlas_.pages, out.columns, sizeof(out.columns)))
+        {
+            return false;
+        }
+        out.width = e->width;
+        out.bearing = e->bearing;
+        out.advance = e->advance;
+        return true;
+    }
+
+    GlyphRef from_atlas(const AtlasGlyph &g)
+    {
+        return {atlas_.bitmaps + g.offset, &g, g.width, g.bearing, g.advance};
+    }
+
+    const FontAtlas &atlas_;
+    const GlyphStore &store_;
+    Cache cache_;
+};
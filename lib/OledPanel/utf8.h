@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// UTF-8 Decoding
+// ===========================================================
+// Strict decoder for the display path. Malformed input (stray
+// continuation bytes, truncated or overlong sequences, surrogates, code
+// points past U+10FFFF) decodes as U+FFFD and consumes a single byte, so
+// the text after a bad byte still renders.
+
+static const uint32_t UTF8_REPLACEMENT = 0xFFFD;
+
+// Decode the code point at p and advance p past it; p must not point at
+// the terminating NUL
+inline uint32_t utf8_next(const char *&p)
+{
+    const uint8_t *s = (const uint8_t *)p;
+    uint8_t lead = s[0];
+    if (lead < 0x80)
+    {
+        p++;
+        return lead;
+    }
+    size_t len;
+    uint32_t cp;
+    uint32_t min;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        len = 2;
+        cp = lead & 0x1F;
+        min = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        len = 3;
+        cp = lead & 0x0F;
+        min = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        len = 4;
+        cp = lead & 0x07;
+        min = 0x10000;
+    }
+    else
+    {
+        p++;
+        return UTF8_REPLACEMENT;
+    }
+    for (size_t i = 1; i < len; i++)
+    {
+        // The NUL terminator fails this test, so decoding never reads past it
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            p++;
+            return UTF8_REPLACEMENT;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+    {
+        p++;
+        return UTF8_REPLACEMENT;
+    }
+    p += len;
+    return cp;
+}
+
+// Length of the longest prefix of text, at most max bytes, that does not
+// end inside a multi-byte sequence
+inline size_t utf8_prefix(const char *text, size_t max)
+{
+    size_t n = 0;
+    while (n < max && text[n])
+    {
+        n++;
+    }
+    // Cut inside a sequence: back up to its lead byte and drop it whole
+    while (n > 0 && ((uint8_t)text[n] & 0xC0) == 0x80)
+    {
+        n--;
+    }
+    return n;
+}
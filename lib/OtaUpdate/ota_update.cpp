@@ -0,0 +1,515 @@
+#include "ota_update.h"
+#include <esp_ota_ops.h>
+#include <esp_timer.h>
+#include <mbedtls/sha256.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "power_manager.h"
+#include "static_alloc.h"
+#include "logger.h"
+
+static const size_t OTA_BUFFER_SIZE = 4096; // One flash sector
+static const TickType_t OTA_BUFFER_WAIT = pdMS_TO_TICKS(5000);
+// Begin, two data blocks and the closing Finish or Abort
+static const UBaseType_t OTA_QUEUE_LENGTH = 4;
+
+enum class OtaState : uint8_t
+{
+    Idle,
+    Receiving,
+    Finishing, // Whole body received; the writer verifies and switches
+    Done,      // Boot partition switched; restart pending
+    Failed
+};
+
+enum class OtaCommand : uint8_t
+{
+    Begin,  // Open the image on target and start the digest
+    Data,   // Hash and write buffers[buffer]
+    Finish, // Verify, close the image and switch the boot partition
+    Abort   // Drop the image
+};
+
+struct OtaBlock
+{
+    OtaCommand command;
+    uint8_t buffer;
+    uint16_t len;
+};
+
+// Written by the receiver (async_tcp) while filling, by the writer while
+// draining; the free-buffer semaphore hands each buffer across.
+static uint8_t buffers[2][OTA_BUFFER_SIZE];
+static QueueHandle_t blockQueue = NULL;
+static SemaphoreHandle_t freeBuffer = NULL;
+static SemaphoreHandle_t closed = NULL; // Writer acknowledges Finish or Abort
+
+// Both tasks move the state; the first failure wins
+static portMUX_TYPE stateMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile OtaState state = OtaState::Idle;
+static const char *failure = nullptr;
+static OtaStats stats = {};
+static int64_t startedUs = 0;
+
+// Writer task only: the image handle and the digest are never touched
+// by the receiver, so an abort can never race a write in progress
+static esp_ota_handle_t otaHandle = 0;
+static mbedtls_sha256_context sha;
+static bool imageOpen = false;
+
+// Receiver (async_tcp) only. target and expectedDigest are set before
+// Begin is queued and read by the writer after it.
+static OtaAuthorize authorizeFn = nullptr;
+static const esp_partition_t *target = nullptr;
+static uint8_t expectedDigest[OTA_DIGEST_PREFIX];
+static uint8_t fillIndex = 0;
+static size_t fillLen = 0;
+static AsyncWebServerRequest *owner = nullptr;    // Request driving the session
+static AsyncWebServerRequest *rejected = nullptr; // Request refused at its first chunk
+static int rejectedStatus = 400;
+static bool sessionOpen = false;                  // Begin queued, writer not yet closed
+static bool closeQueued = false;                  // Finish or Abort queued
+static bool lockHeld = false;
+
+static void fail(const char *reason)
+{
+    portENTER_CRITICAL(&stateMux);
+    bool first = state != OtaState::Failed;
+    if (first)
+    {
+        failure = reason;
+        state = OtaState::Failed;
+    }
+    portEXIT_CRITICAL(&stateMux);
+    if (first)
+    {
+        LOG_ERROR("OTA failed: %s", reason);
+    }
+}
+
+// Move from one state to the next unless the other task failed first
+static bool advance(OtaState from, OtaState to)
+{
+    portENTER_CRITICAL(&stateMux);
+    bool ok = state == from;
+    if (ok)
+    {
+        state = to;
+    }
+    portEXIT_CRITICAL(&stateMux);
+    return ok;
+}
+
+static void release_lock()
+{
+    if (lockHeld)
+    {
+        power_lock_release(PowerLock::Http);
+        lockHeld = false;
+    }
+}
+
+bool ota_parse_authorization(const char *plaintext, OtaAuthorization &out)
+{
+    unsigned long size = 0;
+    char hex[2 * OTA_DIGEST_PREFIX + 1] = "";
+    int end = 0;
+    if (sscanf(plaintext, "ota|%lu|%32[0-9a-fA-F]%n", &size, hex, &end) != 2 || plaintext[end] != '\0' ||
+        strlen(hex) != 2 * OTA_DIGEST_PREFIX || size == 0)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < OTA_DIGEST_PREFIX; i++)
+    {
+        unsigned value;
+        sscanf(hex + 2 * i, "%2x", &value);
+        out.digest[i] = (uint8_t)value;
+    }
+    out.size = (uint32_t)size;
+    return true;
+}
+
+static const char *state_name(OtaState s)
+{
+    switch (s)
+    {
+    case OtaState::Receiving:
+        return "receiving";
+    case OtaState::Finishing:
+        return "verifying";
+    case OtaState::Done:
+        return "done";
+    case OtaState::Failed:
+        return "failed";
+    default:
+        return "idle";
+    }
+}
+
+static size_t status_json(char *out, size_t size)
+{
+    OtaState s = state;
+    uint32_t kbps = stats.receive_ms ? (uint32_t)((uint64_t)stats.bytes * 1000 / 1024 / stats.receive_ms) : 0;
+    return snprintf(out, size,
+                    "{\"state\":\"%s\",\"error\":\"%s\",\"bytes\":%lu,\"receive_ms\":%lu,\"kib_per_s\":%lu,"
+                    "\"elapsed_ms\":%lu,\"stall_us\":%lu,\"write_us\":%lu}",
+                    state_name(s), s == OtaState::Failed && failure ? failure : "", (unsigned long)stats.bytes,
+                    (unsigned long)stats.receive_ms, (unsigned long)kbps, (unsigned long)stats.elapsed_ms,
+                    (unsigned long)stats.stall_us, (unsigned long)stats.write_us);
+}
+
+// ===========================================================
+// Writer Task
+// ===========================================================
+
+static void close_image()
+{
+    if (imageOpen)
+    {
+        esp_ota_abort(otaHandle);
+        mbedtls_sha256_free(&sha);
+        imageOpen = false;
+    }
+}
+
+static void write_block(const OtaBlock &block)
+{
+    int64_t t0 = esp_timer_get_time();
+    const uint8_t *data = buffers[block.buffer];
+    mbedtls_sha256_update(&sha, data, block.len);
+    if (block.len && esp_ota_write(otaHandle, data, block.len) != ESP_OK)
+    {
+        close_image();
+        fail("flash write failed");
+    }
+    stats.write_us += (uint32_t)(esp_timer_get_time() - t0);
+}
+
+// Verify the digest, close the image and switch the boot partition
+static void finish_image()
+{
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha, digest);
+    if (memcmp(digest, expectedDigest, OTA_DIGEST_PREFIX) != 0)
+    {
+        close_image();
+        fail("SHA-256 mismatch");
+        return;
+    }
+    mbedtls_sha256_free(&sha);
+    imageOpen = false;
+    // esp_ota_end releases the handle whether or not the image validates
+    if (esp_ota_end(otaHandle) != ESP_OK)
+    {
+        fail("image validation failed");
+        return;
+    }
+    if (esp_ota_set_boot_partition(target) != ESP_OK)
+    {
+        fail("could not set boot partition");
+        return;
+    }
+    stats.elapsed_ms = (uint32_t)((esp_timer_get_time() - startedUs) / 1000);
+    advance(OtaState::Finishing, OtaState::Done);
+}
+
+static void ota_writer_task(void *)
+{
+    OtaBlock block;
+    while (true)
+    {
+        if (xQueueReceive(blockQueue, &block, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        switch (block.command)
+        {
+        case OtaCommand::Begin:
+            // Sequential writes: each sector is erased just before it is
+            // written, instead of erasing the whole partition up front
+            if (esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &otaHandle) != ESP_OK)
+            {
+                fail("esp_ota_begin failed");
+                break;
+            }
+            mbedtls_sha256_init(&sha);
+            mbedtls_sha256_starts(&sha, 0);
+            imageOpen = true;
+            break;
+        case OtaCommand::Data:
+            if (imageOpen && state != OtaState::Failed)
+            {
+                write_block(block);
+            }
+            xSemaphoreGive(freeBuffer);
+            break;
+        case OtaCommand::Finish:
+            if (imageOpen && state == OtaState::Finishing)
+            {
+                finish_image();
+            }
+            close_image();
+            if (state == OtaState::Done)
+            {
+                LOG_INFO("OTA complete in %lu ms, restarting", (unsigned long)stats.elapsed_ms);
+                // Restart whether or not the client is still connected;
+                // the pause lets a status poll see the result first
+                vTaskDelay(pdMS_TO_TICKS(OTA_RESTART_DELAY_MS));
+                logger_flush();
+                ESP.restart();
+            }
+            xSemaphoreGive(closed);
+            break;
+        case OtaCommand::Abort:
+            close_image();
+            xSemaphoreGive(closed);
+            break;
+        }
+    }
+}
+
+bool ota_update_begin()
+{
+#if STATIC_ALLOCATION
+    static StaticQueue_t queueStorage;
+    static uint8_t queueBuffer[OTA_QUEUE_LENGTH * sizeof(OtaBlock)];
+    static StaticSemaphore_t freeStorage, closedStorage;
+    static StaticTask_t writerTcb;
+    static StackType_t writerStack[4096];
+    blockQueue = xQueueCreateStatic(OTA_QUEUE_LENGTH, sizeof(OtaBlock), queueBuffer, &queueStorage);
+    freeBuffer = xSemaphoreCreateBinaryStatic(&freeStorage);
+    closed = xSemaphoreCreateBinaryStatic(&closedStorage);
+    TaskHandle_t writer = xTaskCreateStatic(ota_writer_task, "otaWriter", sizeof(writerStack), NULL, 2, writerStack,
+                                            &writerTcb);
+#else
+    blockQueue = xQueueCreate(OTA_QUEUE_LENGTH, sizeof(OtaBlock));
+    freeBuffer = xSemaphoreCreateBinary();
+    closed = xSemaphoreCreateBinary();
+    TaskHandle_t writer = NULL;
+    xTaskCreate(ota_writer_task, "otaWriter", 4096, NULL, 2, &writer);
+#endif
+    return blockQueue && freeBuffer && closed && writer;
+}
+
+void ota_update_configure(OtaAuthorize authorize)
+{
+    authorizeFn = authorize;
+}
+
+// ===========================================================
+// Receiver (async_tcp)
+// ===========================================================
+
+static void queue_command(OtaCommand command, uint8_t buffer = 0, uint16_t len = 0)
+{
+    OtaBlock block = {command, buffer, len};
+    // Never blocks: the free-buffer handshake bounds the data blocks in
+    // flight, and each session queues one Begin and one closing command
+    if (xQueueSend(blockQueue, &block, 0) != pdTRUE)
+    {
+        LOG_ERROR("OTA queue full");
+    }
+}
+
+// Every session ends with exactly one Finish or Abort
+static void close_session(OtaCommand command)
+{
+    if (sessionOpen && !closeQueued)
+    {
+        closeQueued = true;
+        queue_command(command);
+    }
+}
+
+static void abort_session(const char *reason)
+{
+    fail(reason);
+    close_session(OtaCommand::Abort);
+}
+
+// True while the writer still holds an earlier session's image
+static bool writer_busy()
+{
+    if (sessionOpen && closeQueued && xSemaphoreTake(closed, 0) == pdTRUE)
+    {
+        sessionOpen = false;
+    }
+    return sessionOpen;
+}
+
+static bool start_session(AsyncWebServerRequest *request, size_t total)
+{
+    state = OtaState::Idle;
+    failure = nullptr;
+    // Checked before anything else, so an unauthorized upload never opens
+    // the partition
+    OtaAuthorization authorization;
+    if (!authorizeFn || !request->hasHeader("X-Firmware-Authorization") ||
+        !authorizeFn(request->header("X-Firmware-Authorization").c_str(), authorization))
+    {
+        rejectedStatus = 403;
+        fail("missing or invalid X-Firmware-Authorization");
+        return false;
+    }
+    rejectedStatus = 400;
+    if (authorization.size != total)
+    {
+        fail("image size does not match authorization");
+        return false;
+    }
+    memcpy(expectedDigest, authorization.digest, sizeof(expectedDigest));
+    target = esp_ota_get_next_update_partition(NULL);
+    if (!target)
+    {
+        fail("no OTA partition");
+        return false;
+    }
+    if (total > target->size)
+    {
+        fail("image larger than OTA partition");
+        return false;
+    }
+    stats = {};
+    startedUs = esp_timer_get_time();
+    fillIndex = 0;
+    fillLen = 0;
+    // One spare buffer; the writer returns each one it drains
+    xSemaphoreTake(freeBuffer, 0);
+    xSemaphoreGive(freeBuffer);
+    state = OtaState::Receiving;
+    sessionOpen = true;
+    closeQueued = false;
+    queue_command(OtaCommand::Begin);
+    LOG_INFO("OTA started: %u bytes to %s", (unsigned)total, target->label);
+    return true;
+}
+
+// Hand the fill buffer to the writer; a full one waits for the other
+// buffer to come back first
+static void submit_fill(bool last)
+{
+    int64_t t0 = esp_timer_get_time();
+    if (!last && xSemaphoreTake(freeBuffer, OTA_BUFFER_WAIT) != pdTRUE)
+    {
+        abort_session("flash writer stalled");
+        return;
+    }
+    stats.stall_us += (uint32_t)(esp_timer_get_time() - t0);
+    queue_command(OtaCommand::Data, fillIndex, (uint16_t)fillLen);
+    fillIndex ^= 1;
+    fillLen = 0;
+}
+
+// Runs when the upload connection closes, whether or not a response went
+// out. Once the body is complete the writer finishes (and restarts) on
+// its own, so only an upload still receiving is dropped.
+static void on_owner_disconnect()
+{
+    owner = nullptr;
+    if (state == OtaState::Receiving)
+    {
+        abort_session("client disconnected");
+    }
+    else if (state == OtaState::Failed)
+    {
+        close_session(OtaCommand::Abort);
+    }
+    release_lock();
+}
+
+void handle_ota_body(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    if (index == 0)
+    {
+        if (owner || writer_busy())
+        {
+            return; // Another upload owns the pipeline; rejected in handle_ota_request
+        }
+        power_lock_acquire(PowerLock::Http);
+        lockHeld = true;
+        if (!start_session(request, total))
+        {
+            rejected = request;
+            release_lock();
+            return;
+        }
+        owner = request;
+        request->onDisconnect(on_owner_disconnect);
+    }
+    if (request != owner || state != OtaState::Receiving)
+    {
+        return;
+    }
+    while (len > 0 && state == OtaState::Receiving)
+    {
+        size_t n = OTA_BUFFER_SIZE - fillLen;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(buffers[fillIndex] + fillLen, data, n);
+        fillLen += n;
+        data += n;
+        len -= n;
+        stats.bytes += n;
+        if (fillLen == OTA_BUFFER_SIZE)
+        {
+            submit_fill(false);
+        }
+    }
+    if (stats.bytes == total && advance(OtaState::Receiving, OtaState::Finishing))
+    {
+        stats.receive_ms = (uint32_t)((esp_timer_get_time() - startedUs) / 1000);
+        if (fillLen)
+        {
+            submit_fill(true);
+        }
+        close_session(OtaCommand::Finish);
+    }
+}
+
+void handle_ota_request(AsyncWebServerRequest *request)
+{
+    if (request == rejected)
+    {
+        rejected = nullptr;
+        request->send(rejectedStatus, "text/plain", failure ? failure : "OTA rejected");
+        return;
+    }
+    if (request != owner)
+    {
+        request->send(409, "text/plain", "OTA already in progress");
+        return;
+    }
+    if (state == OtaState::Receiving)
+    {
+        // Body ended before Content-Length was reached
+        abort_session("incomplete body");
+    }
+    else if (state == OtaState::Failed)
+    {
+        close_session(OtaCommand::Abort);
+    }
+    release_lock();
+
+    if (state == OtaState::Failed)
+    {
+        request->send(400, "text/plain", failure ? failure : "OTA failed");
+        return;
+    }
+    // Verification and the partition switch run on the writer, which
+    // restarts the device on success; GET /ota reports the outcome
+    char json[256];
+    status_json(json, sizeof(json));
+    LOG_INFO("OTA received: %s", json);
+    request->send(202, "application/json", json);
+}
+
+void handle_ota_status(AsyncWebServerRequest *request)
+{
+    char json[256];
+    status_json(json, sizeof(json));
+    request->send(200, "application/json", json);
+}
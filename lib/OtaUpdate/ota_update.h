@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+
+// ===========================================================
+// Streaming OTA Update (POST /ota)
+// ===========================================================
+// The raw image is streamed as the request body. The
+// X-Firmware-Authorization header carries an envelope under the fleet key
+// ring whose plaintext is "ota|<image size>|<first 16 bytes of its
+// SHA-256, hex>"; it is opened and replay-checked like /set_wifi, and an
+// upload without a valid one is refused (403) before the partition is
+// touched.
+//
+// Body chunks fill one of two sector-sized buffers while a writer task
+// hashes and writes the other to the inactive OTA partition. Sectors are
+// erased as they are written, so the flash erase/write of one buffer
+// overlaps the network receive of the next.
+//
+// The writer task owns the image handle and the digest: the receiver
+// (async_tcp) only queues Begin, Data, Finish and Abort commands, so a
+// failed or dropped upload is cleaned up in order behind any write in
+// flight. Once the body is complete POST /ota answers 202 at once; the
+// writer verifies the digest prefix, switches the boot partition and restarts
+// the device after OTA_RESTART_DELAY_MS, whether or not the client is
+// still connected. GET /ota reports the state of the last update.
+
+static const uint32_t OTA_RESTART_DELAY_MS = 1500;
+// Digest prefix carried in the authorization; the full hex digest would
+// not fit in one envelope
+static const size_t OTA_DIGEST_PREFIX = 16;
+
+struct OtaAuthorization
+{
+    uint32_t size;
+    uint8_t digest[OTA_DIGEST_PREFIX];
+};
+
+// Opens the authorization envelope; false if it does not decrypt, is
+// replayed or does not parse
+typedef bool (*OtaAuthorize)(const char *envelope_b64, OtaAuthorization &out);
+
+// Parse "ota|<size>|<32 hex digits>"
+bool ota_parse_authorization(const char *plaintext, OtaAuthorization &out);
+
+struct OtaStats
+{
+    uint32_t bytes;
+    uint32_t receive_ms;  // First body chunk to last
+    uint32_t elapsed_ms;  // First body chunk to partition switch
+    uint32_t stall_us;    // Receiver time spent waiting for a free buffer
+    uint32_t write_us;    // Writer time in hash + esp_ota_write
+};
+
+// Create the writer task and its queues; call once from setup()
+bool ota_update_begin();
+
+// Every upload is refused until an authorizer is set
+void ota_update_configure(OtaAuthorize authorize);
+
+void handle_ota_body(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handle_ota_request(AsyncWebServerRequest *request);
+void handle_ota_status(AsyncWebServerRequest *request);
@@ -0,0 +1,132 @@
+#include "power_manager.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include "sdkconfig.h"
+#include "esp_idf_version.h"
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+struct LockStats
+{
+    uint32_t acquires;
+    uint32_t depth;
+    int64_t held_since_us;
+    int64_t held_total_us;
+};
+
+static const char *lock_names[(size_t)PowerLock::Count] = {"http", "crypto", "i2c"};
+static LockStats lock_stats[(size_t)PowerLock::Count] = {};
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t lock_handles[(size_t)PowerLock::Count] = {};
+#endif
+
+bool power_manager_begin(const PowerConfig &config)
+{
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_pm_config_t pm_config = {};
+#else
+    esp_pm_config_esp32s3_t pm_config = {};
+#endif
+    pm_config.max_freq_mhz = config.max_cpu_mhz;
+    pm_config.min_freq_mhz = config.min_cpu_mhz;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pm_config.light_sleep_enable = config.light_sleep;
+#endif
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK)
+    {
+        Serial.printf("esp_pm_configure failed: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "http", &lock_handles[(size_t)PowerLock::Http]);
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "crypto", &lock_handles[(size_t)PowerLock::Crypto]);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "i2c", &lock_handles[(size_t)PowerLock::I2C]);
+#if !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    Serial.println("Core built without tickless idle: frequency scaling only, no light sleep");
+#endif
+    return true;
+#else
+    (void)config;
+    Serial.println("Power management not enabled in this build");
+    return false;
+#endif
+}
+
+void power_manager_enable_gpio_wakeup()
+{
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void power_manager_apply_wifi(const PowerConfig &config)
+{
+    // Minimum modem sleep wakes for every DTIM beacon; max modem sleep
+    // honours the listen interval for lower idle current.
+    wifi_config_t wifi_config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) == ESP_OK)
+    {
+        wifi_config.sta.listen_interval = config.wifi_listen_interval;
+        esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    }
+    esp_wifi_set_ps(config.wifi_listen_interval > 1 ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+}
+
+void power_lock_acquire(PowerLock lock)
+{
+    size_t i = (size_t)lock;
+#if CONFIG_PM_ENABLE
+    if (lock_handles[i])
+    {
+        esp_pm_lock_acquire(lock_handles[i]);
+    }
+#endif
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&stats_mux);
+    if (lock_stats[i].depth++ == 0)
+    {
+        lock_stats[i].held_since_us = now;
+    }
+    lock_stats[i].acquires++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void power_lock_release(PowerLock lock)
+{
+    size_t i = (size_t)lock;
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&stats_mux);
+    if (lock_stats[i].depth > 0 && --lock_stats[i].depth == 0)
+    {
+        lock_stats[i].held_total_us += now - lock_stats[i].held_since_us;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+#if CONFIG_PM_ENABLE
+    if (lock_handles[i])
+    {
+        esp_pm_lock_release(lock_handles[i]);
+    }
+#endif
+}
+
+void power_manager_print_stats()
+{
+    int64_t uptime_us = esp_timer_get_time();
+    Serial.println("Power locks (acquires, held ms, % of uptime):");
+    for (size_t i = 0; i < (size_t)PowerLock::Count; i++)
+    {
+        portENTER_CRITICAL(&stats_mux);
+        LockStats s = lock_stats[i];
+        portEXIT_CRITICAL(&stats_mux);
+        int64_t held = s.held_total_us + (s.depth ? uptime_us - s.held_since_us : 0);
+        Serial.printf("  %-7s %8lu %10lld %6.2f%%\n", lock_names[i], (unsigned long)s.acquires,
+                      held / 1000, uptime_us ? 100.0 * held / uptime_us : 0.0);
+    }
+#if CONFIG_PM_ENABLE && CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===========================================================
+// Power Manager (automatic light sleep + PM locks)
+// ===========================================================
+// With the button and display event-driven, the CPU is idle almost all
+// of the time. When the core is built with CONFIG_PM_ENABLE and tickless
+// idle, the scheduler enters light sleep whenever no lock is held; WiFi
+// stays associated by waking for DTIM beacons (modem sleep).
+//
+// The stock arduino-esp32 core has CONFIG_PM_ENABLE but not
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE, so with it only dynamic frequency
+// scaling (max_cpu_mhz down to min_cpu_mhz) is active; light sleep needs
+// a core rebuilt with tickless idle.
+//
+// Work that cannot tolerate light sleep (an HTTP exchange in flight,
+// AES at full clock, an I2C transfer) holds a lock for its duration.
+// Without PM support in the core every call here is a cheap no-op.
+
+enum class PowerLock : uint8_t
+{
+    Http,   // No light sleep while a request is being handled
+    Crypto, // Max CPU frequency while decrypting
+    I2C,    // No light sleep while the I2C peripheral is clocked
+    Count
+};
+
+struct PowerConfig
+{
+    int max_cpu_mhz = 240;
+    int min_cpu_mhz = 40;         // APB floor while idle
+    bool light_sleep = true;      // Automatic light sleep in the idle task
+    int wifi_listen_interval = 3; // DTIM periods between beacon wakeups
+};
+
+bool power_manager_begin(const PowerConfig &config = PowerConfig());
+
+// Let GPIOs armed with gpio_wakeup_enable() wake the chip from light
+// sleep. The wake level doubles as the pin's interrupt type, so each
+// driver arms its own pins (the boot button does; see boot_button.h).
+void power_manager_enable_gpio_wakeup();
+
+// Apply WiFi modem sleep once the station is (re)started
+void power_manager_apply_wifi(const PowerConfig &config = PowerConfig());
+
+void power_lock_acquire(PowerLock lock);
+void power_lock_release(PowerLock lock);
+
+// Print per-lock acquire counts and total held time to Serial
+void power_manager_print_stats();
+
+// Scoped lock: held for the lifetime of the object
+class PowerLockGuard
+{
+public:
+    explicit PowerLockGuard(PowerLock lock) : lock_(lock) { power_lock_acquire(lock_); }
+    ~PowerLockGuard() { power_lock_release(lock_); }
+    PowerLockGuard(const PowerLockGuard &) = delete;
+    PowerLockGuard &operator=(const PowerLockGuard &) = delete;
+
+private:
+    PowerLock lock_;
+};
@@ -0,0 +1,164 @@
+#include "replay_guard.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+struct ReplayEntry
+{
+    uint64_t fingerprint; // 0 marks an empty slot
+    uint32_t seen_ms;
+};
+
+// Guards the table and the stats; held for one scan, never across a decrypt
+static std::mutex guardMutex;
+static ReplayEntry entries[REPLAY_GUARD_SLOTS];
+static size_t nextSlot = 0; // Oldest entry; slots are filled round-robin
+static uint64_t salt0 = 0;
+static uint64_t salt1 = 0;
+static uint32_t holdMs = 0;
+static ReplayGuardStats stats;
+
+static uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t load64(const uint8_t *p, size_t n)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+static uint64_t fingerprint(const uint8_t *nonce, size_t len)
+{
+    uint64_t h = salt0 ^ mix64(len ^ salt1);
+    for (size_t off = 0; off < len; off += 8)
+    {
+        size_t n = len - off < 8 ? len - off : 8;
+        h = mix64(h ^ load64(nonce + off, n)) + salt1;
+    }
+    return mix64(h) | 1; // Never collides with the empty marker
+}
+
+static bool occupied(const ReplayEntry &e)
+{
+    return e.fingerprint != 0;
+}
+
+// Index of the slot holding fp, or REPLAY_GUARD_SLOTS; every slot is
+// compared, without branching on the contents
+static size_t find(uint64_t fp)
+{
+    size_t found = REPLAY_GUARD_SLOTS;
+    for (size_t i = 0; i < REPLAY_GUARD_SLOTS; i++)
+    {
+        uint64_t diff = entries[i].fingerprint ^ fp;
+        size_t equal = (size_t)(((diff | (0 - diff)) >> 63) ^ 1);
+        found ^= (found ^ i) & (0 - equal);
+    }
+    return found;
+}
+
+void replay_guard_configure(const uint8_t salt[REPLAY_GUARD_SALT_SIZE], uint32_t hold_ms)
+{
+    {
+        std::lock_guard<std::mutex> lock(guardMutex);
+        salt0 = load64(salt, 8);
+        salt1 = load64(salt + 8, 8);
+        holdMs = hold_ms;
+    }
+    replay_guard_clear();
+}
+
+ReplayVerdict replay_guard_admit(const uint8_t *nonce, size_t len, uint32_t now_ms)
+{
+    std::lock_guard<std::mutex> lock(guardMutex);
+    uint64_t fp = fingerprint(nonce, len);
+    stats.checks++;
+    if (find(fp) != REPLAY_GUARD_SLOTS)
+    {
+        stats.rejected++;
+        return ReplayVerdict::Replayed;
+    }
+    ReplayEntry &e = entries[nextSlot];
+    if (occupied(e))
+    {
+        // Slots fill round-robin, so the next one is the oldest
+        stats.evicted++;
+        if (now_ms - e.seen_ms < holdMs)
+        {
+            stats.evicted_early++;
+        }
+    }
+    e.fingerprint = fp;
+    e.seen_ms = now_ms;
+    nextSlot = (nextSlot + 1) % REPLAY_GUARD_SLOTS;
+    stats.remembered++;
+    return ReplayVerdict::Fresh;
+}
+
+void replay_guard_forget(const uint8_t *nonce, size_t len)
+{
+    std::lock_guard<std::mutex> lock(guardMutex);
+    size_t i = find(fingerprint(nonce, len));
+    if (i == REPLAY_GUARD_SLOTS)
+    {
+        return;
+    }
+    // Only the newest entry is taken back, so the round-robin order of
+    // the rest holds; an older one just stays until it is evicted
+    size_t newest = (nextSlot + REPLAY_GUARD_SLOTS - 1) % REPLAY_GUARD_SLOTS;
+    if (i == newest)
+    {
+        entries[i] = {};
+        nextSlot = newest;
+        stats.remembered--;
+    }
+}
+
+void replay_guard_clear()
+{
+    std::lock_guard<std::mutex> lock(guardMutex);
+    memset(entries, 0, sizeof(entries));
+    nextSlot = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void replay_guard_add_cost(uint32_t cycles)
+{
+    std::lock_guard<std::mutex> lock(guardMutex);
+    stats.check_cycles_total += cycles;
+    if (cycles > stats.check_cycles_max)
+    {
+        stats.check_cycles_max = cycles;
+    }
+}
+
+ReplayGuardStats replay_guard_stats()
+{
+    std::lock_guard<std::mutex> lock(guardMutex);
+    ReplayGuardStats s = stats;
+    s.bytes = sizeof(entries);
+    return s;
+}
+
+size_t replay_guard_to_json(char *out, size_t size)
+{
+    ReplayGuardStats s = replay_guard_stats();
+    return snprintf(out, size,
+                    "{\"checks\":%lu,\"rejected\":%lu,\"remembered\":%lu,\"evicted\":%lu,"
+                    "\"evicted_early\":%lu,\"check_cycles_avg\":%lu,\"check_cycles_max\":%lu,\"bytes\":%lu}",
+                    (unsigned long)s.checks, (unsigned long)s.rejected, (unsigned long)s.remembered,
+                    (unsigned long)s.evicted, (unsigned long)s.evicted_early,
+                    (unsigned long)(s.checks ? s.check_cycles_total / s.checks : 0), (unsigned long)s.check_cycles_max,
+                    (unsigned long)s.bytes);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Replay Guard (bounded cache of recently accepted nonces)
+// ===========================================================
+// Each accepted /set_wifi envelope IV is stored as a salted 64-bit
+// fingerprint. A lookup always scans every slot and folds the
+// comparisons together without branching on the contents, so its cost
+// does not reveal whether or where a nonce matched.
+//
+// Envelopes carry no timestamp, so the guard cannot tell a stale
+// envelope from a fresh one: it is a recency filter over the last
+// REPLAY_GUARD_SLOTS accepted nonces, and a nonce pushed out of the
+// table can be replayed again. The table is a plain FIFO: when it is
+// full the oldest entry goes, whatever its age. Envelopes are not
+// authenticated, so anyone can present nonces; refusing new ones while
+// the table is full would let 32 junk envelopes lock out every real
+// one. hold_ms only classifies evictions: one younger than hold_ms is
+// counted as early, which is what a flood looks like in /diag.
+//
+// The lookup and the insert happen under one lock, so two tasks
+// presenting the same nonce cannot both be admitted. Pure C++; builds on
+// the host.
+
+static const size_t REPLAY_GUARD_SLOTS = 32;
+static const size_t REPLAY_GUARD_SALT_SIZE = 16;
+
+enum class ReplayVerdict : uint8_t
+{
+    Fresh,    // Not seen before; now remembered
+    Replayed  // Still in the table
+};
+
+struct ReplayGuardStats
+{
+    uint32_t checks;
+    uint32_t rejected;
+    uint32_t remembered;
+    uint32_t evicted;       // Pushed out of the table; replayable from then on
+    uint32_t evicted_early; // Of those, pushed out inside hold_ms
+    uint32_t check_cycles_max;
+    uint64_t check_cycles_total;
+    size_t bytes; // Static footprint of the table
+};
+
+// salt should be random per boot so fingerprints cannot be precomputed
+void replay_guard_configure(const uint8_t salt[REPLAY_GUARD_SALT_SIZE], uint32_t hold_ms = 0);
+
+// Check nonce and, if it is fresh, record it in the same step
+ReplayVerdict replay_guard_admit(const uint8_t *nonce, size_t len, uint32_t now_ms);
+
+// Drop an admitted nonce whose envelope then failed to decrypt or parse,
+// so junk does not push out real entries
+void replay_guard_forget(const uint8_t *nonce, size_t len);
+
+void replay_guard_clear();
+
+// Callers time replay_guard_admit with their own cycle counter
+void replay_guard_add_cost(uint32_t cycles);
+ReplayGuardStats replay_guard_stats();
+
+// Stats as one JSON object; returns what snprintf would have written
+size_t replay_guard_to_json(char *out, size_t size);
@@ -0,0 +1,116 @@
+#include "request_capture.h"
+#include <esp_timer.h>
+#include "request_log.h"
+#include "mem_placement.h"
+#include "logger.h"
+
+static RequestLogWriter writer;
+static uint8_t *buffer = nullptr;
+static size_t bufferSize = 0;
+static volatile bool capturing = false;
+
+static uint16_t request_id(AsyncWebServerRequest *request)
+{
+    return (uint16_t)((uintptr_t)request >> 2);
+}
+
+bool request_capture_start(size_t size)
+{
+    capturing = false;
+    if (buffer && bufferSize != size)
+    {
+        placement_free(buffer);
+        buffer = nullptr;
+    }
+    if (!buffer)
+    {
+        buffer = (uint8_t *)placement_alloc(size, MemPlacement::Cold);
+        if (!buffer)
+        {
+            LOG_ERROR("Capture buffer allocation failed (%u bytes)", (unsigned)size);
+            return false;
+        }
+        bufferSize = size;
+    }
+    writer.attach(buffer, bufferSize);
+    capturing = true;
+    LOG_INFO("Request capture started (%u bytes)", (unsigned)size);
+    return true;
+}
+
+void request_capture_stop()
+{
+    if (capturing)
+    {
+        capturing = false;
+        LOG_INFO("Request capture stopped: %u bytes, %lu dropped records", (unsigned)writer.size(),
+                 (unsigned long)writer.dropped());
+    }
+}
+
+bool request_capture_active()
+{
+    return capturing;
+}
+
+void request_capture(AsyncWebServerRequest *request)
+{
+    if (!capturing)
+    {
+        return;
+    }
+    uint16_t id = request_id(request);
+    uint64_t now = esp_timer_get_time();
+    writer.begin(id, (uint8_t)request->method(), request->url().c_str(), now);
+    writer.end(id, now);
+}
+
+void request_capture_body(AsyncWebServerRequest *request, const uint8_t *data, size_t len, size_t index,
+                          size_t total)
+{
+    if (!capturing)
+    {
+        return;
+    }
+    uint16_t id = request_id(request);
+    uint64_t now = esp_timer_get_time();
+    if (index == 0)
+    {
+        writer.begin(id, (uint8_t)request->method(), request->url().c_str(), now);
+    }
+    writer.body(id, index, total, data, len, now);
+    if (index + len >= total)
+    {
+        writer.end(id, now);
+    }
+}
+
+void request_capture_register(AsyncWebServer &server)
+{
+    server.on("/capture/start", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+                  size_t size = REQUEST_CAPTURE_DEFAULT_SIZE;
+                  if (request->hasParam("size"))
+                  {
+                      size = strtoul(request->getParam("size")->value().c_str(), nullptr, 10);
+                  }
+                  bool ok = size >= 256 && request_capture_start(size);
+                  request->send(ok ? 200 : 500, "text/plain", ok ? "Capture started" : "Capture failed");
+              });
+    server.on("/capture/stop", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+                  request_capture_stop();
+                  request->send(200, "text/plain", "Capture stopped");
+              });
+    server.on("/capture", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+                  // Stop first so the log does not change under the download
+                  request_capture_stop();
+                  if (!buffer)
+                  {
+                      request->send(404, "text/plain", "No capture");
+                      return;
+                  }
+                  request->send(request->beginResponse(200, "application/octet-stream", writer.data(), writer.size()));
+              });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+
+// ===========================================================
+// Request Capture (record HTTP traffic for host replay)
+// ===========================================================
+// While capturing, every request start, body chunk (with its index/total
+// split) and timing goes into a RequestLog buffer in cold memory. The
+// log is downloaded from GET /capture and fed to tools/replay on Linux.
+// The endpoints only exist in builds with REQUEST_CAPTURE=1; without
+// them the hooks below cost one branch.
+
+#ifndef REQUEST_CAPTURE
+#define REQUEST_CAPTURE 0
+#endif
+
+static const size_t REQUEST_CAPTURE_DEFAULT_SIZE = 32 * 1024;
+
+bool request_capture_start(size_t size = REQUEST_CAPTURE_DEFAULT_SIZE);
+void request_capture_stop();
+bool request_capture_active();
+
+// Hooks called from the handlers
+void request_capture(AsyncWebServerRequest *request);
+void request_capture_body(AsyncWebServerRequest *request, const uint8_t *data, size_t len, size_t index,
+                          size_t total);
+
+// GET /capture/start?size=N, GET /capture/stop, GET /capture
+void request_capture_register(AsyncWebServer &server);
@@ -0,0 +1,168 @@
+#include "request_log.h"
+#include <string.h>
+
+static const uint8_t MAGIC[4] = {'R', 'Q', 'L', 'G'};
+static const size_t VARINT_MAX = 10;
+
+void RequestLogWriter::attach(uint8_t *buffer, size_t capacity)
+{
+    buffer_ = buffer;
+    capacity_ = capacity;
+    reset();
+}
+
+void RequestLogWriter::reset()
+{
+    used_ = 0;
+    last_us_ = 0;
+    dropped_ = 0;
+    if (buffer_ && capacity_ >= REQUEST_LOG_HEADER_SIZE)
+    {
+        put_bytes(MAGIC, sizeof(MAGIC));
+        put_u8(REQUEST_LOG_VERSION);
+    }
+}
+
+void RequestLogWriter::put_varint(uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        put_u8((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_u8((uint8_t)v);
+}
+
+void RequestLogWriter::put_bytes(const void *data, size_t len)
+{
+    memcpy(buffer_ + used_, data, len);
+    used_ += len;
+}
+
+bool RequestLogWriter::put_header(RequestRecord type, uint16_t id, uint64_t now_us, size_t payload_max)
+{
+    if (!buffer_ || used_ == 0 || capacity_ - used_ < 3 + VARINT_MAX + payload_max)
+    {
+        dropped_++;
+        return false;
+    }
+    // The first record's delta is zero so replay starts immediately
+    uint64_t dt = last_us_ && now_us > last_us_ ? now_us - last_us_ : 0;
+    last_us_ = now_us;
+    put_u8((uint8_t)type);
+    put_u8((uint8_t)(id & 0xFF));
+    put_u8((uint8_t)(id >> 8));
+    put_varint(dt);
+    return true;
+}
+
+bool RequestLogWriter::begin(uint16_t id, uint8_t method, const char *url, uint64_t now_us)
+{
+    size_t url_len = strlen(url);
+    if (!put_header(RequestRecord::Begin, id, now_us, 1 + VARINT_MAX + url_len))
+    {
+        return false;
+    }
+    put_u8(method);
+    put_varint(url_len);
+    put_bytes(url, url_len);
+    return true;
+}
+
+bool RequestLogWriter::body(uint16_t id, uint32_t index, uint32_t total, const uint8_t *data, size_t len,
+                            uint64_t now_us)
+{
+    if (!put_header(RequestRecord::Body, id, now_us, 3 * VARINT_MAX + len))
+    {
+        return false;
+    }
+    put_varint(index);
+    put_varint(total);
+    put_varint(len);
+    put_bytes(data, len);
+    return true;
+}
+
+bool RequestLogWriter::end(uint16_t id, uint64_t now_us)
+{
+    return put_header(RequestRecord::End, id, now_us, 0);
+}
+
+RequestLogReader::RequestLogReader(const uint8_t *data, size_t size)
+    : data_(data), size_(size), pos_(REQUEST_LOG_HEADER_SIZE), t_us_(0), valid_(false)
+{
+    valid_ = size >= REQUEST_LOG_HEADER_SIZE && memcmp(data, MAGIC, sizeof(MAGIC)) == 0 &&
+             data[4] == REQUEST_LOG_VERSION;
+}
+
+bool RequestLogReader::get_u8(uint8_t &v)
+{
+    if (pos_ >= size_)
+    {
+        return false;
+    }
+    v = data_[pos_++];
+    return true;
+}
+
+bool RequestLogReader::get_varint(uint64_t &v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t b;
+        if (!get_u8(b))
+        {
+            return false;
+        }
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RequestLogReader::next(RequestEvent &event)
+{
+    uint8_t type, lo, hi;
+    uint64_t dt;
+    if (!valid_ || !get_u8(type) || !get_u8(lo) || !get_u8(hi) || !get_varint(dt))
+    {
+        return false;
+    }
+    memset(&event, 0, sizeof(event));
+    event.type = (RequestRecord)type;
+    event.id = (uint16_t)(lo | (hi << 8));
+    t_us_ += dt;
+    event.t_us = t_us_;
+
+    uint64_t a, b, len;
+    switch (event.type)
+    {
+    case RequestRecord::Begin:
+        if (!get_u8(event.method) || !get_varint(len) || len > size_ - pos_)
+        {
+            return false;
+        }
+        event.url = (const char *)data_ + pos_;
+        event.url_len = (size_t)len;
+        pos_ += (size_t)len;
+        return true;
+    case RequestRecord::Body:
+        if (!get_varint(a) || !get_varint(b) || !get_varint(len) || len > size_ - pos_)
+        {
+            return false;
+        }
+        event.index = (uint32_t)a;
+        event.total = (uint32_t)b;
+        event.data = data_ + pos_;
+        event.len = (size_t)len;
+        pos_ += (size_t)len;
+        return true;
+    case RequestRecord::End:
+        return true;
+    }
+    return false;
+}
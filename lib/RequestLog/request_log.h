@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Request Log (compact binary capture of HTTP traffic)
+// ===========================================================
+// Layout: "RQLG" version(u8), then records:
+//   type(u8) id(u16 LE) dt_us(varint) payload
+//     Begin: method(u8) url_len(varint) url
+//     Body:  index(varint) total(varint) len(varint) bytes
+//     End:   -
+// dt_us is the time since the previous record, so replay can reproduce
+// the original pacing and chunk splits exactly. Pure C++; the firmware
+// writes logs and the host replayer reads them.
+
+static const uint8_t REQUEST_LOG_VERSION = 1;
+static const size_t REQUEST_LOG_HEADER_SIZE = 5;
+
+enum class RequestRecord : uint8_t
+{
+    Begin = 1,
+    Body = 2,
+    End = 3
+};
+
+class RequestLogWriter
+{
+public:
+    RequestLogWriter() : buffer_(nullptr), capacity_(0), used_(0), last_us_(0), dropped_(0) {}
+    RequestLogWriter(uint8_t *buffer, size_t capacity) { attach(buffer, capacity); }
+
+    void attach(uint8_t *buffer, size_t capacity);
+    void reset();
+
+    bool begin(uint16_t id, uint8_t method, const char *url, uint64_t now_us);
+    bool body(uint16_t id, uint32_t index, uint32_t total, const uint8_t *data, size_t len, uint64_t now_us);
+    bool end(uint16_t id, uint64_t now_us);
+
+    const uint8_t *data() const { return buffer_; }
+    size_t size() const { return used_; }
+    uint32_t dropped() const { return dropped_; } // Records that did not fit
+
+private:
+    bool put_header(RequestRecord type, uint16_t id, uint64_t now_us, size_t payload_max);
+    void put_u8(uint8_t v) { buffer_[used_++] = v; }
+    void put_varint(uint64_t v);
+    void put_bytes(const void *data, size_t len);
+
+    uint8_t *buffer_;
+    size_t capacity_;
+    size_t used_;
+    uint64_t last_us_;
+    uint32_t dropped_;
+};
+
+struct RequestEvent
+{
+    RequestRecord type;
+    uint16_t id;
+    uint64_t t_us; // Absolute, from the first record
+    uint8_t method;
+    const char *url; // Not NUL-terminated
+    size_t url_len;
+    uint32_t index;
+    uint32_t total;
+    const uint8_t *data;
+    size_t len;
+};
+
+class RequestLogReader
+{
+public:
+    RequestLogReader(const uint8_t *data, size_t size);
+
+    bool valid() const { return valid_; }
+    // False at end of log or on a truncated record
+    bool next(RequestEvent &event);
+
+private:
+    bool get_u8(uint8_t &v);
+    bool get_varint(uint64_t &v);
+
+    const uint8_t *data_;
+    size_t size_;
+    size_t pos_;
+    uint64_t t_us_;
+    bool valid_;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// ===========================================================
+// Fixed Block Pool (lock-free)
+// ===========================================================
+// Hands out equal-sized blocks carved from caller-provided storage, so
+// the storage can be placed anywhere (COLD_BSS, a static array) while
+// the control words stay in internal RAM where atomics are supported.
+//
+// The free list is a Treiber stack. Its head packs a block number with
+// a generation tag that changes on every push, so a block popped and
+// pushed back between another core's load and compare-exchange cannot
+// corrupt the list (ABA). Blocks never handed out yet are taken from a
+// bump cursor instead, so a zero-initialised pool is already valid.
+// acquire() and release() may be called from any task on either core,
+// and a block may be released by a different task than acquired it.
+// Pure C++; the host replayer runs the same pool.
+
+struct BlockPoolStats
+{
+    uint32_t acquired;
+    uint32_t released;
+    uint32_t exhausted;  // acquire() calls that found no free block
+    uint32_t contended;  // Compare-exchange retries caused by another core
+    uint32_t in_use;
+    uint32_t high_water; // Most blocks out at once
+};
+
+template <size_t Count>
+class BlockPool
+{
+    static_assert(Count > 0 && Count < 0xffff, "block numbers are 16-bit");
+
+public:
+    BlockPool() : storage_(nullptr), block_size_(0) {}
+    BlockPool(void *storage, size_t block_size) : storage_((uint8_t *)storage), block_size_(block_size) {}
+
+    // Hand the pool its storage; only before the first acquire()
+    void attach(void *storage, size_t block_size)
+    {
+        storage_ = (uint8_t *)storage;
+        block_size_ = block_size;
+    }
+    bool attached() const { return storage_ != nullptr; }
+
+    void *acquire()
+    {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        while (head & INDEX_MASK)
+        {
+            uint16_t index = (uint16_t)(head & INDEX_MASK) - 1;
+            uint32_t next = (head & ~INDEX_MASK) | next_[index].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return taken(index);
+            }
+            contended_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Free list empty: fall back to blocks never handed out
+        uint32_t fresh = fresh_.load(std::memory_order_relaxed);
+        while (fresh < Count)
+        {
+            if (fresh_.compare_exchange_weak(fresh, fresh + 1, std::memory_order_relaxed))
+            {
+                return taken((uint16_t)fresh);
+            }
+            contended_.fetch_add(1, std::memory_order_relaxed);
+        }
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // block must have come from acquire() on this pool
+    void release(void *block)
+    {
+        if (!block)
+        {
+            return;
+        }
+        uint16_t index = (uint16_t)(((uint8_t *)block - storage_) / block_size_);
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            next_[index].store((uint16_t)(head & INDEX_MASK), std::memory_order_relaxed);
+            uint32_t tagged = ((head & ~INDEX_MASK) + TAG_STEP) | (uint32_t)(index + 1);
+            if (head_.compare_exchange_weak(head, tagged, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+            contended_.fetch_add(1, std::memory_order_relaxed);
+        }
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+        released_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool owns(const void *block) const
+    {
+        const uint8_t *p = (const uint8_t *)block;
+        return p >= storage_ && p < storage_ + Count * block_size_ && (size_t)(p - storage_) % block_size_ == 0;
+    }
+
+    size_t block_size() const { return block_size_; }
+    static constexpr size_t capacity() { return Count; }
+
+    BlockPoolStats stats() const
+    {
+        BlockPoolStats s;
+        s.acquired = acquired_.load(std::memory_order_relaxed);
+        s.released = released_.load(std::memory_order_relaxed);
+        s.exhausted = exhausted_.load(std::memory_order_relaxed);
+        s.contended = contended_.load(std::memory_order_relaxed);
+        s.in_use = in_use_.load(std::memory_order_relaxed);
+        s.high_water = high_water_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // Head word: generation tag in the high half, block number + 1 in the
+    // low half (0 = empty list)
+    static const uint32_t INDEX_MASK = 0xffff;
+    static const uint32_t TAG_STEP = 0x10000;
+
+    void *taken(uint16_t index)
+    {
+        acquired_.fetch_add(1, std::memory_order_relaxed);
+        uint32_t out = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32_t high = high_water_.load(std::memory_order_relaxed);
+        while (out > high && !high_water_.compare_exchange_weak(high, out, std::memory_order_relaxed))
+        {
+        }
+        return storage_ + (size_t)index * block_size_;
+    }
+
+    uint8_t *storage_;
+    size_t block_size_;
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> fresh_{0};
+    std::atomic<uint16_t> next_[Count] = {};
+    std::atomic<uint32_t> acquired_{0};
+    std::atomic<uint32_t> released_{0};
+    std::atomic<uint32_t> exhausted_{0};
+    std::atomic<uint32_t> contended_{0};
+    std::atomic<uint32_t> in_use_{0};
+    std::atomic<uint32_t> high_water_{0};
+};
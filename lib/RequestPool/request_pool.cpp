@@ -0,0 +1,70 @@
+#include "request_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+// The pool's control words stay in internal RAM even when the blocks
+// themselves are in PSRAM
+static BlockPool<REQUEST_POOL_BLOCKS> pool;
+static RequestPoolClock cycleClock = nullptr;
+static std::atomic<uint32_t> acquireCyclesMax{0};
+static std::atomic<uint64_t> acquireCyclesTotal{0};
+
+void request_pool_begin(void *storage, RequestPoolClock clock)
+{
+    pool.attach(storage, REQUEST_BLOCK_SIZE);
+    cycleClock = clock;
+}
+
+void *request_block_acquire()
+{
+    if (!pool.attached())
+    {
+        return nullptr;
+    }
+    uint32_t started = cycleClock ? cycleClock() : 0;
+    void *block = pool.acquire();
+    if (cycleClock)
+    {
+        uint32_t cycles = cycleClock() - started;
+        acquireCyclesTotal.fetch_add(cycles, std::memory_order_relaxed);
+        uint32_t max = acquireCyclesMax.load(std::memory_order_relaxed);
+        while (cycles > max && !acquireCyclesMax.compare_exchange_weak(max, cycles, std::memory_order_relaxed))
+        {
+        }
+    }
+    return block;
+}
+
+void request_block_release(void *block)
+{
+    if (!block || !pool.attached())
+    {
+        return;
+    }
+    memset(block, 0, REQUEST_BLOCK_SIZE);
+    pool.release(block);
+}
+
+RequestPoolStats request_pool_stats()
+{
+    RequestPoolStats s = {};
+    s.pool = pool.stats();
+    s.block_size = REQUEST_BLOCK_SIZE;
+    s.blocks = REQUEST_POOL_BLOCKS;
+    s.acquire_cycles_max = acquireCyclesMax.load(std::memory_order_relaxed);
+    s.acquire_cycles_total = acquireCyclesTotal.load(std::memory_order_relaxed);
+    return s;
+}
+
+size_t request_pool_to_json(char *out, size_t size)
+{
+    RequestPoolStats s = request_pool_stats();
+    uint32_t attempts = s.pool.acquired + s.pool.exhausted;
+    return snprintf(out, size,
+                    "{\"blocks\":%lu,\"block_size\":%lu,\"in_use\":%lu,\"high_water\":%lu,\"acquired\":%lu,"
+                    "\"exhausted\":%lu,\"contended\":%lu,\"acquire_cycles_avg\":%lu,\"acquire_cycles_max\":%lu}",
+                    (unsigned long)s.blocks, (unsigned long)s.block_size, (unsigned long)s.pool.in_use,
+                    (unsigned long)s.pool.high_water, (unsigned long)s.pool.acquired, (unsigned long)s.pool.exhausted,
+                    (unsigned long)s.pool.contended, (unsigned long)(attempts ? s.acquire_cycles_total / attempts : 0),
+                    (unsigned long)s.acquire_cycles_max);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "block_pool.h"
+
+// ===========================================================
+// Request Context Pool
+// ===========================================================
+// Per-request state (body accumulator, JSON arena, decrypted
+// credentials on their way to the connect task) is borrowed from a
+// fixed pool instead of the general heap, so request traffic cannot
+// fragment it. A block is sized for the largest supported body plus its
+// JSON arena; see RequestContext in lib/HttpApi.
+//
+// Blocks are returned by whichever task finishes with them: the HTTP
+// handler, or the connect task for credentials. Pure C++; the firmware
+// supplies the storage (cold, so PSRAM when present) and a cycle
+// counter, and the host replayer runs the same pool under load.
+
+static const size_t REQUEST_BLOCK_SIZE = 1792;
+static const size_t REQUEST_POOL_BLOCKS = 4;
+static const size_t REQUEST_POOL_STORAGE_SIZE = REQUEST_BLOCK_SIZE * REQUEST_POOL_BLOCKS;
+
+// Free-running cycle counter used to time acquire(); may be nullptr
+typedef uint32_t (*RequestPoolClock)();
+
+struct RequestPoolStats
+{
+    BlockPoolStats pool;
+    uint32_t block_size;
+    uint32_t blocks;
+    uint32_t acquire_cycles_max;
+    uint64_t acquire_cycles_total;
+};
+
+// storage must hold REQUEST_POOL_STORAGE_SIZE bytes, 8-byte aligned,
+// and outlive the pool. Call once before the first acquire.
+void request_pool_begin(void *storage, RequestPoolClock clock);
+
+// nullptr when every block is out; callers answer 503
+void *request_block_acquire();
+
+// Zeroes the block, which may hold credentials, before returning it
+void request_block_release(void *block);
+
+RequestPoolStats request_pool_stats();
+
+// Stats as one JSON object; returns what snprintf would have written
+size_t request_pool_to_json(char *out, size_t size);
@@ -0,0 +1,223 @@
+#include "session.h"
+#include <stdio.h>
+#include <string.h>
+#include <mbedtls/ecdh.h>
+#include <mbedtls/ecp.h>
+#include <mbedtls/md.h>
+
+struct SessionSlot
+{
+    bool in_use;
+    uint32_t expires_ms;
+    uint32_t peer_addr;
+    uint8_t id[SESSION_ID_SIZE];
+    uint8_t client_pub[SESSION_PUB_SIZE];
+    uint8_t server_pub[SESSION_PUB_SIZE];
+    uint8_t key[SESSION_KEY_SIZE];
+};
+
+static SessionSlot slots[SESSION_SLOTS];
+static SessionRng rngFn = nullptr;
+static void *rngCtx = nullptr;
+static uint32_t ttlMs = SESSION_DEFAULT_TTL_MS;
+static const char HKDF_INFO[] = "esp32-prov session v1";
+
+static void wipe(void *p, size_t n)
+{
+    volatile uint8_t *v = (volatile uint8_t *)p;
+    while (n--)
+    {
+        *v++ = 0;
+    }
+}
+
+static bool expired(const SessionSlot &slot, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - slot.expires_ms) >= 0;
+}
+
+void session_configure(SessionRng rng, void *rng_ctx, uint32_t ttl_ms)
+{
+    rngFn = rng;
+    rngCtx = rng_ctx;
+    ttlMs = ttl_ms;
+}
+
+uint32_t session_ttl_ms()
+{
+    return ttlMs;
+}
+
+void session_clear()
+{
+    wipe(slots, sizeof(slots));
+}
+
+// Single output block
+bool session_hkdf(const uint8_t *salt, size_t salt_len, const uint8_t *ikm, size_t ikm_len, uint8_t *okm,
+                  size_t okm_len)
+{
+    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    uint8_t prk[32], block[32];
+    const uint8_t counter = 1;
+    bool ok = okm_len <= sizeof(block) && mbedtls_md_hmac(md, salt, salt_len, ikm, ikm_len, prk) == 0;
+    if (ok)
+    {
+        mbedtls_md_context_t ctx;
+        mbedtls_md_init(&ctx);
+        ok = mbedtls_md_setup(&ctx, md, 1) == 0 && mbedtls_md_hmac_starts(&ctx, prk, sizeof(prk)) == 0 &&
+             mbedtls_md_hmac_update(&ctx, (const uint8_t *)HKDF_INFO, sizeof(HKDF_INFO) - 1) == 0 &&
+             mbedtls_md_hmac_update(&ctx, &counter, 1) == 0 && mbedtls_md_hmac_finish(&ctx, block) == 0;
+        mbedtls_md_free(&ctx);
+    }
+    if (ok)
+    {
+        memcpy(okm, block, okm_len);
+    }
+    wipe(prk, sizeof(prk));
+    wipe(block, sizeof(block));
+    return ok;
+}
+
+// Generate an ephemeral key pair, compute the X25519 shared secret and
+// derive the session key. This is the expensive path.
+static bool derive_session(const uint8_t client_pub[SESSION_PUB_SIZE], SessionSlot &slot)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_mpi d, z;
+    mbedtls_ecp_point q, peer;
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&z);
+    mbedtls_ecp_point_init(&q);
+    mbedtls_ecp_point_init(&peer);
+
+    uint8_t shared[32];
+    size_t olen = 0;
+    bool ok = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_CURVE25519) == 0 &&
+              mbedtls_ecdh_gen_public(&grp, &d, &q, rngFn, rngCtx) == 0 &&
+              mbedtls_ecp_point_write_binary(&grp, &q, MBEDTLS_ECP_PF_UNCOMPRESSED, &olen, slot.server_pub,
+                                             SESSION_PUB_SIZE) == 0 &&
+              olen == SESSION_PUB_SIZE &&
+              mbedtls_ecp_point_read_binary(&grp, &peer, client_pub, SESSION_PUB_SIZE) == 0 &&
+              mbedtls_ecdh_compute_shared(&grp, &z, &peer, &d, rngFn, rngCtx) == 0 &&
+              mbedtls_mpi_write_binary_le(&z, shared, sizeof(shared)) == 0;
+
+    // An all-zero secret means a low-order peer point
+    uint8_t acc = 0;
+    for (size_t i = 0; ok && i < sizeof(shared); i++)
+    {
+        acc |= shared[i];
+    }
+    ok = ok && acc != 0;
+
+    if (ok)
+    {
+        uint8_t salt[2 * SESSION_PUB_SIZE];
+        memcpy(salt, client_pub, SESSION_PUB_SIZE);
+        memcpy(salt + SESSION_PUB_SIZE, slot.server_pub, SESSION_PUB_SIZE);
+        ok = session_hkdf(salt, sizeof(salt), shared, sizeof(shared), slot.key, SESSION_KEY_SIZE) &&
+             rngFn(rngCtx, slot.id, SESSION_ID_SIZE) == 0;
+    }
+
+    wipe(shared, sizeof(shared));
+    mbedtls_ecp_point_free(&peer);
+    mbedtls_ecp_point_free(&q);
+    mbedtls_mpi_free(&z);
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_group_free(&grp);
+    return ok;
+}
+
+bool session_handshake(const uint8_t client_pub[SESSION_PUB_SIZE], uint32_t peer_addr, uint32_t now_ms,
+                       SessionResult &out)
+{
+    if (!rngFn)
+    {
+        return false;
+    }
+    SessionSlot *victim = &slots[0];
+    for (SessionSlot &slot : slots)
+    {
+        if (slot.in_use && !expired(slot, now_ms) && slot.peer_addr == peer_addr &&
+            memcmp(slot.client_pub, client_pub, SESSION_PUB_SIZE) == 0)
+        {
+            memcpy(out.id, slot.id, SESSION_ID_SIZE);
+            memcpy(out.server_pub, slot.server_pub, SESSION_PUB_SIZE);
+            out.cached = true;
+            return true;
+        }
+        // Reuse a free or expired slot, otherwise evict the one expiring first
+        if (!slot.in_use || expired(slot, now_ms))
+        {
+            victim = &slot;
+        }
+        else if (victim->in_use && !expired(*victim, now_ms) && (int32_t)(slot.expires_ms - victim->expires_ms) < 0)
+        {
+            victim = &slot;
+        }
+    }
+    SessionSlot fresh = {};
+    if (!derive_session(client_pub, fresh))
+    {
+        wipe(&fresh, sizeof(fresh));
+        return false;
+    }
+    fresh.in_use = true;
+    fresh.expires_ms = now_ms + ttlMs;
+    fresh.peer_addr = peer_addr;
+    memcpy(fresh.client_pub, client_pub, SESSION_PUB_SIZE);
+    *victim = fresh;
+    wipe(&fresh, sizeof(fresh));
+    memcpy(out.id, victim->id, SESSION_ID_SIZE);
+    memcpy(out.server_pub, victim->server_pub, SESSION_PUB_SIZE);
+    out.cached = false;
+    return true;
+}
+
+bool session_lookup_key(const uint8_t id[SESSION_ID_SIZE], uint32_t now_ms, uint8_t key_out[SESSION_KEY_SIZE])
+{
+    for (SessionSlot &slot : slots)
+    {
+        if (slot.in_use && memcmp(slot.id, id, SESSION_ID_SIZE) == 0)
+        {
+            if (expired(slot, now_ms))
+            {
+                wipe(&slot, sizeof(slot));
+                return false;
+            }
+            memcpy(key_out, slot.key, SESSION_KEY_SIZE);
+            return true;
+        }
+    }
+    return false;
+}
+
+void session_id_to_hex(const uint8_t id[SESSION_ID_SIZE], char out[2 * SESSION_ID_SIZE + 1])
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < SESSION_ID_SIZE; i++)
+    {
+        out[2 * i] = digits[id[i] >> 4];
+        out[2 * i + 1] = digits[id[i] & 0x0F];
+    }
+    out[2 * SESSION_ID_SIZE] = '\0';
+}
+
+bool session_id_from_hex(const char *hex, uint8_t id[SESSION_ID_SIZE])
+{
+    if (strlen(hex) != 2 * SESSION_ID_SIZE)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < SESSION_ID_SIZE; i++)
+    {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1)
+        {
+            return false;
+        }
+        id[i] = (uint8_t)v;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===========================================================
+// Session Key Exchange (X25519 + HKDF-SHA256)
+// ===========================================================
+// A client posts its X25519 public key; the device answers with an
+// ephemeral public key and a session ID. Both sides derive
+//   key = HKDF-SHA256(salt = client_pub || server_pub, ikm = shared,
+//                     info = "esp32-prov session v1")[0..16)
+// and the client then encrypts /set_wifi envelopes with that key.
+//
+// Sessions are cached in a small fixed table for ttl_ms. A repeated
+// handshake with the same client public key from the same peer address
+// returns the cached session, so the scalar multiplication runs once per
+// session rather than once per request. Another peer presenting a
+// captured public key gets a fresh session of its own, never the cached
+// session ID. Pure mbedTLS; builds on the host.
+
+static const size_t SESSION_ID_SIZE = 8;
+static const size_t SESSION_PUB_SIZE = 32;
+static const size_t SESSION_KEY_SIZE = 16;
+static const size_t SESSION_SLOTS = 4;
+static const uint32_t SESSION_DEFAULT_TTL_MS = 5 * 60 * 1000;
+
+// mbedTLS-style RNG callback
+typedef int (*SessionRng)(void *ctx, unsigned char *buf, size_t len);
+
+struct SessionResult
+{
+    uint8_t id[SESSION_ID_SIZE];
+    uint8_t server_pub[SESSION_PUB_SIZE];
+    bool cached; // Served from the table, no scalar multiplication
+};
+
+void session_configure(SessionRng rng, void *rng_ctx, uint32_t ttl_ms = SESSION_DEFAULT_TTL_MS);
+
+// peer_addr identifies the connection the handshake came in on (IPv4)
+bool session_handshake(const uint8_t client_pub[SESSION_PUB_SIZE], uint32_t peer_addr, uint32_t now_ms,
+                       SessionResult &out);
+
+// Copy the key of a live session; false if unknown or expired
+bool session_lookup_key(const uint8_t id[SESSION_ID_SIZE], uint32_t now_ms, uint8_t key_out[SESSION_KEY_SIZE]);
+
+void session_clear();
+
+uint32_t session_ttl_ms();
+
+// HKDF-SHA256 (RFC 5869) with the session info string, okm_len <= 32.
+// The handshake's key derivation step, exposed for the host benchmark.
+bool session_hkdf(const uint8_t *salt, size_t salt_len, const uint8_t *ikm, size_t ikm_len, uint8_t *okm,
+                  size_t okm_len);
+
+// Hex helpers for the session ID on the wire
+void session_id_to_hex(const uint8_t id[SESSION_ID_SIZE], char out[2 * SESSION_ID_SIZE + 1]);
+bool session_id_from_hex(const char *hex, uint8_t id[SESSION_ID_SIZE]);
@@ -0,0 +1,188 @@
+#include "wifi_controller.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "credential_store.h"
+#include "display_renderer.h"
+#include "power_manager.h"
+#include "diagnostics.h"
+#include "static_alloc.h"
+#include "logger.h"
+#include "event_bus.h"
+#include "request_pool.h"
+
+static const int JOIN_ATTEMPTS = 20;
+static const uint32_t JOIN_POLL_MS = 500;
+
+// Begin a station join and wait up to JOIN_ATTEMPTS polls for it
+bool wifi_join(const WifiCredentials &creds)
+{
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(creds.ssid, creds.password);
+    LOG_INFO("Connecting to WiFi: %s", creds.ssid);
+    int attempts = 0;
+    while (WiFi.status() != WL_CONNECTED && attempts < JOIN_ATTEMPTS)
+    {
+        vTaskDelay(pdMS_TO_TICKS(JOIN_POLL_MS));
+        attempts++;
+    }
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        LOG_WARN("WiFi join timed out after %d polls", attempts);
+        return false;
+    }
+    power_manager_apply_wifi();
+    IPAddress localIP = WiFi.localIP();
+    LOG_INFO("Connected to WiFi: %s after %d polls", creds.ssid, attempts);
+    LOG_INFO("Local IP Address: %s", localIP.toString());
+    char lines[112]; // "Connected:", a 63-byte ssid and the address
+    snprintf(lines, sizeof(lines), "Connected:\n%s\nIP: %s", creds.ssid, localIP.toString().c_str());
+    display_request(lines, DisplayStyle::Lines);
+    return true;
+}
+
+// Runs on the Arduino event task; it only publishes. Connected comes
+// from here too so the driver's own re-joins are reported.
+static void on_sta_event(arduino_event_id_t id, arduino_event_info_t info)
+{
+    BusEvent event;
+    if (id == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+    {
+        event.type = BusEventType::Connected;
+        event.ipv4 = info.got_ip.ip_info.ip.addr;
+    }
+    else
+    {
+        event.type = BusEventType::Disconnected;
+        event.reason = info.wifi_sta_disconnected.reason;
+    }
+    event_bus_publish(event);
+}
+
+static void register_sta_events()
+{
+    WiFi.onEvent(on_sta_event, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(on_sta_event, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+}
+
+void wifi_start_ap(const char *ssid, const char *password)
+{
+    LOG_INFO("Starting AP Mode...");
+    WiFi.softAP(ssid, password);
+    IPAddress apIP = WiFi.softAPIP();
+    LOG_INFO("AP IP Address: %s", apIP.toString());
+    char lines[40];
+    snprintf(lines, sizeof(lines), "AP Mode Active\n%s", apIP.toString().c_str());
+    display_request(lines, DisplayStyle::Lines);
+}
+
+static void publish_connect_failed()
+{
+    BusEvent event;
+    event.type = BusEventType::ConnectFailed;
+    event_bus_publish(event);
+}
+
+void connect_with_credentials(const char *credentials)
+{
+    LOG_DEBUG("Raw Credentials String: [%s]", log_secret(credentials));
+    WifiCredentials creds;
+    if (!parse_credentials(credentials, creds))
+    {
+        LOG_WARN("Invalid WiFi data format!");
+        publish_connect_failed();
+        return;
+    }
+    WiFi.disconnect();
+    delay(1000);
+    if (wifi_join(creds))
+    {
+        credential_store_save(creds);
+    }
+    else
+    {
+        LOG_WARN("WiFi connection failed.");
+        publish_connect_failed();
+    }
+    wipe_credentials(creds);
+    // Catch this task's stack peak before it exits or goes idle
+    diagnostics_sample();
+}
+
+#if STATIC_ALLOCATION
+// One long-lived worker with a static stack consumes credentials from a
+// static queue, so a setup request never allocates a task or a copy.
+struct CredentialSlot
+{
+    char data[128];
+};
+
+static const size_t WIFI_TASK_STACK = 4096;
+static StaticTask_t wifiTaskTcb;
+static StackType_t wifiTaskStack[WIFI_TASK_STACK];
+static StaticQueue_t credentialQueueStorage;
+static uint8_t credentialQueueBuffer[2 * sizeof(CredentialSlot)];
+static QueueHandle_t credentialQueue = NULL;
+
+static void wifi_worker_task(void *)
+{
+    CredentialSlot slot;
+    while (true)
+    {
+        if (xQueueReceive(credentialQueue, &slot, portMAX_DELAY) == pdTRUE)
+        {
+            connect_with_credentials(slot.data);
+            memset(&slot, 0, sizeof(slot));
+        }
+    }
+}
+
+void wifi_controller_begin()
+{
+    register_sta_events();
+    credentialQueue = xQueueCreateStatic(2, sizeof(CredentialSlot), credentialQueueBuffer, &credentialQueueStorage);
+    xTaskCreateStatic(wifi_worker_task, "ConnectToWiFi", WIFI_TASK_STACK, NULL, 1, wifiTaskStack, &wifiTaskTcb);
+}
+
+bool wifi_dispatch_credentials(const char *credentials)
+{
+    CredentialSlot slot;
+    strlcpy(slot.data, credentials, sizeof(slot.data));
+    bool queued = xQueueSend(credentialQueue, &slot, 0) == pdTRUE;
+    memset(&slot, 0, sizeof(slot));
+    return queued;
+}
+#else
+// The credentials travel in a request pool block, which this task hands
+// back (zeroed) once the join is over
+static void connectToWiFi(void *parameter)
+{
+    connect_with_credentials((const char *)parameter);
+    request_block_release(parameter);
+    vTaskDelete(NULL);
+}
+
+void wifi_controller_begin()
+{
+    register_sta_events();
+}
+
+bool wifi_dispatch_credentials(const char *credentials)
+{
+    char *block = (char *)request_block_acquire();
+    if (!block)
+    {
+        LOG_ERROR("No free request block for credentials");
+        return false;
+    }
+    strlcpy(block, credentials, REQUEST_BLOCK_SIZE);
+    if (xTaskCreate(connectToWiFi, "ConnectToWiFi", 4096, block, 1, NULL) != pdPASS)
+    {
+        request_block_release(block);
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "credentials.h"
+
+// ===========================================================
+// WiFi Controller (station join, AP fallback, connect worker)
+// ===========================================================
+
+// Start the background connect path (a static worker in
+// STATIC_ALLOCATION builds) and publish station connects and
+// disconnects on the bus
+void wifi_controller_begin();
+
+// Join the network and show the result; false if the join times out
+bool wifi_join(const WifiCredentials &creds);
+
+void wifi_start_ap(const char *ssid, const char *password);
+
+// Parse raw "ssid|password", join, and persist on success (blocking);
+// publishes ConnectFailed when either step fails
+void connect_with_credentials(const char *credentials);
+
+// Hand raw credentials to the connect task; false if it could not be
+// started or is still busy with a previous request
+bool wifi_dispatch_credentials(const char *credentials);
@@ -0,0 +1,92 @@
+#include "wifi_setup.h"
+#include <string.h>
+
+static CredentialDecrypt decryptFn = nullptr;
+static ArduinoJson::Allocator *jsonAllocator = nullptr;
+
+void wifi_setup_configure(CredentialDecrypt decrypt, ArduinoJson::Allocator *allocator)
+{
+    decryptFn = decrypt;
+    jsonAllocator = allocator;
+}
+
+void wifi_setup_reset(WifiSetupRequest &req, const void *owner, ArduinoJson::Allocator *allocator)
+{
+    req.owner = owner;
+    req.allocator = allocator;
+    req.received = 0;
+    req.has_credentials = false;
+    req.body[0] = '\0';
+}
+
+void wifi_setup_wipe(WifiSetupRequest &req)
+{
+    volatile char *p = (volatile char *)req.body;
+    for (size_t i = 0; i < sizeof(req.body); i++)
+    {
+        p[i] = 0;
+    }
+    p = (volatile char *)req.credentials;
+    for (size_t i = 0; i < sizeof(req.credentials); i++)
+    {
+        p[i] = 0;
+    }
+    req.has_credentials = false;
+}
+
+// Parse the complete body and decrypt its envelope into req.credentials
+static bool parse_body(JsonDocument &jsonDoc, WifiSetupRequest &req, WifiSetupReply &reply)
+{
+    DeserializationError error = deserializeJson(jsonDoc, req.body, req.received);
+    if (error)
+    {
+        reply = {400, "Invalid JSON"};
+        return true;
+    }
+    const char *encrypted_data = jsonDoc["data"];
+    if (!encrypted_data)
+    {
+        reply = {400, "Missing 'data' parameter"};
+        return true;
+    }
+    const char *session_id = jsonDoc["session"];
+    if (!decryptFn || !decryptFn(encrypted_data, session_id, req.credentials, sizeof(req.credentials)))
+    {
+        reply = {400, "Decryption Failed"};
+        return true;
+    }
+    req.has_credentials = true;
+    reply = {200, "WiFi Credentials Processing..."};
+    return true;
+}
+
+bool wifi_setup_feed(WifiSetupRequest &req, const uint8_t *data, size_t len, size_t index, size_t total,
+                     WifiSetupReply &reply)
+{
+    if (total > WIFI_SETUP_MAX_BODY)
+    {
+        reply = {413, "Body too large"};
+        return index + len >= total;
+    }
+    if (index != req.received || index + len > total)
+    {
+        reply = {400, "Unexpected body chunk"};
+        return true;
+    }
+    memcpy(req.body + index, data, len);
+    req.received += len;
+    if (req.received < total)
+    {
+        return false;
+    }
+    req.body[req.received] = '\0';
+
+    ArduinoJson::Allocator *allocator = req.allocator ? req.allocator : jsonAllocator;
+    if (allocator)
+    {
+        JsonDocument jsonDoc(allocator);
+        return parse_body(jsonDoc, req, reply);
+    }
+    JsonDocument jsonDoc;
+    return parse_body(jsonDoc, req, reply);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// ===========================================================
+// /set_wifi Request Core (transport independent)
+// ===========================================================
+// Accumulates the JSON body across chunks, parses it once complete and
+// decrypts the "data" envelope. The web server wrapper and the host
+// replayer both drive it, so chunk-split bodies behave identically on
+// the device and on Linux.
+//
+// Body: {"data": "<envelope>", "session": "<hex id>"}; "session" is
+// optional and selects a key from the /session handshake instead of the
+// built-in key.
+
+static const size_t WIFI_SETUP_MAX_BODY = 512;
+static const size_t WIFI_SETUP_CREDENTIALS_SIZE = 128;
+
+// session_id is nullptr when the request did not name a session
+typedef bool (*CredentialDecrypt)(const char *encrypted_b64, const char *session_id, char *output,
+                                  size_t output_size);
+
+struct WifiSetupReply
+{
+    int status;
+    const char *message;
+};
+
+struct WifiSetupRequest
+{
+    const void *owner;    // Transport request this context belongs to
+    ArduinoJson::Allocator *allocator; // Per-request JSON allocator, nullptr for the configured one
+    size_t received;
+    bool has_credentials; // Decrypted credentials ready for dispatch
+    char body[WIFI_SETUP_MAX_BODY + 1];
+    char credentials[WIFI_SETUP_CREDENTIALS_SIZE];
+};
+
+// allocator may be nullptr for the ArduinoJson default (heap); a
+// request's own allocator takes precedence
+void wifi_setup_configure(CredentialDecrypt decrypt, ArduinoJson::Allocator *allocator = nullptr);
+
+void wifi_setup_reset(WifiSetupRequest &req, const void *owner, ArduinoJson::Allocator *allocator = nullptr);
+
+// Feed one body chunk. Returns true once the request is complete and
+// reply is set; false while more chunks are expected.
+bool wifi_setup_feed(WifiSetupRequest &req, const uint8_t *data, size_t len, size_t index, size_t total,
+                     WifiSetupReply &reply);
+
+// Zero the body and credentials once they have been dispatched
+void wifi_setup_wipe(WifiSetupRequest &req);
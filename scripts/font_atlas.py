@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+"""Convert a BDF font into a page-aligned glyph atlas for lib/OledPanel.
+
+Usage:
+    python scripts/font_atlas.py fonts/prop8.bdf --name FONT_PROP8 --out lib/OledPanel/font_prop8
+    python scripts/font_atlas.py fonts/prop8.bdf --report      # metrics only
+    python scripts/font_atlas.py fonts/latin8.bdf --partition font.bin
+
+Each glyph is trimmed to its ink columns and stored column-major in the
+panel's native page order: for every 8-row page, one byte per column,
+LSB on top. A glyph is therefore `pages` runs of `width` bytes that the
+renderer copies straight into the framebuffer. Advances come from the
+BDF DWIDTH; kerning pairs are derived from the glyph outlines (the right
+glyph moves left by --max-kern columns where at least two blank columns
+would still separate the inks, diagonal neighbours included).
+
+The output is a .h/.cpp pair of const tables, which the toolchain places
+in flash. --partition instead writes an image for the "font" data
+partition (lib/OledPanel/glyph_store.h): every glyph in the BDF, sorted by
+code point, each stored row-major over its ink box and rasterized into
+page order on the device when first drawn.
+
+As a PlatformIO extra script (pre:) it regenerates every entry in FONTS
+whose source or this script is newer than the generated file, builds the
+PARTITION_FONT image into the build directory, and adds the target
+    pio run -e <env> -t uploadfont
+which writes that image at the font partition's offset in partitions.csv.
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+
+# Fonts built by the PlatformIO pre-script: (source, output stem, symbol)
+FONTS = [
+    ("fonts/prop8.bdf", "lib/OledPanel/font_prop8", "FONT_PROP8"),
+]
+PARTITION_FONT = "fonts/latin8.bdf"
+PARTITION_IMAGE = "font.bin"
+PARTITION_NAME = "font"
+
+# Partition image layout, little-endian; see GlyphStoreHeader/GlyphStoreEntry
+STORE_MAGIC = 0x31464C47  # "GLF1"
+STORE_HEADER = struct.Struct("<IHBBIII")
+STORE_ENTRY = struct.Struct("<IIBBBBb3x")
+
+FIRST = 0x20
+LAST = 0x7E
+MAX_KERN = 1
+SAMPLE = "The quick brown fox jumps over the lazy dog 0123456789"
+PANEL_WIDTH = 128
+FIXED_ADVANCE = 6  # FONT_5X7
+
+
+class Glyph:
+    def __init__(self, code):
+        self.code = code
+        self.advance = 0
+        self.bearing = 0
+        self.columns = []  # One int per ink column, bit r = row r from the top
+
+    def profile(self, rows):
+        """Leftmost and rightmost ink column per row, pen relative."""
+        left = [None] * rows
+        right = [None] * rows
+        for i, col in enumerate(self.columns):
+            for r in range(rows):
+                if col >> r & 1:
+                    x = self.bearing + i
+                    left[r] = x if left[r] is None else min(left[r], x)
+                    right[r] = x if right[r] is None else max(right[r], x)
+        return left, right
+
+
+def parse_bdf(path):
+    ascent = descent = None
+    glyphs = {}
+    with open(path) as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "STARTCHAR":
+            code, advance, bbx, bitmap = None, 0, (0, 0, 0, 0), []
+            for line in lines:
+                words = line.split()
+                if words[0] == "ENCODING":
+                    code = int(words[1])
+                elif words[0] == "DWIDTH":
+                    advance = int(words[1])
+                elif words[0] == "BBX":
+                    bbx = tuple(int(w) for w in words[1:5])
+                elif words[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        bitmap.append(int(line.strip(), 16) if line.strip() else 0)
+                    break
+            if code is None or code < 0:
+                continue
+            glyphs[code] = rasterize(code, advance, bbx, bitmap, ascent)
+    if ascent is None or descent is None:
+        sys.exit("%s: FONT_ASCENT and FONT_DESCENT are required" % path)
+    return glyphs, ascent + descent
+
+
+def rasterize(code, advance, bbx, bitmap, ascent):
+    w, h, xoff, yoff = bbx
+    g = Glyph(code)
+    g.advance = advance
+    row_bytes = (w + 7) // 8
+    top = ascent - (yoff + h)  # Cell row of the first bitmap row
+    columns = [0] * w
+    for by, bits in enumerate(bitmap[:h]):
+        row = top + by
+        if row < 0:
+            continue
+        for bx in range(w):
+            if bits >> (row_bytes * 8 - 1 - bx) & 1:
+                columns[bx] |= 1 << row
+    ink = [i for i, c in enumerate(columns) if c]
+    if ink:
+        g.columns = columns[ink[0]:ink[-1] + 1]
+        g.bearing = xoff + ink[0]
+    return g
+
+
+def kern_pairs(glyphs, rows, max_kern):
+    """{(left, right): adjust} for pairs that can close up."""
+    if max_kern <= 0:
+        return {}
+    profiles = {c: g.profile(rows) for c, g in glyphs.items() if g.columns}
+    pairs = {}
+    for a, (_, right_a) in profiles.items():
+        for b, (left_b, _) in profiles.items():
+            gap = None
+            for r in range(rows):
+                if right_a[r] is None:
+                    continue
+                for rr in (r - 1, r, r + 1):
+                    if 0 <= rr < rows and left_b[rr] is not None:
+                        g = glyphs[a].advance + left_b[rr] - right_a[r] - 1
+                        gap = g if gap is None else min(gap, g)
+            # Outlines that never face each other keep their spacing, and a
+            # closed-up pair still shows at least two blank columns
+            if gap is not None and gap - max_kern >= 2:
+                pairs[(a, b)] = -max_kern
+    return pairs
+
+
+def build(glyphs, rows, first, last, max_kern):
+    pages = (rows + 7) // 8
+    fallback = ord("?") if first <= ord("?") <= last else first
+    empty = Glyph(0)
+    empty.advance = glyphs[ord(" ")].advance if ord(" ") in glyphs else 3
+    pairs = kern_pairs({c: g for c, g in glyphs.items() if first <= c <= last}, rows, max_kern)
+
+    bitmaps, table, kerns = [], [], []
+    for code in range(first, last + 1):
+        g = glyphs.get(code, empty)
+        offset = len(bitmaps)
+        for p in range(pages):
+            bitmaps.extend((col >> (p * 8)) & 0xFF for col in g.columns)
+        own = sorted((b, adj) for (a, b), adj in pairs.items() if a == code)
+        table.append((offset, len(g.columns), g.bearing, g.advance, len(own), len(kerns), code))
+        kerns.extend(own)
+    if len(bitmaps) > 0xFFFF or len(kerns) > 0xFFFF:
+        sys.exit("atlas too large for 16-bit offsets")
+    return bitmaps, table, kerns, pages, fallback
+
+
+def text_width(table, kerns, first, text):
+    width = 0
+    for i, ch in enumerate(text):
+        entry = table[ord(ch) - first]
+        width += entry[3]
+        if i + 1 < len(text):
+            for right, adj in kerns[entry[5]:entry[5] + entry[4]]:
+                if right == ord(text[i + 1]):
+                    width += adj
+    return width
+
+
+def fitted_per_line(table, kerns, first, text):
+    """Characters of text that fit on one panel line, repeated as needed."""
+    count, x = 0, 0
+    while True:
+        ch = text[count % len(text)]
+        entry = table[ord(ch) - first]
+        if x + entry[2] + entry[1] > PANEL_WIDTH:
+            return count
+        nxt = text[(count + 1) % len(text)]
+        x += entry[3] + sum(adj for right, adj in kerns[entry[5]:entry[5] + entry[4]] if right == ord(nxt))
+        count += 1
+
+
+def report(name, table, kerns, bitmaps, pages, rows, first):
+    width = text_width(table, kerns, first, SAMPLE)
+    print("%s: %d glyphs, %d rows (%d page%s), %d atlas bytes, %d kerning pairs"
+          % (name, len(table), rows, pages, "" if pages == 1 else "s", len(bitmaps), len(kerns)))
+    print("  sample: %.2f px/char (fixed 5x7: %d), %d chars per %d-px line (fixed 5x7: %d)"
+          % (width / len(SAMPLE), FIXED_ADVANCE, fitted_per_line(table, kerns, first, SAMPLE), PANEL_WIDTH,
+             PANEL_WIDTH // FIXED_ADVANCE))
+
+
+def glyph_label(code):
+    if code == ord("\\"):
+        return "backslash"
+    return "space" if code == ord(" ") else chr(code)
+
+
+def write_sources(stem, symbol, source, bitmaps, table, kerns, pages, rows, first, last, fallback):
+    base = os.path.basename(stem)
+    banner = "// Generated by scripts/font_atlas.py from %s; do not edit.\n" % source.replace(os.sep, "/")
+    with open(stem + ".h", "w") as h:
+        h.write("#pragma once\n\n")
+        h.write(banner)
+        h.write("\n#include \"page_canvas.h\"\n\n")
+        h.write("// %d rows, %d glyphs 0x%02X-0x%02X\n" % (rows, last - first + 1, first, last))
+        h.write("extern const FontAtlas %s;\n" % symbol)
+    with open(stem + ".cpp", "w") as c:
+        c.write(banner)
+        c.write("#include \"%s.h\"\n\n" % base)
+        c.write("static const uint8_t bitmaps[] = {\n")
+        for entry in table:
+            offset, width = entry[0], entry[1]
+            if not width:
+                continue
+            data = bitmaps[offset:offset + width * pages]
+            c.write("    %s // %s\n" % (" ".join("0x%02X," % b for b in data), glyph_label(entry[6])))
+        c.write("};\n\n")
+        c.write("// offset, width, bearing, advance, kern_count, kern_first\n")
+        c.write("static const AtlasGlyph glyphs[] = {\n")
+        for offset, width, bearing, advance, count, kfirst, code in table:
+            c.write("    {%d, %d, %d, %d, %d, %d}, // %s\n" % (offset, width, bearing, advance, count, kfirst,
+                                                            glyph_label(code)))
+        c.write("};\n\n")
+        c.write("// Right glyph, adjustment; grouped by left glyph\n")
+        c.write("static const AtlasKern kerns[] = {\n")
+        for i in range(0, len(kerns), 8):
+            c.write("    %s\n" % " ".join("{0x%02X, %d}," % k for k in kerns[i:i + 8]))
+        if not kerns:
+            c.write("    {0, 0},\n")
+        c.write("};\n\n")
+        c.write("const FontAtlas %s = {bitmaps, glyphs, kerns, 0x%02X, 0x%02X, %d, %d, 0x%02X};\n"
+                % (symbol, first, last, pages, rows, fallback))
+
+
+def write_partition(path, glyphs, rows):
+    """Glyph store image: header, sorted index, row-major ink boxes."""
+    index, bitmaps = [], bytearray()
+    for code in sorted(glyphs):
+        g = glyphs[code]
+        if code > 0x10FFFF:
+            continue
+        ink = [r for r in range(rows) if any(col >> r & 1 for col in g.columns)]
+        top = ink[0] if ink else 0
+        height = ink[-1] - top + 1 if ink else 0
+        width = len(g.columns)
+        if width > 255 or g.advance > 255:
+            sys.exit("U+%04X is too wide for the glyph store" % code)
+        index.append(STORE_ENTRY.pack(code, len(bitmaps), width, height, top, g.advance, g.bearing))
+        row_bytes = (width + 7) // 8
+        for r in range(top, top + height):
+            bits = 0
+            for i, col in enumerate(g.columns):
+                if col >> r & 1:
+                    bits |= 1 << (row_bytes * 8 - 1 - i)
+            bitmaps += bits.to_bytes(row_bytes, "big")
+    index_offset = STORE_HEADER.size
+    bitmap_offset = index_offset + len(index) * STORE_ENTRY.size
+    size = bitmap_offset + len(bitmaps)
+    with open(path, "wb") as f:
+        f.write(STORE_HEADER.pack(STORE_MAGIC, len(index), rows, rows, index_offset, bitmap_offset, size))
+        f.write(b"".join(index))
+        f.write(bitmaps)
+    return len(index), size
+
+
+def convert(source, stem, symbol, first=FIRST, last=LAST, max_kern=MAX_KERN, quiet=False):
+    glyphs, rows = parse_bdf(source)
+    bitmaps, table, kerns, pages, fallback = build(glyphs, rows, first, last, max_kern)
+    if stem:
+        write_sources(stem, symbol, source, bitmaps, table, kerns, pages, rows, first, last, fallback)
+    if not quiet:
+        report(symbol, table, kerns, bitmaps, pages, rows, first)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="BDF to page-aligned glyph atlas")
+    parser.add_argument("bdf")
+    parser.add_argument("--name", default="FONT_ATLAS", help="C++ symbol of the FontAtlas")
+    parser.add_argument("--out", help="output path without extension; omit to only report")
+    parser.add_argument("--first", type=lambda v: int(v, 0), default=FIRST)
+    parser.add_argument("--last", type=lambda v: int(v, 0), default=LAST)
+    parser.add_argument("--max-kern", type=int, default=MAX_KERN, help="0 disables kerning")
+    parser.add_argument("--report", action="store_true", help="print metrics without writing")
+    parser.add_argument("--partition", help="write a font partition image instead of C++ tables")
+    args = parser.parse_args()
+    if args.partition:
+        glyphs, rows = parse_bdf(args.bdf)
+        count, size = write_partition(args.partition, glyphs, rows)
+        print("%s: %d glyphs, %d bytes" % (args.partition, count, size))
+        return
+    convert(args.bdf, None if args.report else args.out, args.name, args.first, args.last, args.max_kern)
+
+
+def partition_offset(table, name):
+    with open(table) as f:
+        for line in f:
+            fields = [v.strip() for v in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == name:
+                return int(fields[3], 0)
+    sys.exit("%s: no %s partition" % (table, name))
+
+
+def stale(source, out, script):
+    if not os.path.exists(out):
+        return True
+    newest = max(os.path.getmtime(source), os.path.getmtime(script))
+    return os.path.getmtime(out) < newest
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        main()
+else:
+    project = env.subst("$PROJECT_DIR")  # noqa: F821
+    script = os.path.join(project, "scripts", "font_atlas.py")
+    for source, stem, symbol in FONTS:
+        source, stem = os.path.join(project, source), os.path.join(project, stem)
+        if stale(source, stem + ".cpp", script):
+            print("font_atlas: %s -> %s" % (os.path.relpath(source, project), os.path.relpath(stem, project)))
+            convert(source, stem, symbol)
+
+    build_dir = env.subst("$BUILD_DIR")  # noqa: F821
+    image = os.path.join(build_dir, PARTITION_IMAGE)
+    source = os.path.join(project, PARTITION_FONT)
+    if stale(source, image, script):
+        os.makedirs(build_dir, exist_ok=True)
+        glyphs, rows = parse_bdf(source)
+        count, size = write_partition(image, glyphs, rows)
+        print("font_atlas: %s -> %s (%d glyphs, %d bytes)" % (PARTITION_FONT, PARTITION_IMAGE, count, size))
+
+    def upload_font(target, source, env):
+        offset = partition_offset(os.path.join(project, "partitions.csv"), PARTITION_NAME)
+        cmd = [env.subst("$PYTHONEXE"), env.subst("$UPLOADER"), "--chip", env.subst("$BOARD_MCU")]
+        if env.subst("$UPLOAD_PORT"):
+            cmd += ["--port", env.subst("$UPLOAD_PORT")]
+        return subprocess.call(cmd + ["write_flash", hex(offset), image])
+
+    env.AddCustomTarget(  # noqa: F821
+        name="uploadfont",
+        dependencies=None,
+        actions=[upload_font],
+        title="Upload font partition",
+        description="Write %s to the %s partition" % (PARTITION_IMAGE, PARTITION_NAME),
+    )
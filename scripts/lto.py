@@ -0,0 +1,5 @@
+# PlatformIO extra script: pass -flto through to the link step as well.
+# build_flags only reach the compiler, and LTO needs both halves.
+Import("env")
+
+env.Append(LINKFLAGS=["-flto=auto"])
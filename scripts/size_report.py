@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Build each firmware profile and report flash/IRAM/DRAM usage per section.
+
+Usage:
+    python scripts/size_report.py                      # all profiles
+    python scripts/size_report.py release-size debug   # selected profiles
+    python scripts/size_report.py --no-build           # reuse .pio/build output
+    python scripts/size_report.py --bench "pio test -e native"
+
+--bench runs the given command once per profile with PROFILE=<env> in the
+environment and appends its output, so latency numbers sit next to the
+size numbers for the same build.
+"""
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+PROFILES = ["esp32dev", "release-speed", "release-size", "debug"]
+
+# Fallback when partitions.csv has no app0 row: the 3.2 MB OTA slot of
+# the 8 MB layout
+DEFAULT_APP_PARTITION = 0x330000
+
+# Section name prefix -> memory region
+REGIONS = [
+    (".iram0", "IRAM"),
+    (".dram0", "DRAM"),
+    (".flash.text", "FLASH"),
+    (".flash.rodata", "FLASH"),
+    (".flash.appdesc", "FLASH"),
+    (".flash", "FLASH"),
+    (".rtc", "RTC"),
+    (".ext_ram", "PSRAM"),
+]
+
+# Sections that occupy RAM but not flash
+NOLOAD = (".dram0.bss", ".iram0.bss", ".rtc.bss", ".rtc_noinit", ".ext_ram.bss", ".noinit")
+
+
+def app_partition_size(table, name="app0"):
+    """Size of the named partition in partitions.csv, as flashed."""
+    try:
+        with open(table) as f:
+            for line in f:
+                fields = [v.strip() for v in line.split("#")[0].split(",")]
+                if len(fields) >= 5 and fields[0] == name:
+                    return int(fields[4], 0)
+    except OSError:
+        pass
+    return DEFAULT_APP_PARTITION
+
+
+def find_size_tool():
+    home = os.path.expanduser("~/.platformio/packages")
+    for pattern in ("toolchain-xtensa-esp32s3/bin/xtensa-esp32s3-elf-size",
+                    "toolchain-xtensa-esp-elf/bin/xtensa-esp32s3-elf-size",
+                    "toolchain-*/bin/*-elf-size"):
+        matches = glob.glob(os.path.join(home, pattern))
+        if matches:
+            return matches[0]
+    sys.exit("size tool not found; build once with `pio run` to install the toolchain")
+
+
+def region_of(section):
+    for prefix, region in REGIONS:
+        if section.startswith(prefix):
+            return region
+    return None
+
+
+def read_sections(size_tool, elf):
+    out = subprocess.run([size_tool, "-A", elf], check=True, capture_output=True, text=True).stdout
+    sections = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].startswith(".") and parts[1].isdigit():
+            region = region_of(parts[0])
+            if region and int(parts[1]) > 0:
+                sections.append((parts[0], region, int(parts[1])))
+    return sections
+
+
+def report(profile, sections, app_partition):
+    print(f"\n== {profile} ==")
+    print(f"{'section':<28}{'region':<8}{'bytes':>10}")
+    totals = {}
+    image = 0
+    for name, region, size in sections:
+        print(f"{name:<28}{region:<8}{size:>10}")
+        totals[region] = totals.get(region, 0) + size
+        if not name.startswith(NOLOAD):
+            image += size
+    print("-" * 46)
+    for region in sorted(totals):
+        print(f"{'total':<28}{region:<8}{totals[region]:>10}")
+    print(f"{'image (approx)':<36}{image:>10}")
+    print(f"{'OTA slot headroom':<36}{app_partition - image:>10}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("profiles", nargs="*", default=PROFILES)
+    parser.add_argument("--no-build", action="store_true", help="reuse existing build output")
+    parser.add_argument("--app-partition", type=lambda s: int(s, 0),
+                        help="app partition size in bytes (default: app0 in partitions.csv)")
+    parser.add_argument("--bench", metavar="CMD", help="benchmark command to run per profile")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    if args.app_partition is None:
+        args.app_partition = app_partition_size(os.path.join(root, "partitions.csv"))
+    size_tool = None
+    for profile in args.profiles:
+        if not args.no_build:
+            subprocess.run(["pio", "run", "-e", profile], check=True, cwd=root)
+        elf = os.path.join(root, ".pio", "build", profile, "firmware.elf")
+        if not os.path.exists(elf):
+            print(f"\n== {profile} ==\nno firmware.elf (build it first)")
+            continue
+        size_tool = size_tool or find_size_tool()
+        report(profile, read_sections(size_tool, elf), args.app_partition)
+        if args.bench:
+            result = subprocess.run(args.bench, shell=True, cwd=root, capture_output=True, text=True,
+                                    env=dict(os.environ, PROFILE=profile))
+            print(f"-- benchmark ({args.bench}) --")
+            print(result.stdout.rstrip())
+
+
+if __name__ == "__main__":
+    main()
@@ -1,30 +1,30 @@
-#include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
 #include <Arduino.h>
-#include <mbedtls/aes.h>
-#include <mbedtls/base64.h>
-#include <WiFi.h>
 #include <ESPAsyncWebServer.h>
-#include <Preferences.h>
-#include <ArduinoJson.h>
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "boot_button.h"
+#include "power_manager.h"
+#include "static_alloc.h"
+#include "diagnostics.h"
+#include "mem_placement.h"
+#include "credential_store.h"
+#include "display_renderer.h"
+#include "wifi_controller.h"
+#include "http_api.h"
+#include "boot_profiler.h"
+#include "logger.h"
+#include "ota_update.h"
+#include "fleet_link.h"
+#include "event_bus.h"
+#include "lifecycle.h"
 
 // ===========================================================
 // OLED Display & I2C Configuration
 // ===========================================================
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 32
-#define OLED_RESET -1
-#define SCREEN_ADDRESS 0x3C
 
 // ESP32 I2C Pins
 #define SDA_PIN 42
 #define SCL_PIN 41
 
-// Instantiate OLED display and web server objects
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 AsyncWebServer server(80);
 
 // ===========================================================
@@ -38,82 +38,26 @@ const uint8_t AES_KEY[16] = {'t', 'h', 'i', 's', 'i', 's', 'm', 'y', 'p', 'a', '
 const char *ap_ssid = "ESP32-Setup";
 const char *ap_password = "12345678";
 
-// ===========================================================
-// Boot Button (GPIO0) for long-press actions
-// ===========================================================
-const int bootButtonPin = 0;
-unsigned long pressStartTime = 0;
+// ESP-NOW fleet group this unit answers to, besides its own MAC
+const uint8_t fleet_group = 0;
 
 // ===========================================================
-// Utility Functions
+// Boot Button (GPIO0) for gesture actions
 // ===========================================================
-
-bool decrypt_wifi_credentials(const char *encrypted_b64, char *output, size_t output_size)
-{
-    uint8_t encrypted_data[64];
-    size_t encrypted_len = 0;
-    if (mbedtls_base64_decode(encrypted_data, sizeof(encrypted_data), &encrypted_len,
-                              (const uint8_t *)encrypted_b64, strlen(encrypted_b64)) != 0)
-    {
-        Serial.println("Base64 decode failed");
-        return false;
-    }
-    if (encrypted_len < 16)
-    {
-        Serial.println("Encrypted data too short");
-        return false;
-    }
-    uint8_t iv[16];
-    memcpy(iv, encrypted_data, 16);
-    uint8_t *ciphertext = encrypted_data + 16;
-    size_t ciphertext_len = encrypted_len - 16;
-    if (ciphertext_len >= output_size)
-    {
-        Serial.println("Decrypted output buffer too small");
-        return false;
-    }
-    mbedtls_aes_context aes;
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_dec(&aes, AES_KEY, 128);
-    mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_DECRYPT, ciphertext_len, iv, ciphertext, (uint8_t *)output);
-    output[ciphertext_len] = '\0';
-    mbedtls_aes_free(&aes);
-    Serial.printf("Decrypted output: [%s]\n", output);
-    return true;
-}
-
-void clean_string(char *str)
-{
-    int len = strlen(str);
-    int i = 0, j = 0;
-    while (i < len)
-    {
-        if (str[i] > 0x1F && str[i] < 0x7F)
-        {
-            str[j++] = str[i];
-        }
-        i++;
-    }
-    str[j] = '\0';
-}
+const int bootButtonPin = 0;
 
 // ===========================================================
 // Factory Reset Function
 // ===========================================================
 void factory_reset()
 {
-    Serial.println("Performing factory reset...");
+    LOG_INFO("Performing factory reset...");
     // Clear stored WiFi credentials
-    Preferences preferences;
-    preferences.begin("wifi", false);
-    preferences.clear();
-    preferences.end();
+    credential_store_clear();
 
     // Display factory reset message
-    display.clearDisplay();
-    display.setCursor(0, 0);
-    display.println("Factory Reset");
-    display.display();
+    display_show_lines("Factory Reset");
+    logger_flush();
     delay(2000);
 
     // Restart the device
@@ -121,146 +65,61 @@ void factory_reset()
 }
 
 // ===========================================================
-// WiFi Connection Task
+// Lifecycle Entry Actions
 // ===========================================================
-void connectToWiFi(void *parameter)
+// Also entered after a failed provisioning join, which leaves the radio
+// in station mode, so the AP is (re)started every time
+static void enter_ap_mode(LifecycleState from, LifecycleInput input)
 {
-    char *credentials = (char *)parameter;
-    if (!credentials)
-    {
-        Serial.println("Memory allocation failed for credentials!");
-        vTaskDelete(NULL);
-        return;
-    }
-    Serial.printf("Raw Credentials String: [%s]\n", credentials);
-    char wifi_ssid[64], wifi_password[64];
-    if (sscanf(credentials, "%63[^|]|%63s", wifi_ssid, wifi_password) != 2)
-    {
-        Serial.println("Invalid WiFi data format!");
-        free(parameter);
-        vTaskDelete(NULL);
-        return;
-    }
-    wifi_ssid[63] = '\0';
-    wifi_password[63] = '\0';
-    clean_string(wifi_ssid);
-    clean_string(wifi_password);
-    WiFi.disconnect();
-    delay(1000);
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(wifi_ssid, wifi_password);
-    Serial.print("Connecting to WiFi");
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20)
-    {
-        vTaskDelay(pdMS_TO_TICKS(500));
-        Serial.print(".");
-        attempts++;
-    }
-    Serial.println();
-    if (WiFi.status() == WL_CONNECTED)
-    {
-        Serial.printf("Connected to WiFi: %s\n", WiFi.SSID().c_str());
-        IPAddress localIP = WiFi.localIP();
-        Serial.printf("Local IP Address: %s\n", localIP.toString().c_str());
-        display.clearDisplay();
-        display.setCursor(0, 0);
-        display.println("Connected:");
-        display.println(wifi_ssid);
-        display.print("IP: ");
-        display.println(localIP.toString());
-        display.display();
-        Preferences preferences;
-        preferences.begin("wifi", false);
-        preferences.putString("ssid", wifi_ssid);
-        preferences.putString("password", wifi_password);
-        preferences.end();
-    }
-    else
-    {
-        Serial.println("WiFi connection failed.");
-    }
-    free(parameter);
-    vTaskDelete(NULL);
+    LOG_INFO("Lifecycle: %s -> ap (%s)", lifecycle_state_name(from), lifecycle_input_name(input));
+    wifi_start_ap(ap_ssid, ap_password);
 }
 
-// ===========================================================
-// HTTP Request Handlers
-// ===========================================================
-void handle_wifi_setup(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+static void enter_reset(LifecycleState, LifecycleInput)
 {
-    Serial.println("Received WiFi setup request...");
-    StaticJsonDocument<200> jsonDoc;
-    DeserializationError error = deserializeJson(jsonDoc, (const char *)data);
-    if (error)
-    {
-        Serial.println("JSON Parsing Failed!");
-        request->send(400, "text/plain", "Invalid JSON");
-        return;
-    }
-    if (!jsonDoc.containsKey("data"))
-    {
-        Serial.println("Missing 'data' parameter");
-        request->send(400, "text/plain", "Missing 'data' parameter");
-        return;
-    }
-    String encrypted_data = jsonDoc["data"].as<String>();
-    char decrypted[128];
-    if (!decrypt_wifi_credentials(encrypted_data.c_str(), decrypted, sizeof(decrypted)))
-    {
-        Serial.println("Decryption failed");
-        request->send(400, "text/plain", "Decryption Failed");
-        return;
-    }
-    Serial.printf("Decrypted String: [%s]\n", decrypted);
-    request->send(200, "text/plain", "WiFi Credentials Processing...");
-    delay(1000);
-    xTaskCreate(connectToWiFi, "ConnectToWiFi", 4096, strdup(decrypted), 1, NULL);
+    factory_reset();
 }
 
-// ===========================================================
-// New HTTP GET Endpoint to Display a Message
-// ===========================================================
-void handle_display_message(AsyncWebServerRequest *request)
+static void request_reset()
 {
-    String msg = "";
-    if (request->hasParam("msg"))
-    {
-        msg = request->getParam("msg")->value();
-    }
-    display.clearDisplay();
-
-    // Calculate the text dimensions
-    int16_t x1, y1;
-    uint16_t w, h;
-    display.getTextBounds(msg, 0, 0, &x1, &y1, &w, &h);
-
-    // Compute centered positions
-    int x = (SCREEN_WIDTH - w) / 2;
-    int y = (SCREEN_HEIGHT - h) / 2;
-
-    display.setCursor(x, y);
-    display.println(msg);
-    display.display();
-
-    request->send(200, "text/plain", "Displayed: " + msg);
+    lifecycle_dispatch(LifecycleInput::ResetRequested, millis());
 }
 
 // ===========================================================
-// Access Point Mode Setup
+// Event Handling (loop task)
 // ===========================================================
-void start_ap_mode()
+static EventSubscription uiEvents = -1;
+
+static void handle_event(const BusEvent &event)
 {
-    Serial.println("Starting AP Mode...");
-    WiFi.softAP(ap_ssid, ap_password);
-    IPAddress apIP = WiFi.softAPIP();
-    Serial.print("AP IP Address: ");
-    Serial.println(apIP);
-    display.clearDisplay();
-    display.setCursor(0, 0);
-    display.println("AP Mode Active");
-    display.println(apIP.toString());
-    display.display();
+    switch (event.type)
+    {
+    case BusEventType::ButtonGesture:
+        boot_button_dispatch(event.gesture);
+        break;
+    case BusEventType::DisplayRequest:
+        display_handle_request(event);
+        break;
+    case BusEventType::CredentialsReceived:
+        display_show_lines("Credentials received",
+                           event.source == CredentialSource::Fleet ? "via ESP-NOW" : "via HTTP", "Connecting...");
+        lifecycle_dispatch(LifecycleInput::Credentials, millis());
+        break;
+    case BusEventType::Connected:
+        LOG_INFO("Bus: connected, IP %u.%u.%u.%u", (unsigned)(event.ipv4 & 0xff), (unsigned)((event.ipv4 >> 8) & 0xff),
+                 (unsigned)((event.ipv4 >> 16) & 0xff), (unsigned)(event.ipv4 >> 24));
+        lifecycle_dispatch(LifecycleInput::JoinOk, millis());
+        break;
+    case BusEventType::ConnectFailed:
+        lifecycle_dispatch(LifecycleInput::JoinFailed, millis());
+        break;
+    case BusEventType::Disconnected:
+        LOG_WARN("Bus: station disconnected, reason %u", (unsigned)event.reason);
+        lifecycle_dispatch(LifecycleInput::Disconnected, millis());
+        break;
+    default:
+        break;
+    }
 }
 
 // ===========================================================
@@ -268,94 +127,114 @@ void start_ap_mode()
 // ===========================================================
 void setup()
 {
+    boot_profile_start();
+    placement_mark_boot();
+    boot_profile_begin(BootPhase::SerialInit);
     Serial.begin(115200);
-    Wire.begin(SDA_PIN, SCL_PIN);
-    if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS))
+    logger_begin();
+    boot_profile_end(BootPhase::SerialInit);
+    boot_profile_begin(BootPhase::DisplayInit);
+    if (!display_begin(SDA_PIN, SCL_PIN))
     {
-        Serial.println(F("SSD1306 allocation failed"));
+        LOG_ERROR("SSD1306 allocation failed");
+        logger_flush();
         while (true)
             ;
     }
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    display.setCursor(0, 0);
-    display.println("Booting...");
-    display.display();
-    pinMode(bootButtonPin, INPUT_PULLUP);
-
-    // Check for stored WiFi credentials
-    Preferences preferences;
-    preferences.begin("wifi", true);
-    String storedSSID = preferences.getString("ssid", "");
-    String storedPassword = preferences.getString("password", "");
-    preferences.end();
-
-    if (storedSSID != "" && storedPassword != "")
-    {
-        Serial.println("Stored credentials found. Connecting to WiFi...");
-        WiFi.mode(WIFI_STA);
-        WiFi.begin(storedSSID.c_str(), storedPassword.c_str());
-        Serial.print("Connecting");
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < 20)
-        {
-            delay(500);
-            Serial.print(".");
-            attempts++;
-        }
-        Serial.println();
-        if (WiFi.status() == WL_CONNECTED)
+    display_show_lines("Booting...");
+    boot_profile_end(BootPhase::DisplayInit);
+
+    // setup() and loop() share the loop task, so it subscribes here
+    uiEvents = event_bus_subscribe("ui", EVENT_MASK(BusEventType::ButtonGesture) |
+                                             EVENT_MASK(BusEventType::DisplayRequest) |
+                                             EVENT_MASK(BusEventType::CredentialsReceived) |
+                                             EVENT_MASK(BusEventType::Connected) |
+                                             EVENT_MASK(BusEventType::Disconnected) |
+                                             EVENT_MASK(BusEventType::ConnectFailed));
+    lifecycle_on_enter(LifecycleState::ApMode, enter_ap_mode);
+    lifecycle_on_enter(LifecycleState::Reset, enter_reset);
+
+    // Holding the boot button for 5 seconds triggers a factory reset
+    boot_button_begin(bootButtonPin);
+    boot_button_set_action(ButtonGesture::VeryLongPress, request_reset);
+    // A short press dumps power lock statistics to serial
+    boot_button_set_action(ButtonGesture::ShortPress, power_manager_print_stats);
+    // A double press reports heap allocations made since boot
+    boot_button_set_action(ButtonGesture::DoublePress, alloc_guard_report);
+
+    // Light sleep between events (tickless cores only); the boot button
+    // arms its pin as a wake source
+    power_manager_begin();
+    power_manager_enable_gpio_wakeup();
+
+    // Try stored WiFi credentials, fall back to provisioning over the AP
+    WifiCredentials stored;
+    boot_profile_begin(BootPhase::PrefsRead);
+    bool have_stored = credential_store_load(stored);
+    boot_profile_end(BootPhase::PrefsRead);
+    if (have_stored)
+    {
+        lifecycle_dispatch(LifecycleInput::StoredFound, millis());
+        LOG_INFO("Stored credentials found. Connecting to WiFi...");
+        boot_profile_begin(BootPhase::WifiConnect);
+        bool connected = wifi_join(stored);
+        boot_profile_end(BootPhase::WifiConnect);
+        wipe_credentials(stored);
+        if (connected)
         {
-            Serial.printf("Connected to WiFi: %s\n", WiFi.SSID().c_str());
-            IPAddress localIP = WiFi.localIP();
-            Serial.printf("Local IP Address: %s\n", localIP.toString().c_str());
-            display.clearDisplay();
-            display.setCursor(0, 0);
-            display.println("Connected:");
-            display.println(storedSSID);
-            display.print("IP: ");
-            display.println(localIP.toString());
-            display.display();
+            lifecycle_dispatch(LifecycleInput::JoinOk, millis());
         }
         else
         {
-            Serial.println("Failed to connect using stored credentials. Starting AP mode...");
-            start_ap_mode();
+            LOG_WARN("Failed to connect using stored credentials. Starting AP mode...");
+            boot_profile_begin(BootPhase::ApStart);
+            lifecycle_dispatch(LifecycleInput::JoinFailed, millis());
+            boot_profile_end(BootPhase::ApStart);
         }
     }
     else
     {
-        Serial.println("No stored credentials. Starting AP mode...");
-        start_ap_mode();
+        LOG_INFO("No stored credentials. Starting AP mode...");
+        boot_profile_begin(BootPhase::ApStart);
+        lifecycle_dispatch(LifecycleInput::NoStored, millis());
+        boot_profile_end(BootPhase::ApStart);
     }
 
+    wifi_controller_begin();
+    // Sample every 10 s and print each snapshot to serial
+    diagnostics_begin(10000, true);
+    ota_update_begin();
+
     // Set up HTTP endpoints
-    server.on("/set_wifi", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, handle_wifi_setup);
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-              { request->send(200, "text/plain", "Hello, world!"); });
-    // New endpoint: /display?msg=your_message_here
-    server.on("/display", HTTP_GET, handle_display_message);
+    boot_profile_begin(BootPhase::ServerBegin);
+    http_api_begin(server, AES_KEY);
     server.begin();
+    // After http_api_begin: fleet frames decrypt through the same key ring
+    fleet_link_begin(fleet_group, decrypt_wifi_credentials);
+    boot_profile_end(BootPhase::ServerBegin);
+    boot_profile_reachable();
+    boot_profile_print();
+
+    // Internal RAM headroom after boot, against the mark taken on entry
+    placement_report();
+
+    // Boot is complete: from here on any heap allocation is flagged
+    alloc_guard_arm();
 }
 
 void loop()
 {
-    // Monitor boot button (GPIO0) for a long press (5 seconds) to trigger factory reset
-    if (digitalRead(bootButtonPin) == LOW)
+    // Gestures, display requests and Wi-Fi changes all arrive on the bus;
+    // the wait ends early for a lifecycle deadline (rejoin after a drop)
+    uint32_t timeout_ms = lifecycle_timeout_ms(millis());
+    TickType_t wait = timeout_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    BusEvent event;
+    if (event_bus_receive(uiEvents, event, wait))
     {
-        if (pressStartTime == 0)
-        {
-            pressStartTime = millis();
-        }
-        else if (millis() - pressStartTime >= 5000)
-        {
-            factory_reset();
-        }
+        handle_event(event);
     }
-    else
+    if (lifecycle_poll(millis()))
     {
-        pressStartTime = 0;
+        LOG_WARN("Lifecycle: no rejoin within %u ms", (unsigned)LIFECYCLE_REJOIN_MS);
     }
-    delay(100);
 }
@@ -0,0 +1,110 @@
+// Host tests for lib/Credentials: "ssid|password" parsing, field limits
+// and the printable-ASCII filter. Run: pio test -e native
+
+#include <unity.h>
+#include <string.h>
+#include "credentials.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_parse_ssid_and_password()
+{
+    WifiCredentials creds;
+    TEST_ASSERT_TRUE(parse_credentials("MyNet|secret123", creds));
+    TEST_ASSERT_EQUAL_STRING("MyNet", creds.ssid);
+    TEST_ASSERT_EQUAL_STRING("secret123", creds.password);
+}
+
+void test_ssid_may_contain_spaces()
+{
+    WifiCredentials creds;
+    TEST_ASSERT_TRUE(parse_credentials("Office 5G|pw", creds));
+    TEST_ASSERT_EQUAL_STRING("Office 5G", creds.ssid);
+}
+
+void test_missing_fields_are_rejected()
+{
+    WifiCredentials creds;
+    TEST_ASSERT_FALSE(parse_credentials("", creds));
+    TEST_ASSERT_FALSE(parse_credentials("MyNet", creds));
+    TEST_ASSERT_FALSE(parse_credentials("MyNet|", creds));
+    TEST_ASSERT_FALSE(parse_credentials("|secret", creds));
+}
+
+void test_zero_padding_ends_the_password()
+{
+    // Decrypted envelopes are zero-padded to whole blocks
+    const char padded[] = "MyNet|secret123\0\0\0\0";
+    WifiCredentials creds;
+    TEST_ASSERT_TRUE(parse_credentials(padded, creds));
+    TEST_ASSERT_EQUAL_STRING("secret123", creds.password);
+}
+
+void test_field_length_limits()
+{
+    char raw[2 * CREDENTIAL_FIELD_SIZE + 8];
+    WifiCredentials creds;
+
+    // A 63-byte ssid is the longest that fits
+    memset(raw, 's', CREDENTIAL_FIELD_SIZE - 1);
+    strcpy(raw + CREDENTIAL_FIELD_SIZE - 1, "|pw");
+    TEST_ASSERT_TRUE(parse_credentials(raw, creds));
+    TEST_ASSERT_EQUAL_UINT(CREDENTIAL_FIELD_SIZE - 1, strlen(creds.ssid));
+
+    // One more and the separator is not where the parser expects it
+    memset(raw, 's', CREDENTIAL_FIELD_SIZE);
+    strcpy(raw + CREDENTIAL_FIELD_SIZE, "|pw");
+    TEST_ASSERT_FALSE(parse_credentials(raw, creds));
+
+    // An over-long password is cut at 63 bytes
+    strcpy(raw, "n|");
+    memset(raw + 2, 'p', CREDENTIAL_FIELD_SIZE + 4);
+    raw[2 + CREDENTIAL_FIELD_SIZE + 4] = '\0';
+    TEST_ASSERT_TRUE(parse_credentials(raw, creds));
+    TEST_ASSERT_EQUAL_UINT(CREDENTIAL_FIELD_SIZE - 1, strlen(creds.password));
+}
+
+void test_non_printable_bytes_are_stripped()
+{
+    WifiCredentials creds;
+    TEST_ASSERT_TRUE(parse_credentials("My\x01Net\x7f|pa\tss", creds));
+    TEST_ASSERT_EQUAL_STRING("MyNet", creds.ssid);
+    TEST_ASSERT_EQUAL_STRING("pa", creds.password); // %s stops at the tab
+}
+
+void test_clean_string()
+{
+    char text[] = "\x1f" "Caf\xc3\xa9 \x7e\x7f";
+    clean_string(text);
+    TEST_ASSERT_EQUAL_STRING("Caf ~", text);
+    char empty[] = "\x01\x02\x03";
+    clean_string(empty);
+    TEST_ASSERT_EQUAL_STRING("", empty);
+}
+
+void test_wipe_credentials()
+{
+    WifiCredentials creds;
+    TEST_ASSERT_TRUE(parse_credentials("MyNet|secret123", creds));
+    wipe_credentials(creds);
+    const uint8_t *bytes = (const uint8_t *)&creds;
+    for (size_t i = 0; i < sizeof(creds); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(0, bytes[i]);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_ssid_and_password);
+    RUN_TEST(test_ssid_may_contain_spaces);
+    RUN_TEST(test_missing_fields_are_rejected);
+    RUN_TEST(test_zero_padding_ends_the_password);
+    RUN_TEST(test_field_length_limits);
+    RUN_TEST(test_non_printable_bytes_are_stripped);
+    RUN_TEST(test_clean_string);
+    RUN_TEST(test_wipe_credentials);
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+// Host round trip: rows encoded by the batch encoder (lib/BatchEncoder,
+// the code behind tools/encoder) must decrypt with the firmware's
+// envelope_decrypt_keyring and parse back to the same credentials, for
+// every key id, every padding boundary and the longest envelope.
+// Run: pio test -e native
+
+#include <unity.h>
+#include <string.h>
+#include "batch_encoder.h"
+#include "credentials.h"
+
+static const uint8_t iv[ENVELOPE_IV_SIZE] = {0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+                                             0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+
+static EnvelopeKeyRing ring;
+
+void setUp()
+{
+    envelope_keyring_init(ring);
+}
+
+void tearDown()
+{
+    envelope_keyring_free(ring);
+}
+
+static DeviceRow make_row(const char *line)
+{
+    DeviceRow row;
+    TEST_ASSERT_TRUE(encoder_split_row(line, 1, row));
+    return row;
+}
+
+// Row with an ssid|password plaintext of exactly len bytes
+static DeviceRow row_of_length(size_t len)
+{
+    std::string password(len - 5, 'p'); // "ssid|" is 5 bytes
+    return make_row(("dev,ssid," + password).c_str());
+}
+
+static std::string encode(const EncoderKey &key, const DeviceRow &row)
+{
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, key.key, 128);
+    std::string payload;
+    TEST_ASSERT_EQUAL(EnvelopeError::None, encoder_encrypt_row(enc, key, iv, row, payload));
+    mbedtls_aes_free(&enc);
+    return payload;
+}
+
+// ===========================================================
+// Key Ids
+// ===========================================================
+
+void test_every_key_id_round_trips()
+{
+    DeviceRow row = make_row("rack-7,Office-5G,correct-horse");
+    TEST_ASSERT_NULL(encoder_validate(row));
+    for (int id = ENVELOPE_NO_KEY_ID; id < (int)ENVELOPE_KEY_SLOTS; id++)
+    {
+        EncoderKey key;
+        for (size_t i = 0; i < ENVELOPE_KEY_SIZE; i++)
+        {
+            key.key[i] = (uint8_t)(id * 31 + i);
+        }
+        key.id = id;
+        std::string payload = encode(key, row);
+        uint8_t slot = id == ENVELOPE_NO_KEY_ID ? 0 : (uint8_t)id;
+        // Only the named slot decrypts it
+        TEST_ASSERT_FALSE(encoder_verify_row(ring, row, payload));
+        envelope_keyring_set(ring, slot, key.key);
+        TEST_ASSERT_TRUE(encoder_verify_row(ring, row, payload));
+        envelope_keyring_remove(ring, slot);
+    }
+}
+
+void test_demo_key_matches_firmware_slot_0()
+{
+    EncoderKey key;
+    TEST_ASSERT_TRUE(encoder_parse_key("7468697369736d7970617373776f7264", key));
+    TEST_ASSERT_EQUAL_INT(ENVELOPE_NO_KEY_ID, key.id);
+    TEST_ASSERT_EQUAL_MEMORY(ENCODER_DEMO_KEY, key.key, ENVELOPE_KEY_SIZE);
+}
+
+void test_parse_key_with_id()
+{
+    EncoderKey key;
+    TEST_ASSERT_TRUE(encoder_parse_key("7:000102030405060708090a0b0c0d0e0f", key));
+    TEST_ASSERT_EQUAL_INT(7, key.id);
+    TEST_ASSERT_EQUAL_UINT8(0x0f, key.key[15]);
+    EncoderKey untouched = key;
+    TEST_ASSERT_FALSE(encoder_parse_key("8:000102030405060708090a0b0c0d0e0f", key));
+    TEST_ASSERT_FALSE(encoder_parse_key("000102030405060708090a0b0c0d0e", key));
+    TEST_ASSERT_FALSE(encoder_parse_key("zz0102030405060708090a0b0c0d0e0f", key));
+    TEST_ASSERT_EQUAL_MEMORY(&untouched, &key, sizeof(key));
+}
+
+// ===========================================================
+// Padding and Length
+// ===========================================================
+
+void test_padding_boundaries_round_trip()
+{
+    EncoderKey key;
+    TEST_ASSERT_TRUE(encoder_parse_key("3:000102030405060708090a0b0c0d0e0f", key));
+    envelope_keyring_set(ring, 3, key.key);
+    const size_t lengths[] = {7, 15, 16, 17, 31, 32, 33, 47, 48};
+    for (size_t len : lengths)
+    {
+        DeviceRow row = row_of_length(len);
+        TEST_ASSERT_EQUAL_UINT(len, row.plaintext.size());
+        TEST_ASSERT_NULL(encoder_validate(row));
+        std::string payload = encode(key, row);
+        TEST_ASSERT_TRUE(encoder_verify_row(ring, row, payload));
+        // Zero padding to whole blocks, behind the key id and IV
+        EnvelopeData data;
+        TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decode(payload.c_str(), data));
+        size_t blocks = (len + ENVELOPE_IV_SIZE - 1) / ENVELOPE_IV_SIZE;
+        TEST_ASSERT_EQUAL_UINT(1 + ENVELOPE_IV_SIZE + blocks * ENVELOPE_IV_SIZE, data.len);
+    }
+}
+
+void test_longest_envelope_fills_max_decoded()
+{
+    EncoderKey key;
+    TEST_ASSERT_TRUE(encoder_parse_key("0:ffeeddccbbaa99887766554433221100", key));
+    envelope_keyring_set(ring, 0, key.key);
+    DeviceRow row = row_of_length(ENVELOPE_MAX_PLAINTEXT);
+    std::string payload = encode(key, row);
+    EnvelopeData data;
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decode(payload.c_str(), data));
+    TEST_ASSERT_EQUAL_UINT(ENVELOPE_MAX_DECODED, data.len);
+    TEST_ASSERT_TRUE(encoder_verify_row(ring, row, payload));
+}
+
+void test_over_long_rows_are_rejected_before_encoding()
+{
+    DeviceRow row = row_of_length(ENVELOPE_MAX_PLAINTEXT + 1);
+    TEST_ASSERT_EQUAL_STRING("ssid|password longer than 48 bytes", encoder_validate(row));
+    // The envelope layer refuses it too
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, ENCODER_DEMO_KEY, 128);
+    EncoderKey key;
+    memcpy(key.key, ENCODER_DEMO_KEY, sizeof(key.key));
+    key.id = ENVELOPE_NO_KEY_ID;
+    std::string payload;
+    TEST_ASSERT_EQUAL(EnvelopeError::TooLong, encoder_encrypt_row(enc, key, iv, row, payload));
+    TEST_ASSERT_TRUE(payload.empty());
+    mbedtls_aes_free(&enc);
+}
+
+// ===========================================================
+// Rows
+// ===========================================================
+
+void test_password_keeps_commas()
+{
+    DeviceRow row = make_row("d1,Net,pa,ss,word");
+    TEST_ASSERT_EQUAL_STRING("Net", row.ssid.c_str());
+    TEST_ASSERT_EQUAL_STRING("pa,ss,word", row.password.c_str());
+    TEST_ASSERT_EQUAL_STRING("Net|pa,ss,word", row.plaintext.c_str());
+    DeviceRow missing;
+    TEST_ASSERT_FALSE(encoder_split_row("d1,Net", 1, missing));
+}
+
+void test_rows_parse_credentials_would_alter_are_rejected()
+{
+    TEST_ASSERT_NOT_NULL(encoder_validate(make_row(",Net,pw")));
+    TEST_ASSERT_NOT_NULL(encoder_validate(make_row("d,Ne|t,pw")));
+    TEST_ASSERT_NOT_NULL(encoder_validate(make_row("d,Net,p w")));
+    TEST_ASSERT_NOT_NULL(encoder_validate(make_row("d,N\tet,pw")));
+    TEST_ASSERT_NOT_NULL(encoder_validate(make_row("d,Net,")));
+}
+
+void test_json_line()
+{
+    DeviceRow row = make_row("rack \"7\",Net,pw");
+    TEST_ASSERT_EQUAL_STRING("{\"device\":\"rack \\\"7\\\"\",\"data\":\"QUJD\"}",
+                             encoder_json_line(row, "QUJD").c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_key_id_round_trips);
+    RUN_TEST(test_demo_key_matches_firmware_slot_0);
+    RUN_TEST(test_parse_key_with_id);
+    RUN_TEST(test_padding_boundaries_round_trip);
+    RUN_TEST(test_longest_envelope_fills_max_decoded);
+    RUN_TEST(test_over_long_rows_are_rejected_before_encoding);
+    RUN_TEST(test_password_keeps_commas);
+    RUN_TEST(test_rows_parse_credentials_would_alter_are_rejected);
+    RUN_TEST(test_json_line);
+    return UNITY_END();
+}
@@ -0,0 +1,222 @@
+// Host tests for lib/Envelope: decoding, key ring selection and the
+// error paths /set_wifi reports. Fixed vectors were made with
+// `openssl enc -aes-128-cbc -nopad`, independently of envelope_encrypt.
+// Run: pio test -e native
+
+#include <unity.h>
+#include <string.h>
+#include "envelope.h"
+
+// The firmware's built-in slot 0 key
+static const uint8_t demoKey[ENVELOPE_KEY_SIZE] = {'t', 'h', 'i', 's', 'i', 's', 'm', 'y',
+                                                   'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+static const uint8_t slot2Key[ENVELOPE_KEY_SIZE] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+// IV 00..0f || AES-128-CBC(demoKey, "MyNet|secret123\0"), no key id
+static const char *legacyEnvelope = "AAECAwQFBgcICQoLDA0OD28xmcTFjKZBZJEqlc9sOZo=";
+// 0x02 || IV f0..00 || AES-128-CBC(slot2Key, "Office-5G|correct horse battery\0")
+static const char *slot2Envelope = "AvDg0MCwoJCAcGBQQDAgEAC3E+aYhltECQgSF3b5zQheh0K6nvO3ubShaxYJK6DGSw==";
+
+static EnvelopeKeyRing ring;
+
+void setUp()
+{
+    envelope_keyring_init(ring);
+    envelope_keyring_set(ring, 0, demoKey);
+}
+
+void tearDown()
+{
+    envelope_keyring_free(ring);
+}
+
+// ===========================================================
+// Decryption
+// ===========================================================
+
+void test_decrypt_legacy_layout_with_key()
+{
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt(demoKey, legacyEnvelope, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("MyNet|secret123", out);
+}
+
+void test_keyring_uses_slot_0_without_key_id()
+{
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt_keyring(ring, legacyEnvelope, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("MyNet|secret123", out);
+}
+
+void test_keyring_selects_slot_by_key_id()
+{
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::UnknownKey, envelope_decrypt_keyring(ring, slot2Envelope, out, sizeof(out)));
+    TEST_ASSERT_TRUE(envelope_keyring_set(ring, 2, slot2Key));
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt_keyring(ring, slot2Envelope, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("Office-5G|correct horse battery", out);
+    envelope_keyring_remove(ring, 2);
+    TEST_ASSERT_EQUAL(EnvelopeError::UnknownKey, envelope_decrypt_keyring(ring, slot2Envelope, out, sizeof(out)));
+}
+
+void test_keyring_count_and_bounds()
+{
+    TEST_ASSERT_EQUAL_UINT(1, envelope_keyring_count(ring));
+    TEST_ASSERT_TRUE(envelope_keyring_set(ring, ENVELOPE_KEY_SLOTS - 1, slot2Key));
+    TEST_ASSERT_FALSE(envelope_keyring_set(ring, ENVELOPE_KEY_SLOTS, slot2Key));
+    TEST_ASSERT_EQUAL_UINT(2, envelope_keyring_count(ring));
+    // Replacing a slot keeps the count
+    TEST_ASSERT_TRUE(envelope_keyring_set(ring, 0, slot2Key));
+    TEST_ASSERT_EQUAL_UINT(2, envelope_keyring_count(ring));
+    envelope_keyring_remove(ring, 0);
+    envelope_keyring_remove(ring, ENVELOPE_KEY_SLOTS); // Out of range: ignored
+    TEST_ASSERT_EQUAL_UINT(1, envelope_keyring_count(ring));
+}
+
+void test_wrong_key_does_not_yield_plaintext()
+{
+    char out[64];
+    // CBC without a MAC decrypts to garbage rather than failing
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt(slot2Key, legacyEnvelope, out, sizeof(out)));
+    TEST_ASSERT_TRUE(strcmp(out, "MyNet|secret123") != 0);
+}
+
+// ===========================================================
+// Error Paths
+// ===========================================================
+
+void test_invalid_base64()
+{
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::Base64, envelope_decrypt_keyring(ring, "not*base64", out, sizeof(out)));
+}
+
+void test_decoded_longer_than_max_is_rejected()
+{
+    // 80 bytes decoded, past ENVELOPE_MAX_DECODED
+    char big[] = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA";
+    char out[128];
+    TEST_ASSERT_EQUAL(EnvelopeError::Base64, envelope_decrypt_keyring(ring, big, out, sizeof(out)));
+}
+
+void test_shorter_than_iv()
+{
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::TooShort, envelope_decrypt_keyring(ring, "AAECAwQFBgc=", out, sizeof(out)));
+    uint8_t iv[ENVELOPE_IV_SIZE];
+    TEST_ASSERT_EQUAL(EnvelopeError::TooShort, envelope_nonce("AAECAwQFBgc=", iv));
+}
+
+void test_partial_block_is_a_cipher_error()
+{
+    // IV plus 5 bytes of ciphertext
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::Cipher,
+                      envelope_decrypt_keyring(ring, "AAECAwQFBgcICQoLDA0ODwECAwQF", out, sizeof(out)));
+}
+
+void test_output_too_small()
+{
+    // 16 bytes of plaintext need 17 with the terminator
+    char out[16];
+    TEST_ASSERT_EQUAL(EnvelopeError::OutputTooSmall,
+                      envelope_decrypt_keyring(ring, legacyEnvelope, out, sizeof(out)));
+    char fits[17];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt_keyring(ring, legacyEnvelope, fits, sizeof(fits)));
+}
+
+void test_every_error_has_a_message()
+{
+    for (uint8_t e = (uint8_t)EnvelopeError::None; e <= (uint8_t)EnvelopeError::TooLong; e++)
+    {
+        TEST_ASSERT_TRUE(strcmp(envelope_error_message((EnvelopeError)e), "Unknown error") != 0);
+    }
+}
+
+// ===========================================================
+// Nonce
+// ===========================================================
+
+void test_nonce_skips_key_id()
+{
+    uint8_t iv[ENVELOPE_IV_SIZE];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_nonce(legacyEnvelope, iv));
+    for (uint8_t i = 0; i < ENVELOPE_IV_SIZE; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(i, iv[i]);
+    }
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_nonce(slot2Envelope, iv));
+    for (uint8_t i = 0; i < ENVELOPE_IV_SIZE; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(0xF0 - 0x10 * i, iv[i]);
+    }
+}
+
+void test_decoded_envelope_serves_nonce_and_decrypt()
+{
+    EnvelopeData data;
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decode(slot2Envelope, data));
+    TEST_ASSERT_EQUAL_UINT(1 + ENVELOPE_IV_SIZE + 32, data.len);
+    uint8_t iv[ENVELOPE_IV_SIZE];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_nonce(data, iv));
+    TEST_ASSERT_EQUAL_UINT8(0xF0, iv[0]);
+    envelope_keyring_set(ring, 2, slot2Key);
+    char out[64];
+    TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt_keyring(ring, data, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("Office-5G|correct horse battery", out);
+    TEST_ASSERT_EQUAL(EnvelopeError::Base64, envelope_decode("not*base64", data));
+    TEST_ASSERT_EQUAL_UINT(0, data.len);
+}
+
+// ===========================================================
+// Round Trip
+// ===========================================================
+
+void test_encrypt_round_trips_through_keyring()
+{
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, slot2Key, 128);
+    envelope_keyring_set(ring, 2, slot2Key);
+    uint8_t iv[ENVELOPE_IV_SIZE] = {9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 1, 2, 3, 4, 5, 6};
+    char plain[ENVELOPE_MAX_PLAINTEXT + 2];
+    char b64[128];
+    char out[ENVELOPE_MAX_PLAINTEXT + 1];
+    for (size_t len = 1; len <= ENVELOPE_MAX_PLAINTEXT + 1; len++)
+    {
+        memset(plain, 'a', len);
+        plain[len] = '\0';
+        EnvelopeError error = envelope_encrypt(enc, 2, iv, plain, b64, sizeof(b64));
+        if (len > ENVELOPE_MAX_PLAINTEXT)
+        {
+            TEST_ASSERT_EQUAL(EnvelopeError::TooLong, error);
+            continue;
+        }
+        TEST_ASSERT_EQUAL(EnvelopeError::None, error);
+        TEST_ASSERT_EQUAL(EnvelopeError::None, envelope_decrypt_keyring(ring, b64, out, sizeof(out)));
+        TEST_ASSERT_EQUAL_STRING(plain, out);
+    }
+    TEST_ASSERT_EQUAL(EnvelopeError::UnknownKey,
+                      envelope_encrypt(enc, ENVELOPE_KEY_SLOTS, iv, "x|y", b64, sizeof(b64)));
+    mbedtls_aes_free(&enc);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_decrypt_legacy_layout_with_key);
+    RUN_TEST(test_keyring_uses_slot_0_without_key_id);
+    RUN_TEST(test_keyring_selects_slot_by_key_id);
+    RUN_TEST(test_keyring_count_and_bounds);
+    RUN_TEST(test_wrong_key_does_not_yield_plaintext);
+    RUN_TEST(test_invalid_base64);
+    RUN_TEST(test_decoded_longer_than_max_is_rejected);
+    RUN_TEST(test_shorter_than_iv);
+    RUN_TEST(test_partial_block_is_a_cipher_error);
+    RUN_TEST(test_output_too_small);
+    RUN_TEST(test_every_error_has_a_message);
+    RUN_TEST(test_nonce_skips_key_id);
+    RUN_TEST(test_decoded_envelope_serves_nonce_and_decrypt);
+    RUN_TEST(test_encrypt_round_trips_through_keyring);
+    return UNITY_END();
+}
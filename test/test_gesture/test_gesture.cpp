@@ -0,0 +1,266 @@
+// Host tests for lib/Gesture: GestureDetector driven by simulated,
+// timed pin edges, including contact bounce. Run: pio test -e native
+
+#include <unity.h>
+#include <vector>
+#include "gesture_detector.h"
+
+// ===========================================================
+// Simulated Driver
+// ===========================================================
+// Mirrors lib/BootButton/boot_button.cpp: every raw edge restarts the
+// one-shot debounce timer; when it expires the pin is sampled and a
+// level that differs from the last stable one is fed to the detector.
+// The deadline timer fires on_timeout at next_deadline(). Timers are
+// run in time order, so the gestures come out as on the device.
+
+class ButtonSim
+{
+public:
+    explicit ButtonSim(uint32_t start_ms = 0, const GestureTiming &timing = GestureTiming())
+        : detector_(timing), now_(start_ms)
+    {
+    }
+
+    // Raw pin change at now + after_ms; bounces are just closely spaced edges
+    void edge(bool pressed, uint32_t after_ms = 0)
+    {
+        run(after_ms);
+        raw_ = pressed;
+        debouncing_ = true;
+        debounce_at_ = now_ + detector_.timing().debounce_ms;
+    }
+
+    void press(uint32_t after_ms = 0) { edge(true, after_ms); }
+    void release(uint32_t after_ms = 0) { edge(false, after_ms); }
+
+    // Let after_ms pass, firing every timer that expires on the way
+    void run(uint32_t after_ms)
+    {
+        const uint32_t until = now_ + after_ms;
+        while (true)
+        {
+            uint32_t deadline;
+            bool has_deadline = detector_.next_deadline(deadline);
+            // The deadline timer never fires before it was armed
+            if (has_deadline && (int32_t)(deadline - now_) < 0)
+            {
+                deadline = now_;
+            }
+            bool debounce_first = debouncing_ && (!has_deadline || (int32_t)(debounce_at_ - deadline) <= 0);
+            uint32_t at = debounce_first ? debounce_at_ : deadline;
+            if ((!debouncing_ && !has_deadline) || (int32_t)(at - until) > 0)
+            {
+                break;
+            }
+            now_ = at;
+            if (debounce_first)
+            {
+                debouncing_ = false;
+                if (raw_ != stable_)
+                {
+                    stable_ = raw_;
+                    record(detector_.on_edge(stable_, now_));
+                }
+            }
+            else
+            {
+                record(detector_.on_timeout(now_));
+            }
+        }
+        now_ = until;
+    }
+
+    const std::vector<ButtonGesture> &gestures() const { return gestures_; }
+    const std::vector<uint32_t> &times() const { return times_; } // When each gesture fired
+
+private:
+    void record(ButtonGesture gesture)
+    {
+        if (gesture != ButtonGesture::None)
+        {
+            gestures_.push_back(gesture);
+            times_.push_back(now_);
+        }
+    }
+
+    GestureDetector detector_;
+    uint32_t now_;
+    bool raw_ = false;
+    bool stable_ = false;
+    bool debouncing_ = false;
+    uint32_t debounce_at_ = 0;
+    std::vector<ButtonGesture> gestures_;
+    std::vector<uint32_t> times_;
+};
+
+static void assert_gestures(const ButtonSim &sim, std::initializer_list<ButtonGesture> expected)
+{
+    TEST_ASSERT_EQUAL_UINT(expected.size(), sim.gestures().size());
+    size_t i = 0;
+    for (ButtonGesture g : expected)
+    {
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)g, (uint8_t)sim.gestures()[i++]);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ===========================================================
+// Gestures
+// ===========================================================
+
+void test_short_press()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(120);
+    sim.run(299);
+    // Still inside the double-press gap
+    assert_gestures(sim, {});
+    sim.run(100);
+    assert_gestures(sim, {ButtonGesture::ShortPress});
+}
+
+void test_double_press()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(100);
+    sim.press(150);
+    sim.release(100);
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::DoublePress});
+}
+
+void test_second_press_after_gap_is_two_short_presses()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(100);
+    sim.press(400);
+    sim.release(100);
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::ShortPress, ButtonGesture::ShortPress});
+}
+
+void test_long_press()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(1499);
+    sim.run(1000);
+    // Just under long_ms held: a short press
+    assert_gestures(sim, {ButtonGesture::ShortPress});
+
+    ButtonSim held;
+    held.press();
+    held.release(2000);
+    // Reported on release, without waiting for a second press
+    held.run(31);
+    assert_gestures(held, {ButtonGesture::LongPress});
+}
+
+void test_very_long_press_fires_while_held()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.run(5029);
+    assert_gestures(sim, {});
+    sim.run(1);
+    assert_gestures(sim, {ButtonGesture::VeryLongPress});
+    TEST_ASSERT_EQUAL_UINT32(5030, sim.times()[0]); // Debounce + very_long_ms
+    // The release that follows completes nothing else
+    sim.run(3000);
+    sim.release();
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::VeryLongPress});
+}
+
+void test_held_second_press_becomes_very_long()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(100);
+    sim.press(100);
+    sim.run(6000);
+    assert_gestures(sim, {ButtonGesture::VeryLongPress});
+    sim.release();
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::VeryLongPress});
+}
+
+// ===========================================================
+// Debounce
+// ===========================================================
+
+void test_bouncing_contacts_give_one_press()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(3);
+    sim.press(4);
+    sim.release(2);
+    sim.press(5);
+    sim.release(150);
+    sim.press(2);
+    sim.release(3);
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::ShortPress});
+}
+
+void test_glitch_shorter_than_debounce_is_ignored()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(10);
+    sim.run(2000);
+    assert_gestures(sim, {});
+}
+
+void test_bounce_on_release_keeps_double_press()
+{
+    ButtonSim sim;
+    sim.press();
+    sim.release(100);
+    sim.press(4);
+    sim.release(4);
+    sim.press(120);
+    sim.release(100);
+    sim.press(6);
+    sim.release(3);
+    sim.run(2000);
+    assert_gestures(sim, {ButtonGesture::DoublePress});
+}
+
+// ===========================================================
+// Clock Wrap-around
+// ===========================================================
+
+void test_gestures_across_millis_wrap()
+{
+    ButtonSim sim(0xFFFFFF00u);
+    sim.press();
+    sim.release(2000);
+    sim.run(1000);
+    sim.press();
+    sim.run(6000);
+    assert_gestures(sim, {ButtonGesture::LongPress, ButtonGesture::VeryLongPress});
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_short_press);
+    RUN_TEST(test_double_press);
+    RUN_TEST(test_second_press_after_gap_is_two_short_presses);
+    RUN_TEST(test_long_press);
+    RUN_TEST(test_very_long_press_fires_while_held);
+    RUN_TEST(test_held_second_press_becomes_very_long);
+    RUN_TEST(test_bouncing_contacts_give_one_press);
+    RUN_TEST(test_glitch_shorter_than_debounce_is_ignored);
+    RUN_TEST(test_bounce_on_release_keeps_double_press);
+    RUN_TEST(test_gestures_across_millis_wrap);
+    return UNITY_END();
+}
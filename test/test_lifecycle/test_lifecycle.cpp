@@ -0,0 +1,208 @@
+// Host tests for lib/Lifecycle: every (state, input) pair of the
+// compiled table against an explicit expectation, entry hooks, the
+// ignored-input counter, the transition log ring and the rejoin
+// deadline. Run: pio test -e native
+
+#include <unity.h>
+#include <stdio.h>
+#include "lifecycle.h"
+
+typedef LifecycleState S;
+typedef LifecycleInput I;
+
+static const size_t STATES = (size_t)S::Count;
+static const size_t INPUTS = (size_t)I::Count;
+static const S NONE = S::Count;
+
+// Columns: StoredFound, NoStored, JoinOk, JoinFailed, Credentials,
+// Disconnected, ResetRequested
+static const S expected[STATES][INPUTS] = {
+    /* Boot */ {S::TryStored, S::ApMode, NONE, NONE, NONE, NONE, S::Reset},
+    /* TryStored */ {NONE, NONE, S::Connected, S::ApMode, S::Provisioning, NONE, S::Reset},
+    /* ApMode */ {NONE, NONE, S::Connected, NONE, S::Provisioning, NONE, S::Reset},
+    /* Provisioning */ {NONE, NONE, S::Connected, S::ApMode, NONE, NONE, S::Reset},
+    /* Connected */ {NONE, NONE, NONE, NONE, S::Provisioning, S::TryStored, S::Reset},
+    /* Reset */ {NONE, NONE, NONE, NONE, NONE, NONE, NONE},
+};
+
+struct HookCall
+{
+    int count;
+    S state;
+    S from;
+    I input;
+};
+
+static HookCall hookCalls[STATES];
+
+static void record_entry(S state, S from, I input)
+{
+    HookCall &call = hookCalls[(size_t)state];
+    call.count++;
+    call.state = state;
+    call.from = from;
+    call.input = input;
+}
+
+// One hook per state so each knows which state it was entered into
+template <S State>
+static void hook(S from, I input)
+{
+    record_entry(State, from, input);
+}
+
+static void install_hooks(LifecycleMachine &machine)
+{
+    machine.on_enter(S::Boot, hook<S::Boot>);
+    machine.on_enter(S::TryStored, hook<S::TryStored>);
+    machine.on_enter(S::ApMode, hook<S::ApMode>);
+    machine.on_enter(S::Provisioning, hook<S::Provisioning>);
+    machine.on_enter(S::Connected, hook<S::Connected>);
+    machine.on_enter(S::Reset, hook<S::Reset>);
+}
+
+void setUp()
+{
+    for (HookCall &call : hookCalls)
+    {
+        call = HookCall{0, NONE, NONE, I::Count};
+    }
+}
+
+void tearDown() {}
+
+void test_table_matches_every_pair()
+{
+    const StateTable<S, I> &table = lifecycle_table();
+    for (size_t s = 0; s < STATES; s++)
+    {
+        for (size_t i = 0; i < INPUTS; i++)
+        {
+            char message[64];
+            snprintf(message, sizeof(message), "%s + %s", lifecycle_state_name((S)s), lifecycle_input_name((I)i));
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)expected[s][i], (int)table.next((S)s, (I)i), message);
+        }
+    }
+}
+
+void test_dispatch_every_pair()
+{
+    for (size_t s = 0; s < STATES; s++)
+    {
+        for (size_t i = 0; i < INPUTS; i++)
+        {
+            setUp();
+            LifecycleMachine machine(lifecycle_table(), (S)s);
+            install_hooks(machine);
+            S to = expected[s][i];
+            char message[64];
+            snprintf(message, sizeof(message), "%s + %s", lifecycle_state_name((S)s), lifecycle_input_name((I)i));
+
+            bool moved = machine.dispatch((I)i, 1000 + (uint32_t)(s * INPUTS + i));
+            TEST_ASSERT_EQUAL_MESSAGE(to != NONE, moved, message);
+            if (to == NONE)
+            {
+                // Ignored: state, log and hooks untouched, counter up
+                TEST_ASSERT_EQUAL_INT_MESSAGE((int)s, (int)machine.state(), message);
+                TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, machine.ignored(), message);
+                TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, machine.moves(), message);
+                TEST_ASSERT_EQUAL_UINT_MESSAGE(0, machine.log_size(), message);
+                for (const HookCall &call : hookCalls)
+                {
+                    TEST_ASSERT_EQUAL_INT_MESSAGE(0, call.count, message);
+                }
+                continue;
+            }
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)to, (int)machine.state(), message);
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, machine.ignored(), message);
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(1000 + s * INPUTS + i, machine.entered_ms(), message);
+
+            // Exactly the target's hook ran, once, with the move's origin
+            for (size_t h = 0; h < STATES; h++)
+            {
+                TEST_ASSERT_EQUAL_INT_MESSAGE(h == (size_t)to ? 1 : 0, hookCalls[h].count, message);
+            }
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)s, (int)hookCalls[(size_t)to].from, message);
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)i, (int)hookCalls[(size_t)to].input, message);
+
+            TEST_ASSERT_EQUAL_UINT_MESSAGE(1, machine.log_size(), message);
+            LifecycleMachine::Record r = machine.log_at(0);
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(1000 + s * INPUTS + i, r.ms, message);
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)s, (int)r.from, message);
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)i, (int)r.input, message);
+            TEST_ASSERT_EQUAL_INT_MESSAGE((int)to, (int)r.to, message);
+        }
+    }
+}
+
+void test_ignored_inputs_accumulate()
+{
+    LifecycleMachine machine(lifecycle_table(), S::Reset);
+    for (size_t i = 0; i < INPUTS; i++)
+    {
+        TEST_ASSERT_FALSE(machine.dispatch((I)i, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(INPUTS, machine.ignored());
+    TEST_ASSERT_EQUAL_INT((int)S::Reset, (int)machine.state());
+}
+
+void test_log_ring_keeps_the_newest_moves()
+{
+    LifecycleMachine machine(lifecycle_table(), S::ApMode);
+    // ApMode -> Provisioning -> ApMode, twice per lap
+    const uint32_t laps = 20;
+    for (uint32_t n = 0; n < laps; n++)
+    {
+        TEST_ASSERT_TRUE(machine.dispatch(I::Credentials, 2 * n));
+        TEST_ASSERT_TRUE(machine.dispatch(I::JoinFailed, 2 * n + 1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(2 * laps, machine.moves());
+    TEST_ASSERT_EQUAL_UINT(32, machine.log_size());
+    // The oldest 8 moves were overwritten
+    for (size_t k = 0; k < machine.log_size(); k++)
+    {
+        LifecycleMachine::Record r = machine.log_at(k);
+        uint32_t move = 2 * laps - 32 + (uint32_t)k;
+        TEST_ASSERT_EQUAL_UINT32(move, r.ms);
+        TEST_ASSERT_EQUAL_INT((int)(move % 2 ? I::JoinFailed : I::Credentials), (int)r.input);
+        TEST_ASSERT_EQUAL_INT((int)(move % 2 ? S::ApMode : S::Provisioning), (int)r.to);
+    }
+}
+
+// The one test that drives the firmware's own machine: after a drop,
+// TryStored falls back to AP mode once the rejoin deadline passes
+void test_rejoin_deadline_falls_back_to_ap()
+{
+    TEST_ASSERT_EQUAL_INT((int)S::Boot, (int)lifecycle_state());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, lifecycle_timeout_ms(0));
+    TEST_ASSERT_TRUE(lifecycle_dispatch(I::StoredFound, 100));
+    TEST_ASSERT_TRUE(lifecycle_dispatch(I::JoinOk, 200));
+    TEST_ASSERT_FALSE(lifecycle_poll(200 + 10 * LIFECYCLE_REJOIN_MS));
+    TEST_ASSERT_EQUAL_INT((int)S::Connected, (int)lifecycle_state());
+
+    const uint32_t dropped = 5000;
+    TEST_ASSERT_TRUE(lifecycle_dispatch(I::Disconnected, dropped));
+    TEST_ASSERT_EQUAL_INT((int)S::TryStored, (int)lifecycle_state());
+    TEST_ASSERT_EQUAL_UINT32(LIFECYCLE_REJOIN_MS, lifecycle_timeout_ms(dropped));
+    TEST_ASSERT_EQUAL_UINT32(1, lifecycle_timeout_ms(dropped + LIFECYCLE_REJOIN_MS - 1));
+    TEST_ASSERT_FALSE(lifecycle_poll(dropped + LIFECYCLE_REJOIN_MS - 1));
+    TEST_ASSERT_EQUAL_UINT32(0, lifecycle_timeout_ms(dropped + LIFECYCLE_REJOIN_MS));
+    TEST_ASSERT_TRUE(lifecycle_poll(dropped + LIFECYCLE_REJOIN_MS));
+    TEST_ASSERT_EQUAL_INT((int)S::ApMode, (int)lifecycle_state());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, lifecycle_timeout_ms(dropped + 2 * LIFECYCLE_REJOIN_MS));
+
+    // A late re-join by the driver still lands in Connected
+    TEST_ASSERT_TRUE(lifecycle_dispatch(I::JoinOk, dropped + 2 * LIFECYCLE_REJOIN_MS));
+    TEST_ASSERT_EQUAL_INT((int)S::Connected, (int)lifecycle_state());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_every_pair);
+    RUN_TEST(test_dispatch_every_pair);
+    RUN_TEST(test_ignored_inputs_accumulate);
+    RUN_TEST(test_log_ring_keeps_the_newest_moves);
+    RUN_TEST(test_rejoin_deadline_falls_back_to_ap);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+// Host tests for lib/ReplayGuard: replay rejection, FIFO eviction, a junk
+// flood that must not lock out a real envelope, and forget().
+// Run: pio test -e native
+
+#include <unity.h>
+#include <string.h>
+#include "replay_guard.h"
+
+static const uint8_t salt[REPLAY_GUARD_SALT_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+static void nonce_for(uint32_t n, uint8_t out[16])
+{
+    memset(out, 0xA5, 16);
+    memcpy(out, &n, sizeof(n));
+}
+
+static ReplayVerdict admit(uint32_t n, uint32_t now_ms)
+{
+    uint8_t nonce[16];
+    nonce_for(n, nonce);
+    return replay_guard_admit(nonce, sizeof(nonce), now_ms);
+}
+
+void setUp()
+{
+    replay_guard_configure(salt);
+}
+
+void tearDown() {}
+
+void test_second_use_is_rejected()
+{
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(1, 0));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Replayed, admit(1, 10));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(2, 20));
+    ReplayGuardStats s = replay_guard_stats();
+    TEST_ASSERT_EQUAL_UINT32(3, s.checks);
+    TEST_ASSERT_EQUAL_UINT32(1, s.rejected);
+    TEST_ASSERT_EQUAL_UINT32(2, s.remembered);
+}
+
+void test_age_alone_never_forgets_a_nonce()
+{
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(1, 0));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Replayed, admit(1, 0x7FFFFFFF));
+}
+
+void test_without_hold_the_oldest_is_evicted()
+{
+    for (uint32_t n = 0; n < REPLAY_GUARD_SLOTS; n++)
+    {
+        TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(n, n));
+    }
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(100, 100));
+    TEST_ASSERT_EQUAL_UINT32(1, replay_guard_stats().evicted);
+    // Nonce 0 fell out of the table and is accepted again
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(0, 101));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Replayed, admit(2, 102));
+}
+
+void test_inside_hold_the_oldest_is_still_evicted()
+{
+    replay_guard_configure(salt, 1000);
+    for (uint32_t n = 0; n < REPLAY_GUARD_SLOTS; n++)
+    {
+        TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(n, 0));
+    }
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(100, 999));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(101, 1000));
+    ReplayGuardStats s = replay_guard_stats();
+    TEST_ASSERT_EQUAL_UINT32(2, s.evicted);
+    TEST_ASSERT_EQUAL_UINT32(1, s.evicted_early);
+}
+
+// 33 unauthenticated envelopes arrive inside the hold time; the first
+// valid one after them is still admitted, whether or not the junk was
+// taken back after failing to decrypt
+void test_junk_flood_does_not_lock_out_a_valid_envelope()
+{
+    static const uint32_t HOLD_MS = 5 * 60 * 1000;
+    for (int forget = 0; forget < 2; forget++)
+    {
+        replay_guard_configure(salt, HOLD_MS);
+        for (uint32_t n = 0; n < REPLAY_GUARD_SLOTS + 1; n++)
+        {
+            uint8_t junk[16];
+            nonce_for(1000 + n, junk);
+            TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, replay_guard_admit(junk, sizeof(junk), n));
+            if (forget)
+            {
+                replay_guard_forget(junk, sizeof(junk));
+            }
+        }
+        TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(1, 100));
+        TEST_ASSERT_EQUAL(ReplayVerdict::Replayed, admit(1, 101));
+        TEST_ASSERT_EQUAL_UINT32(forget ? 0 : 2, replay_guard_stats().evicted_early);
+    }
+}
+
+void test_forget_takes_back_the_newest()
+{
+    uint8_t nonce[16];
+    nonce_for(7, nonce);
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, replay_guard_admit(nonce, sizeof(nonce), 0));
+    replay_guard_forget(nonce, sizeof(nonce));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, replay_guard_admit(nonce, sizeof(nonce), 0));
+    TEST_ASSERT_EQUAL_UINT32(1, replay_guard_stats().remembered);
+    // An older entry stays put
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(8, 0));
+    replay_guard_forget(nonce, sizeof(nonce));
+    TEST_ASSERT_EQUAL(ReplayVerdict::Replayed, replay_guard_admit(nonce, sizeof(nonce), 0));
+}
+
+void test_salt_changes_fingerprints()
+{
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(1, 0));
+    uint8_t other[REPLAY_GUARD_SALT_SIZE] = {};
+    replay_guard_configure(other);
+    TEST_ASSERT_EQUAL(ReplayVerdict::Fresh, admit(1, 0));
+    TEST_ASSERT_EQUAL_UINT(REPLAY_GUARD_SLOTS * 16, replay_guard_stats().bytes);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_second_use_is_rejected);
+    RUN_TEST(test_age_alone_never_forgets_a_nonce);
+    RUN_TEST(test_without_hold_the_oldest_is_evicted);
+    RUN_TEST(test_inside_hold_the_oldest_is_still_evicted);
+    RUN_TEST(test_junk_flood_does_not_lock_out_a_valid_envelope);
+    RUN_TEST(test_forget_takes_back_the_newest);
+    RUN_TEST(test_salt_changes_fingerprints);
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+// Host tests for the layout cache in lib/OledPanel/text_fit.h: a hash
+// collision between equal-length messages must miss, repeats hit, and
+// the least recently used layout is the one replaced.
+// Run: pio test -e native
+
+#include <unity.h>
+#include <string.h>
+#include "text_fit.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void fill(LayoutCache<4> &cache, const char *text, uint64_t hash, uint8_t scale)
+{
+    TextLayout &layout = cache.insert(text, strlen(text), hash);
+    layout.scale = scale;
+    layout.line_count = 0;
+}
+
+void test_text_hash_is_64_bit_fnv1a()
+{
+    size_t length;
+    TEST_ASSERT_TRUE(text_hash("", length) == 0xcbf29ce484222325ull);
+    TEST_ASSERT_EQUAL_UINT(0, length);
+    TEST_ASSERT_TRUE(text_hash("a", length) == 0xaf63dc4c8601ec8cull);
+    TEST_ASSERT_EQUAL_UINT(1, length);
+}
+
+void test_repeated_message_hits()
+{
+    LayoutCache<4> cache;
+    size_t length;
+    uint64_t hash = text_hash("Hello", length);
+    TEST_ASSERT_NULL(cache.find("Hello", length, hash));
+    fill(cache, "Hello", hash, 3);
+    const TextLayout *layout = cache.find("Hello", length, hash);
+    TEST_ASSERT_NOT_NULL(layout);
+    TEST_ASSERT_EQUAL_UINT8(3, layout->scale);
+    LayoutCacheStats stats = cache.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.hits);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.misses);
+}
+
+void test_colliding_hash_of_equal_length_misses()
+{
+    // Same hash and length forced; only the bytes tell them apart
+    LayoutCache<4> cache;
+    fill(cache, "ABCD", 42, 2);
+    TEST_ASSERT_NULL(cache.find("ABCE", 4, 42));
+    TEST_ASSERT_NOT_NULL(cache.find("ABCD", 4, 42));
+}
+
+void test_difference_late_in_a_long_message_misses()
+{
+    char a[TEXT_FIT_MAX_BYTES + 1];
+    char b[TEXT_FIT_MAX_BYTES + 1];
+    memset(a, 'x', TEXT_FIT_MAX_BYTES);
+    a[TEXT_FIT_MAX_BYTES] = '\0';
+    memcpy(b, a, sizeof(b));
+    b[TEXT_FIT_MAX_BYTES - 1] = 'y';
+    LayoutCache<4> cache;
+    fill(cache, a, 7, 1);
+    TEST_ASSERT_NULL(cache.find(b, strlen(b), 7));
+    TEST_ASSERT_NOT_NULL(cache.find(a, strlen(a), 7));
+}
+
+void test_least_recently_used_is_replaced()
+{
+    LayoutCache<4> cache;
+    const char *texts[] = {"one", "two", "three", "four"};
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        fill(cache, texts[i], i, (uint8_t)(i + 1));
+    }
+    // Touch "one" so "two" becomes the oldest
+    TEST_ASSERT_NOT_NULL(cache.find("one", 3, 0));
+    fill(cache, "five", 4, 5);
+    TEST_ASSERT_NULL(cache.find("two", 3, 1));
+    TEST_ASSERT_NOT_NULL(cache.find("one", 3, 0));
+    TEST_ASSERT_NOT_NULL(cache.find("three", 5, 2));
+    TEST_ASSERT_NOT_NULL(cache.find("four", 4, 3));
+    const TextLayout *five = cache.find("five", 4, 4);
+    TEST_ASSERT_NOT_NULL(five);
+    TEST_ASSERT_EQUAL_UINT8(5, five->scale);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text_hash_is_64_bit_fnv1a);
+    RUN_TEST(test_repeated_message_hits);
+    RUN_TEST(test_colliding_hash_of_equal_length_misses);
+    RUN_TEST(test_difference_late_in_a_long_message_misses);
+    RUN_TEST(test_least_recently_used_is_replaced);
+    return UNITY_END();
+}
@@ -0,0 +1,249 @@
+// Host batch encoder for /set_wifi payloads.
+//
+//   encoder <devices.csv> [--key [ID:]<32 hex chars>] [--threads N] [--verify] [-o out.jsonl]
+//
+// Each CSV row is "device_id,ssid,password" (the password is the rest of
+// the line, so it may contain commas). Every row becomes one JSON line
+//   {"device":"<id>","data":"<base64 envelope>"}
+// whose "data" is exactly what decrypt_wifi_credentials expects; the
+// extra "device" field is ignored by the firmware, so a line can be
+// posted to /set_wifi as-is. With --key ID:HEX the envelope carries that
+// key id, otherwise the original layout (slot 0) is written.
+//
+// Rows are split evenly across threads, each with its own pre-expanded
+// AES schedule. --verify decodes every payload again with the firmware
+// decoder (lib/Envelope + lib/Credentials) and fails on any mismatch.
+// Row handling lives in lib/BatchEncoder, where the native tests use it.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "batch_encoder.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Slot 0 demo key unless --key says otherwise; set up in main()
+static EncoderKey encoderKey;
+
+static bool read_rows(FILE *f, std::vector<DeviceRow> &rows, size_t &invalid)
+{
+    char line[512];
+    size_t line_no = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        line_no++;
+        size_t len = strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || line[0] == '#' || (line_no == 1 && !strncmp(line, "device", 6)))
+        {
+            continue;
+        }
+        DeviceRow row;
+        if (!encoder_split_row(line, line_no, row))
+        {
+            fprintf(stderr, "line %zu: expected device_id,ssid,password\n", line_no);
+            invalid++;
+            continue;
+        }
+        if (const char *why = encoder_validate(row))
+        {
+            fprintf(stderr, "line %zu: %s\n", line_no, why);
+            invalid++;
+            continue;
+        }
+        rows.push_back(std::move(row));
+    }
+    return !ferror(f);
+}
+
+static bool fill_ivs(std::vector<uint8_t> &ivs)
+{
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (!f)
+    {
+        return false;
+    }
+    bool ok = fread(ivs.data(), 1, ivs.size(), f) == ivs.size();
+    fclose(f);
+    return ok;
+}
+
+// Encode rows [begin, end); returns the number of failures
+static size_t encode_range(const std::vector<DeviceRow> &rows, const std::vector<uint8_t> &ivs,
+                           std::vector<std::string> &payloads, size_t begin, size_t end)
+{
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, encoderKey.key, 128);
+    size_t failed = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        EnvelopeError error = encoder_encrypt_row(enc, encoderKey, &ivs[i * ENVELOPE_IV_SIZE], rows[i], payloads[i]);
+        if (error != EnvelopeError::None)
+        {
+            fprintf(stderr, "line %zu: %s\n", rows[i].line, envelope_error_message(error));
+            failed++;
+        }
+    }
+    mbedtls_aes_free(&enc);
+    return failed;
+}
+
+// Decode with the firmware path and compare against the source rows
+static size_t verify_range(const std::vector<DeviceRow> &rows, const std::vector<std::string> &payloads, size_t begin,
+                           size_t end)
+{
+    EnvelopeKeyRing ring;
+    envelope_keyring_init(ring);
+    envelope_keyring_set(ring, encoderKey.id == ENVELOPE_NO_KEY_ID ? 0 : (uint8_t)encoderKey.id, encoderKey.key);
+    size_t mismatches = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        if (payloads[i].empty())
+        {
+            continue; // Already reported as an encode failure
+        }
+        if (!encoder_verify_row(ring, rows[i], payloads[i]))
+        {
+            fprintf(stderr, "line %zu: round trip mismatch\n", rows[i].line);
+            mismatches++;
+        }
+    }
+    envelope_keyring_free(ring);
+    return mismatches;
+}
+
+// Run fn(begin, end) over rows split across threads; sums the results
+template <typename Fn>
+static size_t run_parallel(size_t count, unsigned threads, Fn fn)
+{
+    std::vector<std::thread> workers;
+    std::vector<size_t> results(threads, 0);
+    size_t per = (count + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        size_t begin = t * per < count ? t * per : count;
+        size_t end = begin + per < count ? begin + per : count;
+        workers.emplace_back([&, t, begin, end]() { results[t] = fn(begin, end); });
+    }
+    size_t total = 0;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers[t].join();
+        total += results[t];
+    }
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    const char *out_path = nullptr;
+    unsigned threads = std::thread::hardware_concurrency();
+    bool verify = false;
+    memcpy(encoderKey.key, ENCODER_DEMO_KEY, sizeof(encoderKey.key));
+    encoderKey.id = ENVELOPE_NO_KEY_ID;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--verify"))
+        {
+            verify = true;
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            threads = (unsigned)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            out_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--key") && i + 1 < argc)
+        {
+            if (!encoder_parse_key(argv[++i], encoderKey))
+            {
+                fprintf(stderr, "--key expects [ID:] and %u hex bytes, ID below %u\n", (unsigned)ENVELOPE_KEY_SIZE,
+                        (unsigned)ENVELOPE_KEY_SLOTS);
+                return 2;
+            }
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (!path)
+    {
+        fprintf(stderr,
+                "usage: %s <devices.csv> [--key [ID:]HEX] [--threads N] [--verify] [-o out.jsonl]\n", argv[0]);
+        return 2;
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    FILE *in = fopen(path, "r");
+    if (!in)
+    {
+        perror(path);
+        return 1;
+    }
+    std::vector<DeviceRow> rows;
+    size_t invalid = 0;
+    bool read_ok = read_rows(in, rows, invalid);
+    fclose(in);
+    if (!read_ok)
+    {
+        perror(path);
+        return 1;
+    }
+
+    std::vector<uint8_t> ivs(rows.size() * ENVELOPE_IV_SIZE);
+    if (!fill_ivs(ivs))
+    {
+        perror("/dev/urandom");
+        return 1;
+    }
+    std::vector<std::string> payloads(rows.size());
+    Clock::time_point start = Clock::now();
+    size_t failed = run_parallel(rows.size(), threads, [&](size_t begin, size_t end)
+                                 { return encode_range(rows, ivs, payloads, begin, end); });
+    double encode_s = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t mismatches = 0;
+    if (verify)
+    {
+        mismatches = run_parallel(rows.size(), threads, [&](size_t begin, size_t end)
+                                  { return verify_range(rows, payloads, begin, end); });
+    }
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out)
+    {
+        perror(out_path);
+        return 1;
+    }
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        if (!payloads[i].empty())
+        {
+            fprintf(out, "%s\n", encoder_json_line(rows[i], payloads[i]).c_str());
+        }
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    fprintf(stderr, "%zu payload(s) on %u thread(s) in %.1f ms (%.0f/s)", rows.size() - failed, threads,
+            encode_s * 1000.0, encode_s > 0 ? (rows.size() - failed) / encode_s : 0.0);
+    if (verify)
+    {
+        fprintf(stderr, ", %zu round-trip mismatch(es)", mismatches);
+    }
+    fprintf(stderr, ", %zu invalid row(s)\n", invalid + failed);
+    return invalid + failed + mismatches ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+// Host simulation of ESP-NOW fleet provisioning (lib/Fleet).
+//
+//   fleet_sim [--nodes N] [--groups G] [--loss P] [--retries R] [--interval MS] [--all]
+//
+// N receivers and one sender share a simulated broadcast medium. Frames
+// go out one at a time, each holding the channel for its airtime at the
+// ESP-NOW 1 Mbps rate plus a fixed per-frame overhead, and every
+// listener drops a frame independently with probability P. The sender
+// fans one envelope out to group 0 (or to every node with --all) and the
+// run reports how many devices were provisioned per simulated second.
+//
+// Receivers decrypt with the firmware's Envelope key ring, so framing,
+// addressing, dedup and retries are the same code the device runs.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+#include "envelope.h"
+#include "fleet_protocol.h"
+
+static const double RATE_BPS = 1e6;
+static const uint64_t FRAME_OVERHEAD_US = 300; // Preamble, MAC header, ack and backoff
+
+// Same demo key the firmware ships with in slot 0
+static const uint8_t demoKey[ENVELOPE_KEY_SIZE] = {'t', 'h', 'i', 's', 'i', 's', 'm', 'y',
+                                                   'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+static EnvelopeKeyRing keyRing;
+
+struct Station
+{
+    uint8_t mac[FLEET_MAC_SIZE];
+};
+
+struct Node : Station
+{
+    uint8_t group = 0;
+    FleetReceiver receiver;
+    bool provisioned = false;
+    uint64_t provisioned_us = 0;
+};
+
+struct AirFrame
+{
+    uint8_t src[FLEET_MAC_SIZE];
+    uint8_t dst[FLEET_MAC_SIZE];
+    std::vector<uint8_t> data;
+};
+
+struct Medium
+{
+    std::deque<AirFrame> queue;
+    uint64_t now_us = 0;
+    uint32_t frames = 0;
+    uint32_t acks = 0;
+    uint32_t lost = 0;
+};
+
+static Medium medium;
+
+static bool medium_send(void *ctx, const uint8_t dst[FLEET_MAC_SIZE], const uint8_t *frame, size_t len)
+{
+    AirFrame f;
+    memcpy(f.src, ((Station *)ctx)->mac, FLEET_MAC_SIZE);
+    memcpy(f.dst, dst, FLEET_MAC_SIZE);
+    f.data.assign(frame, frame + len);
+    medium.queue.push_back(std::move(f));
+    return true;
+}
+
+static bool node_decrypt(void *, const char *envelope_b64, char *output, size_t output_size)
+{
+    return envelope_decrypt_keyring(keyRing, envelope_b64, output, output_size) == EnvelopeError::None;
+}
+
+static bool node_deliver(void *ctx, const char *)
+{
+    Node *node = static_cast<Node *>((Station *)ctx);
+    if (!node->provisioned)
+    {
+        node->provisioned = true;
+        node->provisioned_us = medium.now_us;
+    }
+    return true;
+}
+
+static void set_mac(uint8_t mac[FLEET_MAC_SIZE], uint8_t prefix, uint32_t n)
+{
+    const uint8_t m[FLEET_MAC_SIZE] = {0x02, prefix, 0, (uint8_t)(n >> 16), (uint8_t)(n >> 8), (uint8_t)n};
+    memcpy(mac, m, FLEET_MAC_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    size_t node_count = 200;
+    unsigned groups = 1;
+    double loss = 0.05;
+    unsigned retries = 10;
+    unsigned interval_ms = 50;
+    bool all = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--nodes") && i + 1 < argc)
+        {
+            node_count = (size_t)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--groups") && i + 1 < argc)
+        {
+            groups = (unsigned)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--loss") && i + 1 < argc)
+        {
+            loss = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--retries") && i + 1 < argc)
+        {
+            retries = (unsigned)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--interval") && i + 1 < argc)
+        {
+            interval_ms = (unsigned)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--all"))
+        {
+            all = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--nodes N] [--groups G] [--loss P] [--retries R] [--interval MS] [--all]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (groups == 0 || groups > 256 || retries > 255 || loss < 0 || loss >= 1)
+    {
+        fprintf(stderr, "groups must be 1..256, retries <= 255 and loss in [0, 1)\n");
+        return 2;
+    }
+
+    envelope_keyring_init(keyRing);
+    envelope_keyring_set(keyRing, 0, demoKey);
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, demoKey, 128);
+    const uint8_t iv[ENVELOPE_IV_SIZE] = {7, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    char envelope[128];
+    if (envelope_encrypt(enc, ENVELOPE_NO_KEY_ID, iv, "rack-net|correcthorse", envelope, sizeof(envelope)) !=
+        EnvelopeError::None)
+    {
+        fprintf(stderr, "could not build the test envelope\n");
+        return 1;
+    }
+    mbedtls_aes_free(&enc);
+
+    std::vector<Node> nodes(node_count);
+    size_t targeted = 0;
+    for (size_t i = 0; i < node_count; i++)
+    {
+        Node &node = nodes[i];
+        set_mac(node.mac, 0x00, (uint32_t)i);
+        node.group = (uint8_t)(i % groups);
+        FleetReceiverConfig config = {};
+        memcpy(config.mac, node.mac, FLEET_MAC_SIZE);
+        config.group = node.group;
+        config.send = medium_send;
+        config.decrypt = node_decrypt;
+        config.deliver = node_deliver;
+        config.ctx = static_cast<Station *>(&node);
+        node.receiver.begin(config);
+        targeted += all || node.group == 0 ? 1 : 0;
+    }
+
+    Station sender_station;
+    set_mac(sender_station.mac, 0xff, 1);
+    FleetSender sender;
+    sender.begin(medium_send, &sender_station);
+    FleetCampaign campaign = {};
+    campaign.target = all ? fleet_address_all() : fleet_address_group(0);
+    campaign.seq = 0x5eed;
+    campaign.expected = (uint16_t)(targeted < FLEET_MAX_PEERS ? targeted : FLEET_MAX_PEERS);
+    campaign.retries = (uint8_t)retries;
+    campaign.interval_ms = interval_ms;
+    sender.start(envelope, campaign, 0);
+
+    std::mt19937 rng(1);
+    std::bernoulli_distribution dropped(loss);
+    while (true)
+    {
+        uint32_t wait_ms = sender.poll((uint32_t)(medium.now_us / 1000));
+        if (medium.queue.empty())
+        {
+            if (!sender.active())
+            {
+                break;
+            }
+            // Idle channel: jump to the sender's next transmission
+            medium.now_us = (medium.now_us / 1000 + wait_ms) * 1000;
+            continue;
+        }
+        AirFrame frame = std::move(medium.queue.front());
+        medium.queue.pop_front();
+        medium.now_us += FRAME_OVERHEAD_US + (uint64_t)(frame.data.size() * 8 * 1e6 / RATE_BPS);
+        medium.frames++;
+        bool broadcast = memcmp(frame.dst, FLEET_BROADCAST_MAC, FLEET_MAC_SIZE) == 0;
+        if (memcmp(frame.dst, sender_station.mac, FLEET_MAC_SIZE) == 0)
+        {
+            medium.acks++;
+            if (dropped(rng))
+            {
+                medium.lost++;
+                continue;
+            }
+            sender.on_frame(frame.src, frame.data.data(), frame.data.size(), (uint32_t)(medium.now_us / 1000));
+            continue;
+        }
+        for (Node &node : nodes)
+        {
+            if (!broadcast && memcmp(frame.dst, node.mac, FLEET_MAC_SIZE) != 0)
+            {
+                continue;
+            }
+            if (dropped(rng))
+            {
+                medium.lost++;
+                continue;
+            }
+            node.receiver.on_frame(frame.src, frame.data.data(), frame.data.size());
+        }
+    }
+
+    size_t provisioned = 0;
+    uint64_t last_us = 0;
+    uint32_t duplicates = 0;
+    for (const Node &node : nodes)
+    {
+        duplicates += node.receiver.stats().duplicates;
+        if (node.provisioned)
+        {
+            provisioned++;
+            last_us = node.provisioned_us > last_us ? node.provisioned_us : last_us;
+        }
+    }
+    const FleetSenderStats &s = sender.stats();
+    printf("nodes %zu, targeted %zu, loss %.0f%%, retries %u every %u ms\n", node_count, targeted, loss * 100,
+           retries, interval_ms);
+    printf("provisioned %zu/%zu (sender saw %lu accepted, %lu failed, %lu untracked) in %.1f ms simulated\n",
+           provisioned, targeted, (unsigned long)s.accepted, (unsigned long)s.failed, (unsigned long)s.untracked,
+           last_us / 1000.0);
+    printf("%lu broadcast(s), %lu frame(s) on air, %lu ack(s), %lu duplicate(s) re-acked, %lu delivery(ies) lost\n",
+           (unsigned long)s.transmissions, (unsigned long)medium.frames, (unsigned long)medium.acks,
+           (unsigned long)duplicates, (unsigned long)medium.lost);
+    printf("%.0f devices provisioned per second\n", last_us ? provisioned * 1e6 / last_us : 0.0);
+    return provisioned == targeted ? 0 : 1;
+}
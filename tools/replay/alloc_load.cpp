@@ -0,0 +1,269 @@
+#include "alloc_load.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "block_pool.h"
+#include "request_pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+// The firmware's block size, with enough blocks for every thread's peak
+static const size_t HOST_POOL_BLOCKS = 1024;
+// Every step is sampled, so the fragmentation pass runs fewer rounds
+static const size_t FRAG_ROUNDS = 2000;
+
+struct Latency
+{
+    std::vector<uint32_t> ns;
+    size_t failed = 0;
+};
+
+// What one in-flight request holds under each strategy
+struct HeapRequest
+{
+    void *body = nullptr;
+    void *json = nullptr;
+};
+
+struct Outstanding
+{
+    void *credentials = nullptr; // Handed off; freed at the next release
+};
+
+static inline uint32_t elapsed_ns(Clock::time_point t0)
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+}
+
+static void *timed_malloc(size_t size, Latency *lat)
+{
+    if (!lat)
+    {
+        return malloc(size);
+    }
+    Clock::time_point t0 = Clock::now();
+    void *p = malloc(size);
+    lat->ns.push_back(elapsed_ns(t0));
+    return p;
+}
+
+template <typename Pool>
+static void run_pool(Pool &pool, const std::vector<AllocStep> &steps, size_t slots, size_t rounds, Latency &lat)
+{
+    std::vector<void *> held(slots, nullptr);
+    void *handed_off = nullptr;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (const AllocStep &s : steps)
+        {
+            if (s.acquire)
+            {
+                Clock::time_point t0 = Clock::now();
+                held[s.slot] = pool.acquire();
+                lat.ns.push_back(elapsed_ns(t0));
+                if (!held[s.slot])
+                {
+                    lat.failed++;
+                }
+                continue;
+            }
+            pool.release(handed_off);
+            handed_off = nullptr;
+            if (s.credentials_len)
+            {
+                Clock::time_point t0 = Clock::now();
+                handed_off = pool.acquire();
+                lat.ns.push_back(elapsed_ns(t0));
+                if (!handed_off)
+                {
+                    lat.failed++;
+                }
+            }
+            pool.release(held[s.slot]);
+            held[s.slot] = nullptr;
+        }
+    }
+    pool.release(handed_off);
+}
+
+// lat may be nullptr to skip timing; sample(live_bytes) runs after every step
+template <typename Sample>
+static void run_heap(const std::vector<AllocStep> &steps, size_t slots, size_t rounds, Latency *lat, Sample sample)
+{
+    std::vector<HeapRequest> held(slots);
+    std::vector<size_t> held_bytes(slots, 0);
+    Outstanding out;
+    size_t out_bytes = 0;
+    size_t live = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (const AllocStep &s : steps)
+        {
+            if (s.acquire)
+            {
+                held[s.slot].body = timed_malloc(s.body_len + 1, lat);
+                held[s.slot].json = timed_malloc(2 * s.body_len + 64, lat);
+                held_bytes[s.slot] = 3 * s.body_len + 65;
+                live += held_bytes[s.slot];
+            }
+            else
+            {
+                free(out.credentials);
+                live -= out_bytes;
+                out.credentials = nullptr;
+                out_bytes = 0;
+                if (s.credentials_len)
+                {
+                    out.credentials = timed_malloc(s.credentials_len + 1, lat);
+                    out_bytes = s.credentials_len + 1;
+                    live += out_bytes;
+                }
+                free(held[s.slot].body);
+                free(held[s.slot].json);
+                held[s.slot] = HeapRequest();
+                live -= held_bytes[s.slot];
+                held_bytes[s.slot] = 0;
+            }
+            sample(live);
+        }
+    }
+    free(out.credentials);
+}
+
+static void print_latency(const char *name, Latency &lat, double wall_s)
+{
+    if (lat.ns.empty())
+    {
+        printf("%-8s no allocations\n", name);
+        return;
+    }
+    std::sort(lat.ns.begin(), lat.ns.end());
+    double total = 0;
+    for (uint32_t v : lat.ns)
+    {
+        total += v;
+    }
+    size_t n = lat.ns.size();
+    printf("%-8s %10zu %8.1f %8u %8u %8u %10zu %12.0f\n", name, n, total / n, lat.ns[n / 2], lat.ns[n * 99 / 100],
+           lat.ns[n - 1], lat.failed, n / wall_s);
+}
+
+// Latency pass: every thread replays the pattern concurrently
+template <typename Fn>
+static double run_threads(unsigned threads, std::vector<Latency> &lat, Fn fn)
+{
+    lat.assign(threads, Latency());
+    std::vector<std::thread> workers;
+    Clock::time_point t0 = Clock::now();
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() { fn(lat[t]); });
+    }
+    for (std::thread &w : workers)
+    {
+        w.join();
+    }
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static Latency merge(std::vector<Latency> &parts)
+{
+    Latency all;
+    for (Latency &p : parts)
+    {
+        all.ns.insert(all.ns.end(), p.ns.begin(), p.ns.end());
+        all.failed += p.failed;
+    }
+    return all;
+}
+
+void alloc_load_run(const std::vector<AllocStep> &steps, size_t slots, size_t rounds, unsigned threads)
+{
+    if (steps.empty())
+    {
+        printf("\nAllocation load: capture has no request bodies\n");
+        return;
+    }
+    if (slots * threads + threads > HOST_POOL_BLOCKS)
+    {
+        threads = (unsigned)(HOST_POOL_BLOCKS / (slots + 1));
+    }
+    static uint8_t storage[HOST_POOL_BLOCKS * REQUEST_BLOCK_SIZE];
+    static BlockPool<HOST_POOL_BLOCKS> pool(storage, REQUEST_BLOCK_SIZE);
+
+    printf("\nAllocation load: %zu steps x %zu rounds on %u thread(s), %zu concurrent request(s) per thread\n",
+           steps.size(), rounds, threads, slots);
+    printf("%-8s %10s %8s %8s %8s %8s %10s %12s\n", "", "allocs", "avg ns", "p50 ns", "p99 ns", "max ns", "failed",
+           "allocs/s");
+    std::vector<Latency> parts;
+    double wall = run_threads(threads, parts, [&](Latency &lat) { run_pool(pool, steps, slots, rounds, lat); });
+    Latency pooled = merge(parts);
+    print_latency("pool", pooled, wall);
+    wall = run_threads(threads, parts, [&](Latency &lat) { run_heap(steps, slots, rounds, &lat, [](size_t) {}); });
+    Latency heap = merge(parts);
+    print_latency("malloc", heap, wall);
+    BlockPoolStats ps = pool.stats();
+    printf("pool: high water %lu of %zu blocks, %lu contended retries, %lu exhausted\n",
+           (unsigned long)ps.high_water, pool.capacity(), (unsigned long)ps.contended, (unsigned long)ps.exhausted);
+
+    // Fragmentation pass on this thread, whose heap is glibc's main arena.
+    // The pool never fragments: a block always fits any request, so its
+    // only cost is the unused tail of each block.
+    size_t used = 0;
+    size_t blocks = 0;
+    for (const AllocStep &s : steps)
+    {
+        if (s.acquire)
+        {
+            used += 3 * s.body_len + 65;
+            blocks++;
+        }
+    }
+    printf("pool:   %.1f%% of each borrowed block unused on average (%u-byte blocks), external fragmentation 0\n",
+           blocks ? 100.0 * (1.0 - (double)used / (blocks * REQUEST_BLOCK_SIZE)) : 0.0, (unsigned)REQUEST_BLOCK_SIZE);
+#ifdef __GLIBC__
+    malloc_trim(0);
+    struct mallinfo2 before = mallinfo2();
+    size_t base = before.uordblks + before.fordblks - before.keepcost;
+    double worst = 0;
+    double sum = 0;
+    size_t worst_live = 0;
+    size_t samples = 0;
+    run_heap(steps, slots, std::min(rounds, FRAG_ROUNDS), nullptr,
+             [&](size_t live)
+             {
+                 if (live == 0)
+                 {
+                     return;
+                 }
+                 // Everything the heap holds for this pass except the top
+                 // chunk, which it could hand back: live blocks, cached and
+                 // binned chunks, and holes between live blocks
+                 struct mallinfo2 mi = mallinfo2();
+                 size_t held = mi.uordblks + mi.fordblks - mi.keepcost;
+                 held = held > base ? held - base : 0;
+                 double frag = held > live ? 1.0 - (double)live / (double)held : 0.0;
+                 if (frag > worst)
+                 {
+                     worst = frag;
+                     worst_live = live;
+                 }
+                 sum += frag;
+                 samples++;
+             });
+    printf("malloc: %.1f%% of the bytes the heap holds are not live on average, worst %.1f%% (%zu bytes live); "
+           "%zu samples\n",
+           samples ? 100.0 * sum / samples : 0.0, 100.0 * worst, worst_live, samples);
+    printf("        glibc caches freed chunks per thread; on the device compare heap.largest_block with heap.free "
+           "in /diag\n");
+#else
+    printf("malloc: fragmentation needs glibc's mallinfo2; only latency was measured\n");
+#endif
+}
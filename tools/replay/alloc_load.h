@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ===========================================================
+// Allocation Load (request pool vs malloc)
+// ===========================================================
+// The replayer records when each captured request would borrow and
+// return a context, then replays that pattern many times over, once
+// through the firmware's BlockPool and once through malloc/free.
+//
+// The malloc side allocates what a request actually needs: the body
+// buffer, JSON working memory of about twice the body, and for /set_wifi
+// a strdup of the credentials that outlives the request until the next
+// release (the connect task frees it later on the device).
+
+struct AllocStep
+{
+    bool acquire;            // false: release
+    uint16_t slot;           // Concurrent-request slot, below the capture's peak
+    uint32_t body_len;
+    uint32_t credentials_len; // Release only; 0 when nothing is handed off
+};
+
+// Runs the latency pass on threads threads and the fragmentation pass
+// on the calling thread, printing both
+void alloc_load_run(const std::vector<AllocStep> &steps, size_t slots, size_t rounds, unsigned threads);
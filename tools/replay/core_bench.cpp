@@ -0,0 +1,146 @@
+#include "core_bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "credentials.h"
+#include "envelope.h"
+#include "session.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t BATCH = 64;
+
+// Keeps results observable so the calls are not optimized away
+static volatile uint32_t sink;
+
+template <typename Fn>
+static void bench(const char *name, size_t rounds, Fn fn, size_t batch = BATCH)
+{
+    std::vector<double> per_call(rounds);
+    for (size_t r = 0; r < rounds; r++)
+    {
+        Clock::time_point t0 = Clock::now();
+        for (size_t i = 0; i < batch; i++)
+        {
+            sink = sink + fn();
+        }
+        per_call[r] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / batch;
+    }
+    std::sort(per_call.begin(), per_call.end());
+    printf("%-28s %10.0f %10.0f\n", name, per_call[rounds / 2], per_call[rounds - 1]);
+}
+
+// Any key will do; the bench only needs encrypt and decrypt to agree
+static const uint8_t benchKey[ENVELOPE_KEY_SIZE] = {0x42, 0x65, 0x6e, 0x63, 0x68, 0x4b, 0x65, 0x79,
+                                                    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+
+// Deterministic stand-in for the hardware RNG (xorshift32)
+static int bench_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    uint32_t &state = *(uint32_t *)ctx;
+    for (size_t i = 0; i < len; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        buf[i] = (unsigned char)state;
+    }
+    return 0;
+}
+
+// A scalar multiplication costs tens of microseconds or more, so the
+// handshake is timed one call per batch
+static void bench_session(size_t rounds)
+{
+    uint32_t rng_state = 0x2545F491;
+    session_configure(bench_rng, &rng_state);
+    // The Curve25519 base point (u = 9) is a valid client public key
+    uint8_t client_pub[SESSION_PUB_SIZE] = {9};
+    const uint32_t peer = 0x0A00002A;
+    bench("session_handshake (X25519)", rounds, [&]()
+          {
+              session_clear();
+              SessionResult result;
+              return (uint32_t)session_handshake(client_pub, peer, 0, result) + result.server_pub[0];
+          },
+          1);
+    bench("  cached", rounds, [&]()
+          {
+              SessionResult result;
+              return (uint32_t)session_handshake(client_pub, peer, 0, result) + result.cached;
+          });
+    uint8_t salt[2 * SESSION_PUB_SIZE] = {};
+    uint8_t shared[32] = {1};
+    bench("session_hkdf", rounds, [&]()
+          {
+              uint8_t key[SESSION_KEY_SIZE];
+              return (uint32_t)session_hkdf(salt, sizeof(salt), shared, sizeof(shared), key, sizeof(key)) + key[0];
+          });
+    SessionResult result;
+    session_handshake(client_pub, peer, 0, result);
+    bench("session_lookup_key", rounds, [&]()
+          {
+              uint8_t key[SESSION_KEY_SIZE];
+              return (uint32_t)session_lookup_key(result.id, 0, key) + key[0];
+          });
+    session_clear();
+}
+
+void core_bench_run(size_t rounds)
+{
+    if (rounds == 0)
+    {
+        return;
+    }
+    EnvelopeKeyRing ring;
+    envelope_keyring_init(ring);
+    envelope_keyring_set(ring, 0, benchKey);
+    // Longest accepted plaintext, so every call decrypts three blocks
+    char plaintext[ENVELOPE_MAX_PLAINTEXT + 1];
+    memset(plaintext, 'p', ENVELOPE_MAX_PLAINTEXT);
+    memcpy(plaintext, "BenchNet|", 9);
+    plaintext[ENVELOPE_MAX_PLAINTEXT] = '\0';
+    uint8_t iv[ENVELOPE_IV_SIZE] = {};
+    char legacy[128];
+    char keyed[128];
+    mbedtls_aes_context enc;
+    mbedtls_aes_init(&enc);
+    mbedtls_aes_setkey_enc(&enc, benchKey, 128);
+    envelope_encrypt(enc, ENVELOPE_NO_KEY_ID, iv, plaintext, legacy, sizeof(legacy));
+    envelope_encrypt(enc, 0, iv, plaintext, keyed, sizeof(keyed));
+    mbedtls_aes_free(&enc);
+
+    printf("\nCore benchmark, %zu batches of %zu calls\n", rounds, BATCH);
+    printf("%-28s %10s %10s\n", "call", "median ns", "max ns");
+    bench("envelope_nonce", rounds, [&]()
+          {
+              uint8_t nonce[ENVELOPE_IV_SIZE];
+              envelope_nonce(keyed, nonce);
+              return (uint32_t)nonce[0];
+          });
+    bench("envelope_decrypt_keyring", rounds, [&]()
+          {
+              char out[ENVELOPE_MAX_PLAINTEXT + 1];
+              return (uint32_t)envelope_decrypt_keyring(ring, legacy, out, sizeof(out)) + (uint8_t)out[0];
+          });
+    bench("  with key id", rounds, [&]()
+          {
+              char out[ENVELOPE_MAX_PLAINTEXT + 1];
+              return (uint32_t)envelope_decrypt_keyring(ring, keyed, out, sizeof(out)) + (uint8_t)out[0];
+          });
+    bench("envelope_decrypt (key setup)", rounds, [&]()
+          {
+              char out[ENVELOPE_MAX_PLAINTEXT + 1];
+              return (uint32_t)envelope_decrypt(benchKey, legacy, out, sizeof(out)) + (uint8_t)out[0];
+          });
+    bench("parse_credentials", rounds, [&]()
+          {
+              WifiCredentials creds;
+              bool ok = parse_credentials(plaintext, creds);
+              return (uint32_t)ok + (uint8_t)creds.password[0];
+          });
+    envelope_keyring_free(ring);
+    bench_session(rounds);
+}
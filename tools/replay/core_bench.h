@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+// ===========================================================
+// Core Benchmark (per-call cost of the /set_wifi and /session cores)
+// ===========================================================
+// Times the pure cores every /set_wifi request runs through, on the
+// host: base64 decode and nonce extraction, key-ring decryption of a
+// maximum-length envelope in both layouts, and credential parsing. Then
+// the /session handshake: a fresh X25519 exchange with key derivation,
+// a cached handshake, HKDF alone and the session key lookup.
+// Calls are timed in batches, so clock overhead stays out of the
+// per-call figures; the median and slowest batch are printed.
+
+// rounds is the number of batches timed per call
+void core_bench_run(size_t rounds);
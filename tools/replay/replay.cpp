@@ -0,0 +1,301 @@
+// Host replayer for request logs captured with GET /capture.
+//
+//   replay <capture.bin> [--speed N | --fast] [--key [ID:]<32 hex chars>]...
+//          [--alloc-load ROUNDS [--threads N]]
+//   replay --bench ROUNDS
+//
+// Body chunks are fed to the same /set_wifi core the firmware runs
+// (lib/WifiSetup), with the original index/total splits and, unless
+// --fast is given, the original inter-chunk timing divided by --speed.
+// Other endpoints drive hardware and are only listed. --key may be given
+// once per key slot; without an ID it replaces slot 0.
+//
+// --alloc-load repeats the capture's request-context lifetimes ROUNDS
+// times through the firmware's request pool and through malloc, and
+// compares allocation latency and heap fragmentation (alloc_load.h).
+//
+// --bench times the envelope, credential and session cores per call and
+// needs no capture (core_bench.h).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alloc_load.h"
+#include "core_bench.h"
+#include "envelope.h"
+#include "request_log.h"
+#include "wifi_setup.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Same demo key the firmware ships with in slot 0; override with --key
+static const uint8_t demoKey[ENVELOPE_KEY_SIZE] = {'t', 'h', 'i', 's', 'i', 's', 'm', 'y',
+                                                   'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+static EnvelopeKeyRing keyRing;
+
+static bool host_decrypt(const char *encrypted_b64, const char *session_id, char *output, size_t output_size)
+{
+    if (session_id)
+    {
+        return false; // Session keys are ephemeral and never leave the device
+    }
+    return envelope_decrypt_keyring(keyRing, encrypted_b64, output, output_size) == EnvelopeError::None;
+}
+
+struct ReplayRequest
+{
+    std::string url;
+    uint8_t method = 0;
+    size_t chunks = 0;
+    double handler_us = 0;
+    bool done = false;
+    int slot = -1; // Concurrent-request slot while its context is borrowed
+    uint32_t credentials_len = 0;
+    WifiSetupRequest setup;
+};
+
+struct UrlStats
+{
+    size_t requests = 0;
+    size_t chunks = 0;
+    double total_us = 0;
+    double max_us = 0;
+};
+
+static bool parse_key(const char *arg)
+{
+    unsigned id = 0;
+    const char *hex = arg;
+    const char *colon = strchr(arg, ':');
+    if (colon)
+    {
+        if (sscanf(arg, "%u:", &id) != 1 || id >= ENVELOPE_KEY_SLOTS)
+        {
+            return false;
+        }
+        hex = colon + 1;
+    }
+    uint8_t key[ENVELOPE_KEY_SIZE];
+    if (strlen(hex) != 2 * ENVELOPE_KEY_SIZE)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ENVELOPE_KEY_SIZE; i++)
+    {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1)
+        {
+            return false;
+        }
+        key[i] = (uint8_t)v;
+    }
+    return envelope_keyring_set(keyRing, (uint8_t)id, key);
+}
+
+static bool read_file(const char *path, std::vector<uint8_t> &out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return false;
+    }
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    double speed = 1.0;
+    bool fast = false;
+    size_t alloc_rounds = 0;
+    size_t bench_rounds = 0;
+    unsigned threads = 2;
+    envelope_keyring_init(keyRing);
+    envelope_keyring_set(keyRing, 0, demoKey);
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--fast"))
+        {
+            fast = true;
+        }
+        else if (!strcmp(argv[i], "--speed") && i + 1 < argc)
+        {
+            speed = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--alloc-load") && i + 1 < argc)
+        {
+            alloc_rounds = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--bench") && i + 1 < argc)
+        {
+            bench_rounds = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            threads = (unsigned)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(argv[i], "--key") && i + 1 < argc)
+        {
+            if (!parse_key(argv[++i]))
+            {
+                fprintf(stderr, "--key expects [ID:] and %u hex bytes, ID below %u\n", (unsigned)ENVELOPE_KEY_SIZE,
+                        (unsigned)ENVELOPE_KEY_SLOTS);
+                return 2;
+            }
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (!path && bench_rounds)
+    {
+        core_bench_run(bench_rounds);
+        return 0;
+    }
+    if (!path || speed <= 0 || threads == 0)
+    {
+        fprintf(stderr, "usage: %s <capture.bin> [--speed N | --fast] [--key [ID:]HEX]... [--alloc-load ROUNDS "
+                        "[--threads N]] [--bench ROUNDS]\n"
+                        "       %s --bench ROUNDS\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+    std::vector<uint8_t> log;
+    if (!read_file(path, log))
+    {
+        perror(path);
+        return 1;
+    }
+    RequestLogReader reader(log.data(), log.size());
+    if (!reader.valid())
+    {
+        fprintf(stderr, "%s: not a request log\n", path);
+        return 1;
+    }
+
+    wifi_setup_configure(host_decrypt);
+    std::map<uint16_t, ReplayRequest> live;
+    std::map<std::string, UrlStats> stats;
+    std::vector<AllocStep> steps;
+    std::vector<bool> slotUsed;
+    Clock::time_point start = Clock::now();
+    RequestEvent ev;
+    while (reader.next(ev))
+    {
+        if (!fast)
+        {
+            auto due = start + std::chrono::microseconds((int64_t)(ev.t_us / speed));
+            std::this_thread::sleep_until(due);
+        }
+        ReplayRequest &req = live[ev.id];
+        switch (ev.type)
+        {
+        case RequestRecord::Begin:
+            req = ReplayRequest();
+            req.url.assign(ev.url, ev.url_len);
+            req.method = ev.method;
+            wifi_setup_reset(req.setup, &req);
+            break;
+        case RequestRecord::Body:
+        {
+            req.chunks++;
+            if (req.slot < 0)
+            {
+                // The firmware borrows a context on the first body chunk
+                size_t slot = 0;
+                while (slot < slotUsed.size() && slotUsed[slot])
+                {
+                    slot++;
+                }
+                if (slot == slotUsed.size())
+                {
+                    slotUsed.push_back(false);
+                }
+                slotUsed[slot] = true;
+                req.slot = (int)slot;
+                steps.push_back({true, (uint16_t)slot, ev.total, 0});
+            }
+            if (req.url != "/set_wifi" || req.done)
+            {
+                break;
+            }
+            WifiSetupReply reply;
+            Clock::time_point t0 = Clock::now();
+            bool complete = wifi_setup_feed(req.setup, ev.data, ev.len, ev.index, ev.total, reply);
+            req.handler_us += std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+            if (complete)
+            {
+                req.done = true;
+                if (req.setup.has_credentials)
+                {
+                    req.credentials_len = (uint32_t)strlen(req.setup.credentials);
+                }
+                printf("%10.3f ms  #%04x POST %s  %zu chunk(s)  -> %d %s  (%.1f us)\n", ev.t_us / 1000.0, ev.id,
+                       req.url.c_str(), req.chunks, reply.status, reply.message, req.handler_us);
+                wifi_setup_wipe(req.setup);
+            }
+            break;
+        }
+        case RequestRecord::End:
+        {
+            if (req.slot >= 0)
+            {
+                steps.push_back({false, (uint16_t)req.slot, 0, req.credentials_len});
+                slotUsed[req.slot] = false;
+            }
+            UrlStats &s = stats[req.url];
+            s.requests++;
+            s.chunks += req.chunks;
+            s.total_us += req.handler_us;
+            if (req.handler_us > s.max_us)
+            {
+                s.max_us = req.handler_us;
+            }
+            if (req.url != "/set_wifi")
+            {
+                printf("%10.3f ms  #%04x %s (not replayable on host)\n", ev.t_us / 1000.0, ev.id, req.url.c_str());
+            }
+            live.erase(ev.id);
+            break;
+        }
+        }
+    }
+
+    printf("\n%-16s %8s %8s %12s %12s\n", "url", "requests", "chunks", "avg us", "max us");
+    for (const auto &entry : stats)
+    {
+        const UrlStats &s = entry.second;
+        printf("%-16s %8zu %8zu %12.1f %12.1f\n", entry.first.c_str(), s.requests, s.chunks,
+               s.requests ? s.total_us / s.requests : 0.0, s.max_us);
+    }
+    if (!live.empty())
+    {
+        printf("%zu request(s) without an end record (capture stopped mid-request)\n", live.size());
+        for (const auto &entry : live)
+        {
+            if (entry.second.slot >= 0)
+            {
+                steps.push_back({false, (uint16_t)entry.second.slot, 0, entry.second.credentials_len});
+            }
+        }
+    }
+    if (alloc_rounds)
+    {
+        alloc_load_run(steps, slotUsed.size(), alloc_rounds, threads);
+    }
+    core_bench_run(bench_rounds);
+    return 0;
+}